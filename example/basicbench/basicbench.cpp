@@ -0,0 +1,126 @@
+//
+// Created by agent on 26-10-19.
+//
+
+#include "net4cxx/net4cxx.h"
+
+
+using namespace net4cxx;
+
+const size_t STREAM_SIZE = 64 * 1024 * 1024;
+const size_t READ_SIZE = 4096;
+
+
+class CountingLineReceiver: public LineReceiver {
+public:
+    void lineReceived(boost::string_ref line) override {
+        ++_count;
+    }
+
+    size_t _count{0};
+};
+
+
+class CountingInt32StringReceiver: public Int32StringReceiver {
+public:
+    void stringReceived(boost::string_ref data) override {
+        ++_count;
+    }
+
+    size_t _count{0};
+};
+
+
+class CountingNetstringReceiver: public NetstringReceiver {
+public:
+    void stringReceived(boost::string_ref data) override {
+        ++_count;
+    }
+
+    size_t _count{0};
+};
+
+
+/// The accumulate-and-erase buffering protocols used to hand roll, for comparison
+class AccumulatingLineReceiver: public Protocol {
+public:
+    void dataReceived(Byte *data, size_t length) override {
+        _buffer.insert(_buffer.end(), data, data + length);
+        const Byte delimiter[] = {'\r', '\n'};
+        auto begin = _buffer.begin();
+        auto found = std::search(begin, _buffer.end(), delimiter, delimiter + 2);
+        while (found != _buffer.end()) {
+            std::string line(begin, found);
+            ++_count;
+            begin = found + 2;
+            found = std::search(begin, _buffer.end(), delimiter, delimiter + 2);
+        }
+        _buffer.erase(_buffer.begin(), begin);
+    }
+
+    size_t _count{0};
+protected:
+    ByteArray _buffer;
+};
+
+
+template <typename ReceiverT>
+void runBench(const char *name, ByteArray &stream, size_t frameSize) {
+    ReceiverT receiver;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t offset = 0; offset < stream.size(); offset += READ_SIZE) {
+        receiver.dataReceived(stream.data() + offset, std::min(READ_SIZE, stream.size() - offset));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    NET4CXX_LOG_INFO(gAppLog, "%-26s %5d byte frames: %8.1f MB/s, %6.2f M frames/s", name, (int)frameSize,
+                     stream.size() / seconds / 1e6, receiver._count / seconds / 1e6);
+}
+
+
+ByteArray makeLines(size_t frameSize) {
+    ByteArray stream;
+    while (stream.size() < STREAM_SIZE) {
+        stream.insert(stream.end(), frameSize - 2, 'x');
+        stream.push_back('\r');
+        stream.push_back('\n');
+    }
+    return stream;
+}
+
+
+ByteArray makeInt32Strings(size_t frameSize) {
+    ByteArray stream;
+    size_t length = frameSize - 4;
+    while (stream.size() < STREAM_SIZE) {
+        stream.insert(stream.end(), {(Byte)(length >> 24), (Byte)(length >> 16), (Byte)(length >> 8), (Byte)length});
+        stream.insert(stream.end(), length, 'x');
+    }
+    return stream;
+}
+
+
+ByteArray makeNetstrings(size_t frameSize) {
+    ByteArray stream;
+    std::string prefix = std::to_string(frameSize) + ":";
+    while (stream.size() < STREAM_SIZE) {
+        stream.insert(stream.end(), prefix.begin(), prefix.end());
+        stream.insert(stream.end(), frameSize, 'x');
+        stream.push_back(',');
+    }
+    return stream;
+}
+
+
+int main(int argc, char **argv) {
+    NET4CXX_PARSE_COMMAND_LINE(argc, argv);
+    for (size_t frameSize: {16, 64, 1024, 16384}) {
+        auto lines = makeLines(frameSize);
+        runBench<CountingLineReceiver>("LineReceiver", lines, frameSize);
+        runBench<AccumulatingLineReceiver>("accumulating line splitter", lines, frameSize);
+        auto strings = makeInt32Strings(frameSize);
+        runBench<CountingInt32StringReceiver>("Int32StringReceiver", strings, frameSize);
+        auto netstrings = makeNetstrings(frameSize);
+        runBench<CountingNetstringReceiver>("NetstringReceiver", netstrings, frameSize);
+    }
+    return 0;
+}
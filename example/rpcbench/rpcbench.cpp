@@ -0,0 +1,88 @@
+//
+// Created by agent on 26-10-19.
+//
+
+#include "net4cxx/net4cxx.h"
+
+
+using namespace net4cxx;
+
+const size_t TOTAL_CALLS = 200000;
+const size_t IN_FLIGHT = 64;
+
+
+class BenchClientProtocol: public RPCProtocol {
+public:
+    using RPCProtocol::RPCProtocol;
+
+    void connectionMade() override {
+        _start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i != IN_FLIGHT; ++i) {
+            sendNext();
+        }
+    }
+
+    void sendNext() {
+        if (_sent == TOTAL_CALLS) {
+            return;
+        }
+        ++_sent;
+        auto begin = std::chrono::steady_clock::now();
+        std::string payload(32, 'x');
+        call("echo", payload, [this, begin](IArchive *response, std::exception_ptr error) {
+            if (error) {
+                NET4CXX_LOG_ERROR(gAppLog, "Call failed");
+                reactor()->stop();
+                return;
+            }
+            std::string payload;
+            *response >> payload;
+            _latencies.push_back(std::chrono::steady_clock::now() - begin);
+            if (_latencies.size() == TOTAL_CALLS) {
+                report();
+            } else {
+                sendNext();
+            }
+        }, 5.0);
+    }
+
+    void report() {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+        std::sort(_latencies.begin(), _latencies.end());
+        auto percentile = [this](double p) {
+            auto index = std::min((size_t)(p * _latencies.size()), _latencies.size() - 1);
+            return std::chrono::duration<double, std::micro>(_latencies[index]).count();
+        };
+        NET4CXX_LOG_INFO(gAppLog, "%d calls, %d in flight: %.0f calls/sec, p50 %.1fus, p99 %.1fus",
+                         (int)TOTAL_CALLS, (int)IN_FLIGHT, TOTAL_CALLS / seconds, percentile(0.5), percentile(0.99));
+        reactor()->stop();
+    }
+protected:
+    size_t _sent{0};
+    std::chrono::steady_clock::time_point _start;
+    std::vector<std::chrono::steady_clock::duration> _latencies;
+};
+
+
+class BenchClientFactory: public RPCClientFactory {
+public:
+    ProtocolPtr buildProtocol(const Address &address) override {
+        return std::make_shared<BenchClientProtocol>();
+    }
+};
+
+
+int main(int argc, char **argv) {
+    NET4CXX_PARSE_COMMAND_LINE(argc, argv);
+    Reactor reactor;
+    auto methods = std::make_shared<RPCMethods>();
+    methods->add("echo", [](IArchive &request, OArchive &response) {
+        std::string payload;
+        request >> payload;
+        response << payload;
+    });
+    serverFromString(&reactor, "tcp:28002:interface=127.0.0.1")->listen(std::make_shared<RPCFactory>(methods));
+    clientFromString(&reactor, "tcp:127.0.0.1:28002")->connect(std::make_shared<BenchClientFactory>());
+    reactor.run();
+    return 0;
+}
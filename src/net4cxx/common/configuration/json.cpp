@@ -4,6 +4,7 @@
 
 #include "net4cxx/common/configuration/json.h"
 #include "net4cxx/common/utilities/errors.h"
+#include "net4cxx/common/utilities/messagebuffer.h"
 
 
 NS_BEGIN
@@ -35,6 +36,36 @@ static void fixNumericLocaleInput(char* begin, char* end) {
     }
 }
 
+static void getLineAndColumn(const char *begin, const char *end, const char *location, int &line, int &column) {
+    const char *current = begin;
+    const char *lastLineStart = current;
+    line = 0;
+    while (current < location && current != end) {
+        char c = *current++;
+        if (c == '\r') {
+            if (current != end && *current == '\n') {
+                ++current;
+            }
+            lastLineStart = current;
+            ++line;
+        } else if (c == '\n') {
+            lastLineStart = current;
+            ++line;
+        }
+    }
+    // column & line start at 1
+    column = int(location - lastLineStart) + 1;
+    ++line;
+}
+
+static std::string formatLineAndColumn(const char *begin, const char *end, const char *location) {
+    int line, column;
+    getLineAndColumn(begin, end, location, line, column);
+    char buffer[18 + 16 + 16 + 1];
+    snprintf(buffer, sizeof(buffer), "Line %d, Column %d", line, column);
+    return std::string(buffer);
+}
+
 static const double maxUInt64AsDouble = 18446744073709551615.0;
 
 
@@ -234,6 +265,186 @@ static std::string valueToQuotedString(const std::string &value) {
 }
 
 
+const size_t JSONObject::indexThreshold;
+
+JSONObject::JSONObject(const JSONObject &other)
+        : _members(other._members)
+        , _index(other._index ? std::make_unique<Index>(*other._index) : nullptr) {
+
+}
+
+JSONObject& JSONObject::operator=(const JSONObject &other) {
+    if (this != &other) {
+        _members = other._members;
+        _index = other._index ? std::make_unique<Index>(*other._index) : nullptr;
+    }
+    return *this;
+}
+
+void JSONObject::clear() {
+    _members.clear();
+    _index.reset();
+}
+
+void JSONObject::reserve(size_t capacity) {
+    _members.reserve(capacity);
+}
+
+std::pair<JSONObject::iterator, bool> JSONObject::emplace(std::string key, JSONValue value) {
+    size_t position = lookup(key.data(), key.size());
+    if (position != _members.size()) {
+        return std::make_pair(std::next(_members.begin(), position), false);
+    }
+    _members.emplace_back(std::move(key), std::move(value));
+    if (_index || _members.size() > indexThreshold) {
+        insertIndex(position);
+    }
+    return std::make_pair(std::prev(_members.end()), true);
+}
+
+JSONObject::iterator JSONObject::erase(iterator pos) {
+    auto position = std::distance(_members.begin(), pos);
+    if (_index) {
+        eraseIndex((size_t)position);
+    }
+    _members.erase(pos);
+    return std::next(_members.begin(), position);
+}
+
+size_t JSONObject::hashKey(const char *key, size_t length) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i != length; ++i) {
+        hash ^= (uint8_t)key[i];
+        hash *= 1099511628211ULL;
+    }
+    return (size_t)hash;
+}
+
+size_t JSONObject::lookup(const char *key, size_t length) const {
+    if (!_index) {
+        for (size_t position = 0; position != _members.size(); ++position) {
+            auto &name = _members[position].first;
+            if (name.size() == length && memcmp(name.data(), key, length) == 0) {
+                return position;
+            }
+        }
+        return _members.size();
+    }
+    auto &index = *_index;
+    size_t mask = index.size() - 1;
+    for (size_t slot = hashKey(key, length) & mask; index[slot] != 0; slot = (slot + 1) & mask) {
+        size_t position = index[slot] - 1;
+        auto &name = _members[position].first;
+        if (name.size() == length && memcmp(name.data(), key, length) == 0) {
+            return position;
+        }
+    }
+    return _members.size();
+}
+
+void JSONObject::insertIndex(size_t position) {
+    if (!_index || _members.size() * 2 > _index->size()) {
+        rebuildIndex();
+        return;
+    }
+    auto &index = *_index;
+    auto &name = _members[position].first;
+    size_t mask = index.size() - 1;
+    size_t slot = hashKey(name.data(), name.size()) & mask;
+    while (index[slot] != 0) {
+        slot = (slot + 1) & mask;
+    }
+    index[slot] = (uint32_t)(position + 1);
+}
+
+void JSONObject::eraseIndex(size_t position) {
+    auto &index = *_index;
+    size_t mask = index.size() - 1;
+    auto &name = _members[position].first;
+    size_t slot = hashKey(name.data(), name.size()) & mask;
+    while (index[slot] != position + 1) {
+        slot = (slot + 1) & mask;
+    }
+    // Backward shift deletion: pull later entries of the probe run into the hole unless that would move them
+    // in front of their home slot
+    for (size_t next = (slot + 1) & mask; index[next] != 0; next = (next + 1) & mask) {
+        auto &nextName = _members[index[next] - 1].first;
+        size_t home = hashKey(nextName.data(), nextName.size()) & mask;
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            index[slot] = index[next];
+            slot = next;
+        }
+    }
+    index[slot] = 0;
+    for (auto &entry: index) {
+        if (entry > position + 1) {
+            --entry;
+        }
+    }
+}
+
+void JSONObject::rebuildIndex() {
+    if (_members.size() <= indexThreshold) {
+        _index.reset();
+        return;
+    }
+    size_t capacity = 16;
+    while (capacity < _members.size() * 2) {
+        capacity <<= 1;
+    }
+    if (!_index) {
+        _index = std::make_unique<Index>();
+    }
+    auto &index = *_index;
+    index.assign(capacity, 0);
+    size_t mask = capacity - 1;
+    for (size_t position = 0; position != _members.size(); ++position) {
+        auto &name = _members[position].first;
+        size_t slot = hashKey(name.data(), name.size()) & mask;
+        while (index[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        index[slot] = (uint32_t)(position + 1);
+    }
+}
+
+bool operator<(const JSONObject &lhs, const JSONObject &rhs) {
+    // Ordered like the sorted maps objects used to be stored in
+    auto sorted = [](const JSONObject &object) {
+        std::vector<const JSONObject::value_type *> members;
+        members.reserve(object.size());
+        for (auto &member: object) {
+            members.push_back(&member);
+        }
+        std::sort(members.begin(), members.end(), [](const JSONObject::value_type *x,
+                                                     const JSONObject::value_type *y) {
+            return x->first < y->first;
+        });
+        return members;
+    };
+    auto lhsMembers = sorted(lhs), rhsMembers = sorted(rhs);
+    return std::lexicographical_compare(lhsMembers.begin(), lhsMembers.end(), rhsMembers.begin(), rhsMembers.end(),
+                                        [](const JSONObject::value_type *x, const JSONObject::value_type *y) {
+                                            return *x < *y;
+                                        });
+}
+
+bool operator==(const JSONObject &lhs, const JSONObject &rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (auto &member: lhs) {
+        auto iter = rhs.find(member.first);
+        if (iter == rhs.end() || iter->second != member.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
 JSONValue::JSONValue(JSONType type) {
     switch (type) {
         case JSONType::nullValue: {
@@ -976,16 +1187,32 @@ const JSONValue& JSONValue::operator[](int index) const {
     return (*this)[static_cast<size_t>(index)];
 }
 
-JSONValue& JSONValue::operator[](const char *key) {
+#ifdef NET4CXX_JSON_FLAT_OBJECTS
+static JSONObject::iterator findMember(JSONObject &object, const char *key, size_t length) {
+    return object.find(key, length);
+}
+
+static JSONObject::const_iterator findMember(const JSONObject &object, const char *key, size_t length) {
+    return object.find(key, length);
+}
+#endif
+
+template <typename ObjectT>
+static auto findMember(ObjectT &object, const char *key, size_t length) -> decltype(object.find(std::string())) {
+    return object.find(std::string(key, length));
+}
+
+JSONValue& JSONValue::resolveReference(const char *key, size_t length) {
     if (_value.type() == typeid(NullValue)) {
         *this = JSONValue(JSONType::objectValue);
-    } else if (_value.type() != typeid(ObjectType)) {
+    }
+    auto object = boost::get<ObjectType>(&_value);
+    if (!object) {
         NET4CXX_THROW_EXCEPTION(ValueError, "operator[](key) requires object value");
     }
-    auto &object = boost::get<ObjectType>(_value);
-    auto it = object.find(key);
-    if (it == object.end()) {
-        it = object.insert(it, std::make_pair(key, nullSingleton()));
+    auto it = findMember(*object, key, length);
+    if (it == object->end()) {
+        it = object->emplace(std::string(key, length), JSONValue()).first;
     }
     return it->second;
 }
@@ -1000,13 +1227,12 @@ JSONValue JSONValue::get(const char *key, const JSONValue &defaultValue) const {
     return found ? *found : defaultValue;
 }
 
-const JSONValue* JSONValue::find(const char *key) const {
-    if (_value.type() == typeid(NullValue)) {
+const JSONValue* JSONValue::find(const char *key, size_t length) const {
+    if (auto object = boost::get<ObjectType>(&_value)) {
+        auto it = findMember(*object, key, length);
+        return it != object->end() ? &(it->second) : nullptr;
+    } else if (_value.type() == typeid(NullValue)) {
         return nullptr;
-    } else if (_value.type() == typeid(ObjectType)) {
-        auto &object = boost::get<ObjectType>(_value);
-        auto it = object.find(key);
-        return it != object.end() ? &(it->second) : nullptr;
     } else {
         NET4CXX_THROW_EXCEPTION(ValueError, "find requires object value or null value");
     }
@@ -1059,6 +1285,11 @@ StringVector JSONValue::getMemberNames() const {
     return members;
 }
 
+const std::string& JSONValue::getComment(CommentPlacement placement) const {
+    static const std::string noComment;
+    return _comments ? (*_comments)[placement] : noComment;
+}
+
 std::string JSONValue::toStyledString() const {
     StreamWriterBuilder builder;
     std::string out = hasComment(COMMENT_BEFORE) ? "\n" : "";
@@ -1370,6 +1601,523 @@ std::ostream& operator<<(std::ostream &sout, const JSONValue &root) {
 }
 
 
+// Grisu2 as described in "Printing Floating-Point Numbers Quickly and Accurately with Integers" (Loitsch 2010),
+// the output always reads back to the same double and is the shortest one in all but rare cases.
+struct DiyFp {
+    DiyFp(uint64_t f, int e)
+            : f(f)
+            , e(e) {
+
+    }
+
+    static DiyFp sub(const DiyFp &x, const DiyFp &y) {
+        return DiyFp(x.f - y.f, x.e);
+    }
+
+    static DiyFp mul(const DiyFp &x, const DiyFp &y) {
+        const uint64_t uLo = x.f & 0xFFFFFFFFu;
+        const uint64_t uHi = x.f >> 32u;
+        const uint64_t vLo = y.f & 0xFFFFFFFFu;
+        const uint64_t vHi = y.f >> 32u;
+        const uint64_t p0 = uLo * vLo;
+        const uint64_t p1 = uLo * vHi;
+        const uint64_t p2 = uHi * vLo;
+        const uint64_t p3 = uHi * vHi;
+        uint64_t q = (p0 >> 32u) + (p1 & 0xFFFFFFFFu) + (p2 & 0xFFFFFFFFu);
+        // round, ties up
+        q += uint64_t{1} << 31u;
+        return DiyFp(p3 + (p2 >> 32u) + (p1 >> 32u) + (q >> 32u), x.e + y.e + 64);
+    }
+
+    static DiyFp normalize(DiyFp x) {
+        while ((x.f >> 63u) == 0) {
+            x.f <<= 1u;
+            x.e--;
+        }
+        return x;
+    }
+
+    static DiyFp normalizeTo(const DiyFp &x, int targetExponent) {
+        return DiyFp(x.f << (x.e - targetExponent), targetExponent);
+    }
+
+    uint64_t f;
+    int e;
+};
+
+struct CachedPower {
+    uint64_t f;
+    int e;
+    int k;
+};
+
+static const int grisuAlpha = -60;
+static const int grisuGamma = -32;
+
+static CachedPower getCachedPowerForBinaryExponent(int e) {
+    // Normalized 10^k for k = -300, -292, ..., 324
+    static const CachedPower cachedPowers[] = {
+        {0xAB70FE17C79AC6CAULL, -1060, -300},
+        {0xFF77B1FCBEBCDC4FULL, -1034, -292},
+        {0xBE5691EF416BD60CULL, -1007, -284},
+        {0x8DD01FAD907FFC3CULL, -980, -276},
+        {0xD3515C2831559A83ULL, -954, -268},
+        {0x9D71AC8FADA6C9B5ULL, -927, -260},
+        {0xEA9C227723EE8BCBULL, -901, -252},
+        {0xAECC49914078536DULL, -874, -244},
+        {0x823C12795DB6CE57ULL, -847, -236},
+        {0xC21094364DFB5637ULL, -821, -228},
+        {0x9096EA6F3848984FULL, -794, -220},
+        {0xD77485CB25823AC7ULL, -768, -212},
+        {0xA086CFCD97BF97F4ULL, -741, -204},
+        {0xEF340A98172AACE5ULL, -715, -196},
+        {0xB23867FB2A35B28EULL, -688, -188},
+        {0x84C8D4DFD2C63F3BULL, -661, -180},
+        {0xC5DD44271AD3CDBAULL, -635, -172},
+        {0x936B9FCEBB25C996ULL, -608, -164},
+        {0xDBAC6C247D62A584ULL, -582, -156},
+        {0xA3AB66580D5FDAF6ULL, -555, -148},
+        {0xF3E2F893DEC3F126ULL, -529, -140},
+        {0xB5B5ADA8AAFF80B8ULL, -502, -132},
+        {0x87625F056C7C4A8BULL, -475, -124},
+        {0xC9BCFF6034C13053ULL, -449, -116},
+        {0x964E858C91BA2655ULL, -422, -108},
+        {0xDFF9772470297EBDULL, -396, -100},
+        {0xA6DFBD9FB8E5B88FULL, -369, -92},
+        {0xF8A95FCF88747D94ULL, -343, -84},
+        {0xB94470938FA89BCFULL, -316, -76},
+        {0x8A08F0F8BF0F156BULL, -289, -68},
+        {0xCDB02555653131B6ULL, -263, -60},
+        {0x993FE2C6D07B7FACULL, -236, -52},
+        {0xE45C10C42A2B3B06ULL, -210, -44},
+        {0xAA242499697392D3ULL, -183, -36},
+        {0xFD87B5F28300CA0EULL, -157, -28},
+        {0xBCE5086492111AEBULL, -130, -20},
+        {0x8CBCCC096F5088CCULL, -103, -12},
+        {0xD1B71758E219652CULL, -77, -4},
+        {0x9C40000000000000ULL, -50, 4},
+        {0xE8D4A51000000000ULL, -24, 12},
+        {0xAD78EBC5AC620000ULL, 3, 20},
+        {0x813F3978F8940984ULL, 30, 28},
+        {0xC097CE7BC90715B3ULL, 56, 36},
+        {0x8F7E32CE7BEA5C70ULL, 83, 44},
+        {0xD5D238A4ABE98068ULL, 109, 52},
+        {0x9F4F2726179A2245ULL, 136, 60},
+        {0xED63A231D4C4FB27ULL, 162, 68},
+        {0xB0DE65388CC8ADA8ULL, 189, 76},
+        {0x83C7088E1AAB65DBULL, 216, 84},
+        {0xC45D1DF942711D9AULL, 242, 92},
+        {0x924D692CA61BE758ULL, 269, 100},
+        {0xDA01EE641A708DEAULL, 295, 108},
+        {0xA26DA3999AEF774AULL, 322, 116},
+        {0xF209787BB47D6B85ULL, 348, 124},
+        {0xB454E4A179DD1877ULL, 375, 132},
+        {0x865B86925B9BC5C2ULL, 402, 140},
+        {0xC83553C5C8965D3DULL, 428, 148},
+        {0x952AB45CFA97A0B3ULL, 455, 156},
+        {0xDE469FBD99A05FE3ULL, 481, 164},
+        {0xA59BC234DB398C25ULL, 508, 172},
+        {0xF6C69A72A3989F5CULL, 534, 180},
+        {0xB7DCBF5354E9BECEULL, 561, 188},
+        {0x88FCF317F22241E2ULL, 588, 196},
+        {0xCC20CE9BD35C78A5ULL, 614, 204},
+        {0x98165AF37B2153DFULL, 641, 212},
+        {0xE2A0B5DC971F303AULL, 667, 220},
+        {0xA8D9D1535CE3B396ULL, 694, 228},
+        {0xFB9B7CD9A4A7443CULL, 720, 236},
+        {0xBB764C4CA7A44410ULL, 747, 244},
+        {0x8BAB8EEFB6409C1AULL, 774, 252},
+        {0xD01FEF10A657842CULL, 800, 260},
+        {0x9B10A4E5E9913129ULL, 827, 268},
+        {0xE7109BFBA19C0C9DULL, 853, 276},
+        {0xAC2820D9623BF429ULL, 880, 284},
+        {0x80444B5E7AA7CF85ULL, 907, 292},
+        {0xBF21E44003ACDD2DULL, 933, 300},
+        {0x8E679C2F5E44FF8FULL, 960, 308},
+        {0xD433179D9C8CB841ULL, 986, 316},
+        {0x9E19DB92B4E31BA9ULL, 1013, 324},
+    };
+    const int f = grisuAlpha - e - 1;
+    const int k = (f * 78913) / (1 << 18) + static_cast<int>(f > 0);
+    const auto index = static_cast<size_t>(300 + k + 7) / 8;
+    NET4CXX_ASSERT(index < sizeof(cachedPowers) / sizeof(cachedPowers[0]));
+    return cachedPowers[index];
+}
+
+static int findLargestPow10(uint32_t n, uint32_t &pow10) {
+    static const uint32_t powers[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+    int digits = 10;
+    while (digits > 1 && n < powers[digits - 1]) {
+        --digits;
+    }
+    pow10 = powers[digits - 1];
+    return digits;
+}
+
+static void grisu2Round(char *buffer, int length, uint64_t dist, uint64_t delta, uint64_t rest, uint64_t tenK) {
+    while (rest < dist && delta - rest >= tenK && (rest + tenK < dist || dist - rest > rest + tenK - dist)) {
+        buffer[length - 1]--;
+        rest += tenK;
+    }
+}
+
+static void grisu2DigitGen(char *buffer, int &length, int &decimalExponent, DiyFp mMinus, DiyFp w, DiyFp mPlus) {
+    uint64_t delta = DiyFp::sub(mPlus, mMinus).f;
+    uint64_t dist = DiyFp::sub(mPlus, w).f;
+    const DiyFp one(uint64_t{1} << -mPlus.e, mPlus.e);
+    auto p1 = static_cast<uint32_t>(mPlus.f >> -one.e);
+    uint64_t p2 = mPlus.f & (one.f - 1);
+    uint32_t pow10;
+    int n = findLargestPow10(p1, pow10);
+    while (n > 0) {
+        const uint32_t digit = p1 / pow10;
+        p1 %= pow10;
+        buffer[length++] = static_cast<char>('0' + digit);
+        --n;
+        const uint64_t rest = (uint64_t{p1} << -one.e) + p2;
+        if (rest <= delta) {
+            decimalExponent += n;
+            grisu2Round(buffer, length, dist, delta, rest, uint64_t{pow10} << -one.e);
+            return;
+        }
+        pow10 /= 10;
+    }
+    int m = 0;
+    for (;;) {
+        p2 *= 10;
+        const uint64_t digit = p2 >> -one.e;
+        p2 &= one.f - 1;
+        buffer[length++] = static_cast<char>('0' + digit);
+        ++m;
+        delta *= 10;
+        dist *= 10;
+        if (p2 <= delta) {
+            break;
+        }
+    }
+    decimalExponent -= m;
+    grisu2Round(buffer, length, dist, delta, p2, one.f);
+}
+
+/// value must be finite and positive
+static void grisu2(char *buffer, int &length, int &decimalExponent, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint64_t hiddenBit = uint64_t{1} << 52u;
+    const uint64_t fraction = bits & (hiddenBit - 1);
+    const auto exponent = static_cast<int>(bits >> 52u);
+    const int bias = 1023 + 52;
+    const DiyFp v = exponent == 0 ? DiyFp(fraction, 1 - bias) : DiyFp(fraction + hiddenBit, exponent - bias);
+    const bool lowerBoundaryIsCloser = fraction == 0 && exponent > 1;
+    const DiyFp plus = DiyFp::normalize(DiyFp(2 * v.f + 1, v.e - 1));
+    const DiyFp minus = DiyFp::normalizeTo(lowerBoundaryIsCloser ? DiyFp(4 * v.f - 1, v.e - 2) :
+                                           DiyFp(2 * v.f - 1, v.e - 1), plus.e);
+    const CachedPower cached = getCachedPowerForBinaryExponent(plus.e);
+    const DiyFp c(cached.f, cached.e);
+    const DiyFp w = DiyFp::mul(DiyFp::normalize(v), c);
+    const DiyFp wMinus = DiyFp::mul(minus, c);
+    const DiyFp wPlus = DiyFp::mul(plus, c);
+    NET4CXX_ASSERT(wPlus.e >= grisuAlpha && wPlus.e <= grisuGamma);
+    length = 0;
+    decimalExponent = -cached.k;
+    grisu2DigitGen(buffer, length, decimalExponent, DiyFp(wMinus.f + 1, wMinus.e), w, DiyFp(wPlus.f - 1, wPlus.e));
+}
+
+static const char digitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static size_t formatUInt64(uint64_t value, char *buffer) {
+    char temp[20];
+    char *current = temp + sizeof(temp);
+    while (value >= 100) {
+        auto index = static_cast<size_t>(value % 100) * 2;
+        value /= 100;
+        *--current = digitPairs[index + 1];
+        *--current = digitPairs[index];
+    }
+    if (value < 10) {
+        *--current = static_cast<char>('0' + value);
+    } else {
+        auto index = static_cast<size_t>(value) * 2;
+        *--current = digitPairs[index + 1];
+        *--current = digitPairs[index];
+    }
+    auto length = static_cast<size_t>(temp + sizeof(temp) - current);
+    memcpy(buffer, current, length);
+    return length;
+}
+
+static size_t formatInt64(int64_t value, char *buffer) {
+    if (value < 0) {
+        *buffer = '-';
+        return formatUInt64(0 - static_cast<uint64_t>(value), buffer + 1) + 1;
+    }
+    return formatUInt64(static_cast<uint64_t>(value), buffer);
+}
+
+struct JSONEscapes {
+    JSONEscapes() {
+        memset(table, 0, sizeof(table));
+        for (int c = 0; c < 0x20; ++c) {
+            table[c] = 'u';
+        }
+        table[(uint8_t)'"'] = '"';
+        table[(uint8_t)'\\'] = '\\';
+        table[(uint8_t)'\b'] = 'b';
+        table[(uint8_t)'\f'] = 'f';
+        table[(uint8_t)'\n'] = 'n';
+        table[(uint8_t)'\r'] = 'r';
+        table[(uint8_t)'\t'] = 't';
+    }
+
+    static const char* get() {
+        static const JSONEscapes instance;
+        return instance.table;
+    }
+
+    /// 0 when the byte is copied as is, 'u' for \u00XX, otherwise the character following the backslash
+    char table[256];
+};
+
+
+class StringSink {
+public:
+    explicit StringSink(std::string &out)
+            : _out(out) {
+
+    }
+
+    void append(const char *data, size_t length) {
+        _out.append(data, length);
+    }
+
+    void push(char c) {
+        _out.push_back(c);
+    }
+protected:
+    std::string &_out;
+};
+
+
+class ByteArraySink {
+public:
+    explicit ByteArraySink(ByteArray &out)
+            : _out(out) {
+
+    }
+
+    void append(const char *data, size_t length) {
+        _out.insert(_out.end(), (const Byte *)data, (const Byte *)data + length);
+    }
+
+    void push(char c) {
+        _out.push_back((Byte)c);
+    }
+protected:
+    ByteArray &_out;
+};
+
+
+class MessageBufferSink {
+public:
+    explicit MessageBufferSink(MessageBuffer &out)
+            : _out(out) {
+
+    }
+
+    void append(const char *data, size_t length) {
+        _out.ensureFreeSpace(length);
+        _out.write((const Byte *)data, length);
+    }
+
+    void push(char c) {
+        // ensureFreeSpace() grows by half the buffer size, which is nothing for an empty or one-byte buffer
+        _out.ensureFreeSpace(1);
+        *_out.getWritePointer() = (Byte)c;
+        _out.writeCompleted(1);
+    }
+protected:
+    MessageBuffer &_out;
+};
+
+
+template <typename SinkT>
+class FastWriter::WriteVisitor: public boost::static_visitor<> {
+public:
+    WriteVisitor(SinkT &sink, bool useSpecialFloats)
+            : _sink(sink)
+            , _useSpecialFloats(useSpecialFloats) {
+
+    }
+
+    void operator()(JSONValue::NullValue v) const {
+        _sink.append("null", 4);
+    }
+
+    void operator()(int64_t v) const {
+        char buffer[24];
+        _sink.append(buffer, formatInt64(v, buffer));
+    }
+
+    void operator()(uint64_t v) const {
+        char buffer[24];
+        _sink.append(buffer, formatUInt64(v, buffer));
+    }
+
+    void operator()(double v) const {
+        if (std::isfinite(v)) {
+            char buffer[maxDoubleLength];
+            _sink.append(buffer, formatDouble(v, buffer));
+        } else if (v != v) {
+            _useSpecialFloats ? _sink.append("NaN", 3) : _sink.append("null", 4);
+        } else if (v < 0.0) {
+            _useSpecialFloats ? _sink.append("-Infinity", 9) : _sink.append("-1e+9999", 8);
+        } else {
+            _useSpecialFloats ? _sink.append("Infinity", 8) : _sink.append("1e+9999", 7);
+        }
+    }
+
+    void operator()(const std::string &v) const {
+        const char *escapes = JSONEscapes::get();
+        const char *current = v.data(), *end = current + v.size(), *run = current;
+        _sink.push('"');
+        for (; current != end; ++current) {
+            auto c = (uint8_t)*current;
+            char escape = escapes[c];
+            if (!escape) {
+                continue;
+            }
+            _sink.append(run, (size_t)(current - run));
+            if (escape == 'u') {
+                const char sequence[6] = {'\\', 'u', '0', '0', hex2[2 * c], hex2[2 * c + 1]};
+                _sink.append(sequence, sizeof(sequence));
+            } else {
+                const char sequence[2] = {'\\', escape};
+                _sink.append(sequence, sizeof(sequence));
+            }
+            run = current + 1;
+        }
+        _sink.append(run, (size_t)(end - run));
+        _sink.push('"');
+    }
+
+    void operator()(bool v) const {
+        v ? _sink.append("true", 4) : _sink.append("false", 5);
+    }
+
+    void operator()(const JSONValue::ArrayType &v) const {
+        _sink.push('[');
+        for (auto iter = v.begin(); iter != v.end(); ++iter) {
+            if (iter != v.begin()) {
+                _sink.push(',');
+            }
+            boost::apply_visitor(*this, iter->_value);
+        }
+        _sink.push(']');
+    }
+
+    void operator()(const JSONValue::ObjectType &v) const {
+        _sink.push('{');
+        for (auto iter = v.begin(); iter != v.end(); ++iter) {
+            if (iter != v.begin()) {
+                _sink.push(',');
+            }
+            (*this)(iter->first);
+            _sink.push(':');
+            boost::apply_visitor(*this, iter->second._value);
+        }
+        _sink.push('}');
+    }
+protected:
+    SinkT &_sink;
+    bool _useSpecialFloats;
+};
+
+
+const size_t FastWriter::maxDoubleLength;
+
+void FastWriter::write(const JSONValue &root, std::string &out) const {
+    StringSink sink(out);
+    boost::apply_visitor(WriteVisitor<StringSink>(sink, _useSpecialFloats), root._value);
+}
+
+void FastWriter::write(const JSONValue &root, ByteArray &out) const {
+    ByteArraySink sink(out);
+    boost::apply_visitor(WriteVisitor<ByteArraySink>(sink, _useSpecialFloats), root._value);
+}
+
+void FastWriter::write(const JSONValue &root, MessageBuffer &out) const {
+    MessageBufferSink sink(out);
+    boost::apply_visitor(WriteVisitor<MessageBufferSink>(sink, _useSpecialFloats), root._value);
+}
+
+size_t FastWriter::formatDouble(double value, char *buffer) {
+    NET4CXX_ASSERT(std::isfinite(value));
+    char *first = buffer;
+    if (std::signbit(value)) {
+        value = -value;
+        *buffer++ = '-';
+    }
+    if (value == 0) {
+        memcpy(buffer, "0.0", 3);
+        return (size_t)(buffer + 3 - first);
+    }
+    int length, decimalExponent;
+    grisu2(buffer, length, decimalExponent, value);
+    // The digits are d1...dk and the value is d1...dk * 10^(n - k)
+    const int k = length;
+    const int n = length + decimalExponent;
+    const int maxExponent = std::numeric_limits<double>::digits10;
+    if (k <= n && n <= maxExponent) {
+        // d1...dk0...0.0, keeps reading back as a double rather than an integer
+        memset(buffer + k, '0', (size_t)(n - k));
+        buffer[n] = '.';
+        buffer[n + 1] = '0';
+        return (size_t)(buffer + n + 2 - first);
+    }
+    if (0 < n && n <= maxExponent) {
+        // d1...dn.dn+1...dk
+        memmove(buffer + n + 1, buffer + n, (size_t)(k - n));
+        buffer[n] = '.';
+        return (size_t)(buffer + k + 1 - first);
+    }
+    if (-4 < n && n <= 0) {
+        // 0.0...0d1...dk
+        memmove(buffer + 2 - n, buffer, (size_t)k);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        memset(buffer + 2, '0', (size_t)-n);
+        return (size_t)(buffer + 2 - n + k - first);
+    }
+    if (k == 1) {
+        // dE+123
+        buffer += 1;
+    } else {
+        // d1.d2...dkE+123
+        memmove(buffer + 2, buffer + 1, (size_t)(k - 1));
+        buffer[1] = '.';
+        buffer += k + 1;
+    }
+    int exponent = n - 1;
+    *buffer++ = 'e';
+    if (exponent < 0) {
+        exponent = -exponent;
+        *buffer++ = '-';
+    } else {
+        *buffer++ = '+';
+    }
+    if (exponent >= 100) {
+        *buffer++ = static_cast<char>('0' + exponent / 100);
+        exponent %= 100;
+    }
+    *buffer++ = digitPairs[exponent * 2];
+    *buffer++ = digitPairs[exponent * 2 + 1];
+    return (size_t)(buffer - first);
+}
+
+
 bool BuiltReader::parse(const char *beginDoc, const char *endDoc, JSONValue &root, bool collectComments) {
     if (_features.allowComments) {
         collectComments = false;
@@ -2081,33 +2829,11 @@ bool BuiltReader::recoverFromError(TokenType skipUntilToken) {
 }
 
 void BuiltReader::getLocationLineAndColumn(const char *location, int &line, int &column) const {
-    const char *current = _begin;
-    const char *lastLineStart = current;
-    line = 0;
-    while (current < location && current != _end) {
-        char c = *current++;
-        if (c == '\r') {
-            if (*current == '\n') {
-                ++current;
-            }
-            lastLineStart = current;
-            ++line;
-        } else if (c == '\n') {
-            lastLineStart = current;
-            ++line;
-        }
-    }
-    // column & line start at 1
-    column = int(location - lastLineStart) + 1;
-    ++line;
+    getLineAndColumn(_begin, _end, location, line, column);
 }
 
 std::string BuiltReader::getLocationLineAndColumn(const char *location) const {
-    int line, column;
-    getLocationLineAndColumn(location, line, column);
-    char buffer[18 + 16 + 16 + 1];
-    snprintf(buffer, sizeof(buffer), "Line %d, Column %d", line, column);
-    return std::string(buffer);
+    return formatLineAndColumn(_begin, _end, location);
 }
 
 void BuiltReader::addComment(const char *begin, const char *end, CommentPlacement placement) {
@@ -2160,21 +2886,557 @@ bool BuiltReader::containsNewLine(const char *begin, const char *end) {
 }
 
 
-bool BuiltCharReader::parse(char const *beginDoc, char const *endDoc, JSONValue *root, std::string *errs) {
-    bool ok = _reader.parse(beginDoc, endDoc, *root, _collectComments);
-    if (errs) {
-        *errs = _reader.getFormattedErrorMessages();
+struct JSONCharClass {
+    enum: uint8_t {
+        SPACE = 0x01,
+        STRING_STOP = 0x02,
+    };
+
+    JSONCharClass() {
+        memset(flags, 0, sizeof(flags));
+        for (auto c: {' ', '\t', '\r', '\n'}) {
+            flags[(uint8_t)c] |= SPACE;
+        }
+        flags[(uint8_t)'"'] |= STRING_STOP;
+        flags[(uint8_t)'\\'] |= STRING_STOP;
     }
-    return ok;
-}
 
+    static const uint8_t* get() {
+        static const JSONCharClass instance;
+        return instance.flags;
+    }
 
-CharReaderBuilder::CharReaderBuilder() {
-    setDefaults(&_settings);
+    uint8_t flags[256];
+};
+
+/// May report false positives but never misses a matching byte
+static inline bool mayContainByte(uint64_t chunk, uint8_t byte) {
+    uint64_t x = chunk ^ (0x0101010101010101ULL * byte);
+    return ((x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL) != 0;
 }
 
-CharReader* CharReaderBuilder::newCharReader() const {
-    bool collectComments = _settings["collectComments"].asBool();
+static inline bool isDigit(char c) {
+    return (unsigned char)(c - '0') < 10;
+}
+
+/// A number in JSON grammar, integers that do not fit in 64 bits become doubles
+struct JSONNumber {
+    enum Kind {
+        INT64,
+        UINT64,
+        DOUBLE,
+    };
+
+    /// Reads the number starting at begin and sets stop past it, or to where it went wrong when it is malformed
+    static bool parse(const char *begin, const char *end, const char *&stop, JSONNumber &number);
+
+    static bool parseDouble(const char *begin, const char *end, double &value);
+
+    Kind kind;
+    int64_t i;
+    uint64_t u;
+    double d;
+};
+
+bool JSONNumber::parse(const char *begin, const char *end, const char *&stop, JSONNumber &number) {
+    const char *current = begin;
+    bool isNegative = current != end && *current == '-';
+    if (isNegative) {
+        ++current;
+    }
+    const char *digits = current;
+    uint64_t result = 0;
+    while (current != end && isDigit(*current)) {
+        result = result * 10 + static_cast<unsigned int>(*current - '0');
+        ++current;
+    }
+    stop = current;
+    auto count = current - digits;
+    if (count == 0 || (count > 1 && *digits == '0')) {
+        return false;
+    }
+    bool isInteger = true;
+    if (current != end && *current == '.') {
+        const char *fraction = ++current;
+        while (current != end && isDigit(*current)) {
+            ++current;
+        }
+        stop = current;
+        if (current == fraction) {
+            return false;
+        }
+        isInteger = false;
+    }
+    if (current != end && (*current == 'e' || *current == 'E')) {
+        ++current;
+        if (current != end && (*current == '+' || *current == '-')) {
+            ++current;
+        }
+        const char *exponent = current;
+        while (current != end && isDigit(*current)) {
+            ++current;
+        }
+        stop = current;
+        if (current == exponent) {
+            return false;
+        }
+        isInteger = false;
+    }
+    if (isInteger && count >= 20) {
+        // Nineteen digits always fit in 64 bits, longer literals are checked digit by digit
+        uint64_t threshold = std::numeric_limits<uint64_t>::max() / 10;
+        result = 0;
+        for (const char *digit = digits; digit != current; ++digit) {
+            auto d = static_cast<unsigned int>(*digit - '0');
+            if (result > threshold || (result == threshold && d > std::numeric_limits<uint64_t>::max() % 10)) {
+                isInteger = false;
+                break;
+            }
+            result = result * 10 + d;
+        }
+    }
+    if (isInteger && isNegative && result > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1) {
+        isInteger = false;
+    }
+    if (!isInteger) {
+        number.kind = DOUBLE;
+        return parseDouble(begin, current, number.d);
+    }
+    if (isNegative) {
+        number.kind = INT64;
+        number.i = static_cast<int64_t>(0 - result);
+    } else if (result <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+        number.kind = INT64;
+        number.i = static_cast<int64_t>(result);
+    } else {
+        number.kind = UINT64;
+        number.u = result;
+    }
+    return true;
+}
+
+bool JSONNumber::parseDouble(const char *begin, const char *end, double &value) {
+    constexpr size_t bufferSize = 32;
+    auto length = static_cast<size_t>(end - begin);
+    char buffer[bufferSize + 1];
+    std::string longBuffer;
+    char *first = buffer;
+    if (length <= bufferSize) {
+        memcpy(buffer, begin, length);
+        buffer[length] = '\0';
+    } else {
+        longBuffer.assign(begin, length);
+        first = &longBuffer[0];
+    }
+    fixNumericLocaleInput(first, first + length);
+    char *last = nullptr;
+    value = strtod(first, &last);
+    return last == first + length;
+}
+
+static const char* decodeUnicodeEscape(const char *&current, const char *end, unsigned int &unicode) {
+    if (end - current < 4) {
+        return "Bad unicode escape sequence in string: four digits expected.";
+    }
+    unicode = 0;
+    for (int index = 0; index < 4; ++index) {
+        char c = *current++;
+        unicode <<= 4;
+        if (c >= '0' && c <= '9') {
+            unicode += static_cast<unsigned int>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            unicode += static_cast<unsigned int>(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            unicode += static_cast<unsigned int>(c - 'A' + 10);
+        } else {
+            return "Bad unicode escape sequence in string: hexadecimal digit expected.";
+        }
+    }
+    return nullptr;
+}
+
+/// current points past a backslash, returns an error message or nullptr once the escape is appended to decoded
+static const char* decodeEscape(const char *&current, const char *end, std::string &decoded) {
+    if (current == end) {
+        return "Empty escape sequence in string";
+    }
+    switch (*current++) {
+        case '"':
+            decoded += '"';
+            break;
+        case '/':
+            decoded += '/';
+            break;
+        case '\\':
+            decoded += '\\';
+            break;
+        case 'b':
+            decoded += '\b';
+            break;
+        case 'f':
+            decoded += '\f';
+            break;
+        case 'n':
+            decoded += '\n';
+            break;
+        case 'r':
+            decoded += '\r';
+            break;
+        case 't':
+            decoded += '\t';
+            break;
+        case 'u': {
+            unsigned int unicode;
+            const char *error = decodeUnicodeEscape(current, end, unicode);
+            if (error) {
+                return error;
+            }
+            if (unicode >= 0xD800 && unicode <= 0xDBFF) {
+                // surrogate pairs
+                unsigned int surrogatePair;
+                if (end - current < 6 || current[0] != '\\' || current[1] != 'u') {
+                    return "expecting another \\u token to begin the second half of a unicode surrogate pair";
+                }
+                current += 2;
+                error = decodeUnicodeEscape(current, end, surrogatePair);
+                if (error) {
+                    return error;
+                }
+                unicode = 0x10000 + ((unicode & 0x3FF) << 10) + (surrogatePair & 0x3FF);
+            }
+            decoded += codePointToUTF8(unicode);
+            break;
+        }
+        default:
+            return "Bad escape sequence in string";
+    }
+    return nullptr;
+}
+
+/// Decodes the text between the quotes of a string
+static const char* decodeString(const char *begin, const char *end, std::string &decoded) {
+    while (begin != end) {
+        auto escape = static_cast<const char *>(memchr(begin, '\\', static_cast<size_t>(end - begin)));
+        if (!escape) {
+            decoded.append(begin, end);
+            break;
+        }
+        decoded.append(begin, escape);
+        begin = escape + 1;
+        const char *error = decodeEscape(begin, end, decoded);
+        if (error) {
+            return error;
+        }
+    }
+    return nullptr;
+}
+
+bool FastReader::parse(const char *beginDoc, const char *endDoc, JSONValue &root) {
+    _begin = beginDoc;
+    _end = endDoc;
+    _current = _begin;
+    _errorLocation = nullptr;
+    _error.clear();
+    if (!skipSpaces() || !readValue(root, 1) || !skipSpaces()) {
+        return false;
+    }
+    if (_features.failIfExtra && _current != _end) {
+        return addError("Extra non-whitespace after JSON value.", _current);
+    }
+    if (_features.strictRoot && !root.isArray() && !root.isObject()) {
+        return addError("A valid JSON document must be either an array or an object value.", _begin);
+    }
+    return true;
+}
+
+std::string FastReader::getFormattedErrorMessages() const {
+    if (good()) {
+        return {};
+    }
+    return "* " + formatLineAndColumn(_begin, _end, _errorLocation) + "\n  " + _error + "\n";
+}
+
+bool FastReader::readValue(JSONValue &value, int depth) {
+    if (depth > _features.stackLimit) {
+        NET4CXX_THROW_EXCEPTION(ParsingError, "Exceeded stackLimit in readValue().");
+    }
+    if (_current == _end) {
+        return addError("Syntax error: value, object or array expected.", _current);
+    }
+    switch (*_current) {
+        case '{': {
+            return readObject(value, depth);
+        }
+        case '[': {
+            return readArray(value, depth);
+        }
+        case '"': {
+            std::string decoded;
+            if (!readString(decoded)) {
+                return false;
+            }
+            value._value = std::move(decoded);
+            return true;
+        }
+        case 't': {
+            if (!readLiteral("true", 4)) {
+                return false;
+            }
+            value._value = true;
+            return true;
+        }
+        case 'f': {
+            if (!readLiteral("false", 5)) {
+                return false;
+            }
+            value._value = false;
+            return true;
+        }
+        case 'n': {
+            if (!readLiteral("null", 4)) {
+                return false;
+            }
+            value._value = JSONValue::NullValue();
+            return true;
+        }
+        case 'N': {
+            if (!_features.allowSpecialFloats || !readLiteral("NaN", 3)) {
+                return addError("Syntax error: value, object or array expected.", _current);
+            }
+            value._value = std::numeric_limits<double>::quiet_NaN();
+            return true;
+        }
+        case 'I': {
+            if (!_features.allowSpecialFloats || !readLiteral("Infinity", 8)) {
+                return addError("Syntax error: value, object or array expected.", _current);
+            }
+            value._value = std::numeric_limits<double>::infinity();
+            return true;
+        }
+        case '-': {
+            if (_features.allowSpecialFloats && _current + 1 != _end && _current[1] == 'I') {
+                if (!readLiteral("-Infinity", 9)) {
+                    return false;
+                }
+                value._value = -std::numeric_limits<double>::infinity();
+                return true;
+            }
+            return readNumber(value);
+        }
+        default: {
+            if (isDigit(*_current)) {
+                return readNumber(value);
+            }
+            return addError("Syntax error: value, object or array expected.", _current);
+        }
+    }
+}
+
+bool FastReader::readObject(JSONValue &value, int depth) {
+    ++_current;
+    value._value = JSONValue::ObjectType();
+    auto &object = boost::get<JSONValue::ObjectType>(value._value);
+    if (!skipSpaces()) {
+        return false;
+    }
+    if (_current != _end && *_current == '}') {
+        ++_current;
+        return true;
+    }
+    std::string name;
+    for (;;) {
+        if (_current == _end || *_current != '"') {
+            return addError("Missing '}' or object member name", _current);
+        }
+        const char *nameStart = _current;
+        name.clear();
+        if (!readString(name) || !skipSpaces()) {
+            return false;
+        }
+        if (_current == _end || *_current != ':') {
+            return addError("Missing ':' after object member name", _current);
+        }
+        ++_current;
+        if (name.length() >= (1U<<30)) {
+            NET4CXX_THROW_EXCEPTION(ParsingError, "keylength >= 2^30");
+        }
+        auto result = object.emplace(std::move(name), JSONValue());
+        if (!result.second && _features.rejectDupKeys) {
+            return addError("Duplicate key: '" + result.first->first + "'", nameStart);
+        }
+        if (!skipSpaces() || !readValue(result.first->second, depth + 1) || !skipSpaces()) {
+            return false;
+        }
+        if (_current != _end) {
+            if (*_current == ',') {
+                ++_current;
+                if (!skipSpaces()) {
+                    return false;
+                }
+                continue;
+            }
+            if (*_current == '}') {
+                ++_current;
+                return true;
+            }
+        }
+        return addError("Missing ',' or '}' in object declaration", _current);
+    }
+}
+
+bool FastReader::readArray(JSONValue &value, int depth) {
+    ++_current;
+    value._value = JSONValue::ArrayType();
+    auto &array = boost::get<JSONValue::ArrayType>(value._value);
+    if (!skipSpaces()) {
+        return false;
+    }
+    if (_current != _end && *_current == ']') {
+        ++_current;
+        return true;
+    }
+    for (;;) {
+        array.emplace_back();
+        if (!readValue(array.back(), depth + 1) || !skipSpaces()) {
+            return false;
+        }
+        if (_current != _end) {
+            if (*_current == ',') {
+                ++_current;
+                if (!skipSpaces()) {
+                    return false;
+                }
+                continue;
+            }
+            if (*_current == ']') {
+                ++_current;
+                return true;
+            }
+        }
+        return addError("Missing ',' or ']' in array declaration", _current);
+    }
+}
+
+bool FastReader::readNumber(JSONValue &value) {
+    const char *start = _current;
+    JSONNumber number;
+    if (!JSONNumber::parse(start, _end, _current, number)) {
+        return addError("'" + std::string(start, _current) + "' is not a number.", start);
+    }
+    switch (number.kind) {
+        case JSONNumber::INT64:
+            value._value = number.i;
+            break;
+        case JSONNumber::UINT64:
+            value._value = number.u;
+            break;
+        case JSONNumber::DOUBLE:
+            value._value = number.d;
+            break;
+    }
+    return true;
+}
+
+bool FastReader::readString(std::string &decoded) {
+    const char *start = _current++;
+    const uint8_t *flags = JSONCharClass::get();
+    for (;;) {
+        const char *current = _current;
+        while (_end - current >= 8) {
+            uint64_t chunk;
+            memcpy(&chunk, current, sizeof(chunk));
+            if (mayContainByte(chunk, '"') || mayContainByte(chunk, '\\')) {
+                break;
+            }
+            current += 8;
+        }
+        while (current != _end && !(flags[(uint8_t)*current] & JSONCharClass::STRING_STOP)) {
+            ++current;
+        }
+        decoded.append(_current, current);
+        _current = current;
+        if (_current == _end) {
+            return addError("Missing '\"' at end of string", start);
+        }
+        if (*_current++ == '"') {
+            return true;
+        }
+        const char *error = decodeEscape(_current, _end, decoded);
+        if (error) {
+            return addError(error, _current);
+        }
+    }
+}
+
+bool FastReader::readLiteral(const char *literal, size_t length) {
+    if (static_cast<size_t>(_end - _current) < length || memcmp(_current, literal, length) != 0) {
+        return addError("Syntax error: value, object or array expected.", _current);
+    }
+    _current += length;
+    return true;
+}
+
+bool FastReader::skipSpaces() {
+    const uint8_t *flags = JSONCharClass::get();
+    for (;;) {
+        while (_current != _end && (flags[(uint8_t)*_current] & JSONCharClass::SPACE)) {
+            ++_current;
+        }
+        if (_current == _end || *_current != '/' || !_features.allowComments) {
+            return true;
+        }
+        if (!skipComment()) {
+            return false;
+        }
+    }
+}
+
+bool FastReader::skipComment() {
+    const char *start = _current++;
+    if (_current != _end && *_current == '*') {
+        for (++_current; _end - _current >= 2; ++_current) {
+            if (_current[0] == '*' && _current[1] == '/') {
+                _current += 2;
+                return true;
+            }
+        }
+        _current = _end;
+        return addError("Unterminated comment.", start);
+    }
+    if (_current != _end && *_current == '/') {
+        while (_current != _end && *_current != '\n' && *_current != '\r') {
+            ++_current;
+        }
+        return true;
+    }
+    return addError("Syntax error: value, object or array expected.", start);
+}
+
+
+bool FastCharReader::parse(char const *beginDoc, char const *endDoc, JSONValue *root, std::string *errs) {
+    bool ok = _reader.parse(beginDoc, endDoc, *root);
+    if (errs) {
+        *errs = _reader.getFormattedErrorMessages();
+    }
+    return ok;
+}
+
+
+bool BuiltCharReader::parse(char const *beginDoc, char const *endDoc, JSONValue *root, std::string *errs) {
+    bool ok = _reader.parse(beginDoc, endDoc, *root, _collectComments);
+    if (errs) {
+        *errs = _reader.getFormattedErrorMessages();
+    }
+    return ok;
+}
+
+
+CharReaderBuilder::CharReaderBuilder() {
+    setDefaults(&_settings);
+}
+
+CharReader* CharReaderBuilder::newCharReader() const {
+    bool collectComments = _settings["collectComments"].asBool();
     ReaderFeatures features;
     features.allowComments = _settings["allowComments"].asBool();
     features.strictRoot = _settings["strictRoot"].asBool();
@@ -2185,6 +3447,9 @@ CharReader* CharReaderBuilder::newCharReader() const {
     features.failIfExtra = _settings["failIfExtra"].asBool();
     features.rejectDupKeys = _settings["rejectDupKeys"].asBool();
     features.allowSpecialFloats = _settings["allowSpecialFloats"].asBool();
+    if (_settings["fastPath"].asBool() && FastReader::isSupported(features)) {
+        return new FastCharReader(features);
+    }
     return new BuiltCharReader(collectComments, features);
 }
 
@@ -2200,6 +3465,7 @@ static void getValidReaderKeys(StringSet *validKeys) {
     validKeys->insert("failIfExtra");
     validKeys->insert("rejectDupKeys");
     validKeys->insert("allowSpecialFloats");
+    validKeys->insert("fastPath");
 }
 
 bool CharReaderBuilder::validate(JSONValue *invalid) const {
@@ -2230,6 +3496,7 @@ void CharReaderBuilder::setDefaults(JSONValue *settings) {
     (*settings)["failIfExtra"] = false;
     (*settings)["rejectDupKeys"] = false;
     (*settings)["allowSpecialFloats"] = false;
+    (*settings)["fastPath"] = false;
 }
 
 void CharReaderBuilder::strictMode(JSONValue *settings) {
@@ -2265,4 +3532,765 @@ std::istream& operator>>(std::istream &sin, JSONValue &root) {
     return sin;
 }
 
+
+bool JSONStreamReader::feed(const char *data, size_t length) {
+    if (_state == State::Error) {
+        return false;
+    }
+    const char *current = data, *end = data + length;
+    _chunk = data;
+    switch (_token) {
+        case Token::String:
+        case Token::Key:
+            current = readString(current, end);
+            break;
+        case Token::Number:
+            current = readNumber(current, end);
+            break;
+        case Token::Literal:
+            current = readLiteral(current, end);
+            break;
+        default:
+            break;
+    }
+    const uint8_t *flags = JSONCharClass::get();
+    while (current && current != end) {
+        if (flags[(uint8_t)*current] & JSONCharClass::SPACE) {
+            ++current;
+            continue;
+        }
+        char c = *current;
+        switch (_state) {
+            case State::FirstValueOrArrayEnd:
+                if (c == ']') {
+                    _tokenOffset = getOffset(current);
+                    current = endContainer('[') ? current + 1 : nullptr;
+                    break;
+                }
+                current = readValue(current, end);
+                break;
+            case State::Value:
+                current = readValue(current, end);
+                break;
+            case State::CommaOrArrayEnd:
+                if (c == ',') {
+                    _state = State::Value;
+                    ++current;
+                } else if (c == ']') {
+                    _tokenOffset = getOffset(current);
+                    current = endContainer('[') ? current + 1 : nullptr;
+                } else {
+                    fail(getExpectation(), getOffset(current));
+                    current = nullptr;
+                }
+                break;
+            case State::FirstKeyOrObjectEnd:
+            case State::Key:
+                if (c == '"') {
+                    startToken(Token::Key, current);
+                    current = readString(current + 1, end);
+                } else if (c == '}' && _state == State::FirstKeyOrObjectEnd) {
+                    _tokenOffset = getOffset(current);
+                    current = endContainer('{') ? current + 1 : nullptr;
+                } else {
+                    fail(getExpectation(), getOffset(current));
+                    current = nullptr;
+                }
+                break;
+            case State::Colon:
+                if (c == ':') {
+                    _state = State::Value;
+                    ++current;
+                } else {
+                    fail(getExpectation(), getOffset(current));
+                    current = nullptr;
+                }
+                break;
+            case State::CommaOrObjectEnd:
+                if (c == ',') {
+                    _state = State::Key;
+                    ++current;
+                } else if (c == '}') {
+                    _tokenOffset = getOffset(current);
+                    current = endContainer('{') ? current + 1 : nullptr;
+                } else {
+                    fail(getExpectation(), getOffset(current));
+                    current = nullptr;
+                }
+                break;
+            default:
+                fail(getExpectation(), getOffset(current));
+                current = nullptr;
+                break;
+        }
+    }
+    _offset += length;
+    return _state != State::Error;
+}
+
+bool JSONStreamReader::finish() {
+    if (_state == State::Error) {
+        return false;
+    }
+    _chunk = nullptr;
+    switch (_token) {
+        case Token::String:
+        case Token::Key:
+            return fail("Missing '\"' at end of string", _tokenOffset);
+        case Token::Number:
+            if (!finishNumber(_buffer.data(), _buffer.data() + _buffer.size())) {
+                return false;
+            }
+            break;
+        case Token::Literal:
+            if (!finishLiteral(_buffer.data(), _buffer.data() + _buffer.size())) {
+                return false;
+            }
+            break;
+        default:
+            break;
+    }
+    if (_state != State::Done) {
+        return fail(getExpectation(), _offset);
+    }
+    return true;
+}
+
+void JSONStreamReader::skipValue() {
+    if (_skipping || _state == State::Done || _state == State::Error) {
+        return;
+    }
+    _skipping = true;
+    _skipContainer = _inStartEvent;
+    _skipDepth = _inStartEvent ? _stack.size() - 1 : _stack.size();
+}
+
+void JSONStreamReader::reset() {
+    _state = State::Value;
+    _token = Token::None;
+    _escaped = false;
+    _skipping = false;
+    _skipContainer = false;
+    _inStartEvent = false;
+    _skipDepth = 0;
+    _stack.clear();
+    _buffer.clear();
+    _offset = 0;
+    _tokenOffset = 0;
+    _chunk = nullptr;
+    _error.clear();
+    _errorOffset = 0;
+}
+
+const char* JSONStreamReader::readValue(const char *current, const char *end) {
+    _tokenOffset = getOffset(current);
+    switch (*current) {
+        case '{':
+        case '[':
+            return startContainer(*current) ? current + 1 : nullptr;
+        case '"':
+            startToken(Token::String, current);
+            return readString(current + 1, end);
+        case 't':
+        case 'f':
+        case 'n':
+            startToken(Token::Literal, current);
+            return readLiteral(current, end);
+        case '-':
+            startToken(Token::Number, current);
+            return readNumber(current, end);
+        default:
+            if (isDigit(*current)) {
+                startToken(Token::Number, current);
+                return readNumber(current, end);
+            }
+            fail("Syntax error: value, object or array expected.", _tokenOffset);
+            return nullptr;
+    }
+}
+
+const char* JSONStreamReader::readString(const char *current, const char *end) {
+    const char *begin = current;
+    const uint8_t *flags = JSONCharClass::get();
+    while (current != end) {
+        if (_escaped) {
+            _escaped = false;
+            ++current;
+            continue;
+        }
+        while (end - current >= 8) {
+            uint64_t chunk;
+            memcpy(&chunk, current, sizeof(chunk));
+            if (mayContainByte(chunk, '"') || mayContainByte(chunk, '\\')) {
+                break;
+            }
+            current += 8;
+        }
+        while (current != end && !(flags[(uint8_t)*current] & JSONCharClass::STRING_STOP)) {
+            ++current;
+        }
+        if (current == end) {
+            break;
+        }
+        if (*current == '"') {
+            bool ok;
+            if (_buffer.empty()) {
+                ok = finishString(begin, current);
+            } else {
+                ok = bufferToken(begin, current) && finishString(_buffer.data(), _buffer.data() + _buffer.size());
+            }
+            return ok ? current + 1 : nullptr;
+        }
+        _escaped = true;
+        ++current;
+    }
+    return bufferToken(begin, end) ? end : nullptr;
+}
+
+const char* JSONStreamReader::readNumber(const char *current, const char *end) {
+    const char *begin = current;
+    while (current != end && (isDigit(*current) || *current == '-' || *current == '+' || *current == '.' ||
+                              *current == 'e' || *current == 'E')) {
+        ++current;
+    }
+    if (current == end) {
+        return bufferToken(begin, end) ? end : nullptr;
+    }
+    bool ok;
+    if (_buffer.empty()) {
+        ok = finishNumber(begin, current);
+    } else {
+        ok = bufferToken(begin, current) && finishNumber(_buffer.data(), _buffer.data() + _buffer.size());
+    }
+    return ok ? current : nullptr;
+}
+
+const char* JSONStreamReader::readLiteral(const char *current, const char *end) {
+    const char *begin = current;
+    while (current != end && *current >= 'a' && *current <= 'z') {
+        ++current;
+    }
+    if (current == end) {
+        return bufferToken(begin, end) ? end : nullptr;
+    }
+    bool ok;
+    if (_buffer.empty()) {
+        ok = finishLiteral(begin, current);
+    } else {
+        ok = bufferToken(begin, current) && finishLiteral(_buffer.data(), _buffer.data() + _buffer.size());
+    }
+    return ok ? current : nullptr;
+}
+
+bool JSONStreamReader::finishString(const char *begin, const char *end) {
+    Token token = _token;
+    _token = Token::None;
+    if (!_skipping) {
+        _decoded.clear();
+        const char *error = decodeString(begin, end, _decoded);
+        if (error) {
+            return fail(error, _tokenOffset);
+        }
+        if (!emit(token == Token::Key ? _handler->onKey(_decoded) : _handler->onString(_decoded))) {
+            return false;
+        }
+    }
+    if (token == Token::Key) {
+        _state = State::Colon;
+    } else {
+        completeValue();
+    }
+    return true;
+}
+
+bool JSONStreamReader::finishNumber(const char *begin, const char *end) {
+    _token = Token::None;
+    JSONNumber number;
+    const char *stop;
+    if (!JSONNumber::parse(begin, end, stop, number) || stop != end) {
+        return fail("'" + std::string(begin, end) + "' is not a number.", _tokenOffset);
+    }
+    if (!_skipping) {
+        bool ok;
+        if (number.kind == JSONNumber::INT64) {
+            ok = _handler->onInt64(number.i);
+        } else if (number.kind == JSONNumber::UINT64) {
+            ok = _handler->onUInt64(number.u);
+        } else {
+            ok = _handler->onDouble(number.d);
+        }
+        if (!emit(ok)) {
+            return false;
+        }
+    }
+    completeValue();
+    return true;
+}
+
+bool JSONStreamReader::finishLiteral(const char *begin, const char *end) {
+    _token = Token::None;
+    std::string literal(begin, end);
+    bool ok = true;
+    if (literal == "true" || literal == "false") {
+        ok = _skipping || _handler->onBool(literal == "true");
+    } else if (literal == "null") {
+        ok = _skipping || _handler->onNull();
+    } else {
+        return fail("Syntax error: value, object or array expected.", _tokenOffset);
+    }
+    if (!emit(ok)) {
+        return false;
+    }
+    completeValue();
+    return true;
+}
+
+bool JSONStreamReader::startContainer(char type) {
+    if (_stack.size() >= _stackLimit) {
+        return fail("Exceeded stackLimit in readValue().", _tokenOffset);
+    }
+    _stack.push_back(type);
+    _state = type == '{' ? State::FirstKeyOrObjectEnd : State::FirstValueOrArrayEnd;
+    if (!_skipping) {
+        _inStartEvent = true;
+        bool ok = type == '{' ? _handler->onStartObject() : _handler->onStartArray();
+        _inStartEvent = false;
+        return emit(ok);
+    }
+    return true;
+}
+
+bool JSONStreamReader::endContainer(char type) {
+    _stack.pop_back();
+    bool skipped = _skipping && !(_skipContainer && _stack.size() == _skipDepth);
+    if (!skipped && !emit(type == '{' ? _handler->onEndObject() : _handler->onEndArray())) {
+        return false;
+    }
+    completeValue();
+    return true;
+}
+
+void JSONStreamReader::completeValue() {
+    if (_skipping && _stack.size() == _skipDepth) {
+        _skipping = false;
+    }
+    if (_stack.empty()) {
+        _state = State::Done;
+    } else {
+        _state = _stack.back() == '{' ? State::CommaOrObjectEnd : State::CommaOrArrayEnd;
+    }
+}
+
+bool JSONStreamReader::bufferToken(const char *begin, const char *end) {
+    if (_skipping && (_token == Token::String || _token == Token::Key)) {
+        // Skipped strings are never decoded, so only the escape state has to survive the chunk boundary
+        return true;
+    }
+    if (_buffer.size() + static_cast<size_t>(end - begin) > _maxTokenSize) {
+        return fail("Token exceeds maxTokenSize.", _tokenOffset);
+    }
+    _buffer.append(begin, end);
+    return true;
+}
+
+const char* JSONStreamReader::getExpectation() const {
+    switch (_state) {
+        case State::FirstKeyOrObjectEnd:
+        case State::Key:
+            return "Missing '}' or object member name";
+        case State::Colon:
+            return "Missing ':' after object member name";
+        case State::CommaOrObjectEnd:
+            return "Missing ',' or '}' in object declaration";
+        case State::CommaOrArrayEnd:
+            return "Missing ',' or ']' in array declaration";
+        case State::Done:
+            return "Extra non-whitespace after JSON value.";
+        default:
+            return "Syntax error: value, object or array expected.";
+    }
+}
+
+bool JSONStreamReader::fail(const std::string &message, size_t offset) {
+    _state = State::Error;
+    _token = Token::None;
+    _error = message;
+    _errorOffset = offset;
+    return false;
+}
+
+
+JSONValue& JSONValueBuilder::addValue(JSONValue &&value) {
+    if (_stack.empty()) {
+        _root = std::move(value);
+        return _root;
+    }
+    JSONValue &parent = *_stack.back();
+    if (parent.isArray()) {
+        return parent.append(std::move(value));
+    }
+    JSONValue &member = parent[_key];
+    member = std::move(value);
+    return member;
+}
+
+
+bool JSONDocument::Node::isNull() const {
+    return !valid() || entry().kind == NULL_VALUE;
+}
+
+bool JSONDocument::Node::isString() const {
+    return valid() && (entry().kind == STRING || entry().kind == ESCAPED_STRING);
+}
+
+bool JSONDocument::Node::isArray() const {
+    return valid() && entry().kind == ARRAY;
+}
+
+bool JSONDocument::Node::isObject() const {
+    return valid() && entry().kind == OBJECT;
+}
+
+size_t JSONDocument::Node::size() const {
+    return isArray() || isObject() ? entry().size : 0;
+}
+JSONType JSONDocument::Node::type() const {
+    if (!valid()) {
+        return JSONType::nullValue;
+    }
+    switch (entry().kind) {
+        case TRUE_VALUE:
+        case FALSE_VALUE:
+            return JSONType::boolValue;
+        case NUMBER:
+            return getValue().type();
+        case STRING:
+        case ESCAPED_STRING:
+            return JSONType::stringValue;
+        case OBJECT:
+            return JSONType::objectValue;
+        case ARRAY:
+            return JSONType::arrayValue;
+        default:
+            return JSONType::nullValue;
+    }
+}
+
+JSONDocument::Node JSONDocument::Node::find(const char *key, size_t length) const {
+    if (!isObject()) {
+        return Node();
+    }
+    const auto &entries = _document->_entries;
+    const char *text = _document->_begin;
+    std::string decoded;
+    for (size_t index = _index + 1; index != entry().next; index = entries[index + 1].next) {
+        const auto &name = entries[index];
+        size_t nameLength = name.end - name.begin - 2;
+        if (name.kind == STRING) {
+            if (nameLength == length && memcmp(text + name.begin + 1, key, length) == 0) {
+                return Node(_document, index + 1);
+            }
+        } else if (nameLength >= length) {
+            // Escapes only ever shrink a name, so a shorter raw name cannot match
+            if (Node(_document, index).decodeString() == std::string(key, length)) {
+                return Node(_document, index + 1);
+            }
+        }
+    }
+    return Node();
+}
+
+JSONDocument::Node JSONDocument::Node::operator[](size_t index) const {
+    if (!isArray() || index >= entry().size) {
+        return Node();
+    }
+    const auto &entries = _document->_entries;
+    size_t element = _index + 1;
+    for (; index != 0; --index) {
+        element = entries[element].next;
+    }
+    return Node(_document, element);
+}
+
+StringVector JSONDocument::Node::getMemberNames() const {
+    StringVector names;
+    if (!isObject()) {
+        return names;
+    }
+    const auto &entries = _document->_entries;
+    names.reserve(entry().size);
+    for (size_t index = _index + 1; index != entry().next; index = entries[index + 1].next) {
+        names.emplace_back(Node(_document, index).decodeString());
+    }
+    return names;
+}
+
+JSONValue JSONDocument::Node::getValue() const {
+    if (!valid()) {
+        return JSONValue();
+    }
+    const auto &entries = _document->_entries;
+    switch (entry().kind) {
+        case TRUE_VALUE:
+            return true;
+        case FALSE_VALUE:
+            return false;
+        case NUMBER: {
+            JSONNumber number;
+            const char *begin = rawData(), *end = begin + rawSize(), *stop;
+            if (!JSONNumber::parse(begin, end, stop, number) || stop != end) {
+                NET4CXX_THROW_EXCEPTION(ParsingError, "'" + getRaw() + "' is not a number.");
+            }
+            if (number.kind == JSONNumber::INT64) {
+                return number.i;
+            } else if (number.kind == JSONNumber::UINT64) {
+                return number.u;
+            }
+            return number.d;
+        }
+        case STRING:
+            return JSONValue(rawData() + 1, rawSize() - 2);
+        case ESCAPED_STRING:
+            return decodeString();
+        case OBJECT: {
+            JSONValue value(JSONType::objectValue);
+            for (size_t index = _index + 1; index != entry().next; index = entries[index + 1].next) {
+                value[Node(_document, index).decodeString()] = Node(_document, index + 1).getValue();
+            }
+            return value;
+        }
+        case ARRAY: {
+            JSONValue value(JSONType::arrayValue);
+            for (size_t index = _index + 1; index != entry().next; index = entries[index].next) {
+                value.append(Node(_document, index).getValue());
+            }
+            return value;
+        }
+        default:
+            return JSONValue();
+    }
+}
+
+const char* JSONDocument::Node::rawData() const {
+    return valid() ? _document->_begin + entry().begin : nullptr;
+}
+
+size_t JSONDocument::Node::rawSize() const {
+    return valid() ? entry().end - entry().begin : 0;
+}
+
+const JSONDocument::Entry& JSONDocument::Node::entry() const {
+    return _document->_entries[_index];
+}
+
+std::string JSONDocument::Node::decodeString() const {
+    std::string decoded;
+    const char *begin = rawData() + 1, *end = rawData() + rawSize() - 1;
+    if (entry().kind == STRING) {
+        decoded.assign(begin, end);
+    } else {
+        const char *error = net4cxx::decodeString(begin, end, decoded);
+        if (error) {
+            NET4CXX_THROW_EXCEPTION(ParsingError, error);
+        }
+    }
+    return decoded;
+}
+
+
+bool JSONDocument::parse(const char *beginDoc, const char *endDoc) {
+    _begin = beginDoc;
+    _end = endDoc;
+    _current = _begin;
+    _entries.clear();
+    _error.clear();
+    _errorOffset = 0;
+    if (static_cast<size_t>(_end - _begin) > std::numeric_limits<uint32_t>::max()) {
+        return addError("Document too large to index.", _begin);
+    }
+    skipSpaces();
+    if (!readValue(0)) {
+        return false;
+    }
+    skipSpaces();
+    if (_current != _end) {
+        return addError("Extra non-whitespace after JSON value.", _current);
+    }
+    return true;
+}
+
+JSONDocument::Node JSONDocument::at(const std::string &pointer) const {
+    Node node = root();
+    if (!pointer.empty() && pointer[0] != '/') {
+        return Node();
+    }
+    size_t position = 0;
+    std::string token;
+    while (node && position != pointer.size()) {
+        size_t next = pointer.find('/', position + 1);
+        if (next == std::string::npos) {
+            next = pointer.size();
+        }
+        token.clear();
+        for (size_t index = position + 1; index != next; ++index) {
+            if (pointer[index] == '~' && index + 1 != next &&
+                (pointer[index + 1] == '0' || pointer[index + 1] == '1')) {
+                token += pointer[++index] == '0' ? '~' : '/';
+            } else {
+                token += pointer[index];
+            }
+        }
+        if (node.isArray()) {
+            if (token.empty() || token.size() > 10 || !std::all_of(token.begin(), token.end(), isDigit) ||
+                (token.size() > 1 && token[0] == '0')) {
+                return Node();
+            }
+            node = node[static_cast<size_t>(std::stoull(token))];
+        } else {
+            node = node[token];
+        }
+        position = next;
+    }
+    return node;
+}
+
+bool JSONDocument::readValue(size_t depth) {
+    if (_current == _end) {
+        return addError("Syntax error: value, object or array expected.", _current);
+    }
+    switch (*_current) {
+        case '{':
+        case '[':
+            if (depth >= _stackLimit) {
+                return addError("Exceeded stackLimit in readValue().", _current);
+            }
+            return readContainer(depth + 1, *_current == '{' ? '}' : ']');
+        case '"':
+            return readString();
+        case 't':
+            return readLiteral("true", 4, TRUE_VALUE);
+        case 'f':
+            return readLiteral("false", 5, FALSE_VALUE);
+        case 'n':
+            return readLiteral("null", 4, NULL_VALUE);
+        default:
+            if (*_current == '-' || isDigit(*_current)) {
+                return readNumber();
+            }
+            return addError("Syntax error: value, object or array expected.", _current);
+    }
+}
+
+bool JSONDocument::readContainer(size_t depth, char close) {
+    size_t index = addEntry(close == '}' ? OBJECT : ARRAY, _current++);
+    uint32_t size = 0;
+    skipSpaces();
+    if (_current != _end && *_current == close) {
+        ++_current;
+        closeEntry(index);
+        return true;
+    }
+    for (;;) {
+        if (close == '}') {
+            if (_current == _end || *_current != '"') {
+                return addError("Missing '}' or object member name", _current);
+            }
+            if (!readString()) {
+                return false;
+            }
+            skipSpaces();
+            if (_current == _end || *_current != ':') {
+                return addError("Missing ':' after object member name", _current);
+            }
+            ++_current;
+            skipSpaces();
+        }
+        if (!readValue(depth)) {
+            return false;
+        }
+        ++size;
+        skipSpaces();
+        if (_current != _end && *_current == ',') {
+            ++_current;
+            skipSpaces();
+        } else if (_current != _end && *_current == close) {
+            ++_current;
+            break;
+        } else {
+            return addError(close == '}' ? "Missing ',' or '}' in object declaration" :
+                            "Missing ',' or ']' in array declaration", _current);
+        }
+    }
+    closeEntry(index);
+    _entries[index].size = size;
+    return true;
+}
+
+bool JSONDocument::readString() {
+    const char *start = _current++;
+    size_t index = addEntry(STRING, start);
+    const uint8_t *flags = JSONCharClass::get();
+    for (;;) {
+        while (_end - _current >= 8) {
+            uint64_t chunk;
+            memcpy(&chunk, _current, sizeof(chunk));
+            if (mayContainByte(chunk, '"') || mayContainByte(chunk, '\\')) {
+                break;
+            }
+            _current += 8;
+        }
+        while (_current != _end && !(flags[(uint8_t)*_current] & JSONCharClass::STRING_STOP)) {
+            ++_current;
+        }
+        if (_current == _end) {
+            return addError("Missing '\"' at end of string", start);
+        }
+        if (*_current++ == '"') {
+            closeEntry(index);
+            return true;
+        }
+        // Escapes are checked when the string gets decoded
+        _entries[index].kind = ESCAPED_STRING;
+        if (_current == _end) {
+            return addError("Missing '\"' at end of string", start);
+        }
+        ++_current;
+    }
+}
+
+bool JSONDocument::readNumber() {
+    size_t index = addEntry(NUMBER, _current);
+    // Only the extent is found here, the grammar is checked when the number gets decoded
+    while (_current != _end && (isDigit(*_current) || *_current == '-' || *_current == '+' || *_current == '.' ||
+                                *_current == 'e' || *_current == 'E')) {
+        ++_current;
+    }
+    closeEntry(index);
+    return true;
+}
+
+bool JSONDocument::readLiteral(const char *literal, size_t length, Kind kind) {
+    if (static_cast<size_t>(_end - _current) < length || memcmp(_current, literal, length) != 0) {
+        return addError("Syntax error: value, object or array expected.", _current);
+    }
+    size_t index = addEntry(kind, _current);
+    _current += length;
+    closeEntry(index);
+    return true;
+}
+
+void JSONDocument::skipSpaces() {
+    const uint8_t *flags = JSONCharClass::get();
+    while (_current != _end && (flags[(uint8_t)*_current] & JSONCharClass::SPACE)) {
+        ++_current;
+    }
+}
+
+bool JSONDocument::addError(const std::string &message, const char *location) {
+    _entries.clear();
+    _error = message;
+    _errorOffset = static_cast<size_t>(location - _begin);
+    return false;
+}
+
 NS_END
\ No newline at end of file
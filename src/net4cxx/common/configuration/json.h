@@ -33,13 +33,119 @@ enum CommentPlacement {
 };
 
 
+class JSONValue;
+
+
+/// Insertion-ordered member storage: members sit in one contiguous vector and are scanned linearly, an open
+/// addressing index over their positions is only built once the object grows past indexThreshold members.
+/// Keys must not be modified through iterators.
+///
+/// JSONValue only stores objects this way when built with NET4CXX_JSON_FLAT_OBJECTS, the default stays std::map.
+/// Opting in changes member iteration, getMemberNames() and writer output from sorted to insertion order, and an
+/// insertion may reallocate the members, invalidating references to other members of the same object.
+class NET4CXX_COMMON_API JSONObject {
+public:
+    using value_type = std::pair<std::string, JSONValue>;
+    using MemberList = std::vector<value_type>;
+    using iterator = MemberList::iterator;
+    using const_iterator = MemberList::const_iterator;
+
+    static const size_t indexThreshold = 8;
+
+    friend bool operator<(const JSONObject &lhs, const JSONObject &rhs);
+    friend bool operator==(const JSONObject &lhs, const JSONObject &rhs);
+
+    JSONObject() = default;
+
+    JSONObject(const JSONObject &other);
+
+    JSONObject(JSONObject &&other) = default;
+
+    JSONObject& operator=(const JSONObject &other);
+
+    JSONObject& operator=(JSONObject &&other) = default;
+
+    iterator begin();
+
+    iterator end();
+
+    const_iterator begin() const;
+
+    const_iterator end() const;
+
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    const_iterator cend() const {
+        return end();
+    }
+
+    size_t size() const;
+
+    bool empty() const;
+
+    void clear();
+
+    void reserve(size_t capacity);
+
+    iterator find(const char *key, size_t length);
+
+    const_iterator find(const char *key, size_t length) const;
+
+    iterator find(const char *key) {
+        return find(key, strlen(key));
+    }
+
+    const_iterator find(const char *key) const {
+        return find(key, strlen(key));
+    }
+
+    iterator find(const std::string &key) {
+        return find(key.data(), key.size());
+    }
+
+    const_iterator find(const std::string &key) const {
+        return find(key.data(), key.size());
+    }
+
+    /// Leaves an existing member untouched and returns it with false, like std::map::emplace
+    std::pair<iterator, bool> emplace(std::string key, JSONValue value);
+
+    iterator erase(iterator pos);
+protected:
+    static size_t hashKey(const char *key, size_t length);
+
+    size_t lookup(const char *key, size_t length) const;
+
+    void insertIndex(size_t position);
+
+    void eraseIndex(size_t position);
+
+    void rebuildIndex();
+
+    using Index = std::vector<uint32_t>;
+
+    MemberList _members;
+    std::unique_ptr<Index> _index;
+};
+
+NET4CXX_COMMON_API bool operator<(const JSONObject &lhs, const JSONObject &rhs);
+
+NET4CXX_COMMON_API bool operator==(const JSONObject &lhs, const JSONObject &rhs);
+
+
 class NET4CXX_COMMON_API JSONValue {
 public:
     struct NullValue {
 
     };
 
+#ifdef NET4CXX_JSON_FLAT_OBJECTS
+    using ObjectType = JSONObject;
+#else
     using ObjectType = std::map<std::string, JSONValue>;
+#endif
     using ArrayType = std::vector<JSONValue>;
     using ValueType = boost::variant<NullValue, int64_t, uint64_t, double, std::string, bool, ArrayType, ObjectType>;
     using ArrayIterator = ArrayType::iterator;
@@ -49,9 +155,19 @@ public:
 
     friend bool operator<(const JSONValue &lhs, const JSONValue &rhs);
     friend bool operator==(const JSONValue &lhs, const JSONValue &rhs);
+    friend class FastReader;
+    friend class FastWriter;
 
     JSONValue() = default;
 
+    JSONValue(const JSONValue &other)
+            : _value(other._value)
+            , _comments(other._comments ? std::make_unique<CommentArray>(*other._comments) : nullptr) {
+
+    }
+
+    JSONValue(JSONValue &&other) = default;
+
     JSONValue(JSONType type);
 
     JSONValue(nullptr_t) {
@@ -98,6 +214,16 @@ public:
 
     }
 
+    JSONValue& operator=(const JSONValue &other) {
+        if (this != &other) {
+            _value = other._value;
+            _comments = other._comments ? std::make_unique<CommentArray>(*other._comments) : nullptr;
+        }
+        return *this;
+    }
+
+    JSONValue& operator=(JSONValue &&other) = default;
+
     void swap(JSONValue &other) {
         std::swap(*this, other);
     }
@@ -218,10 +344,12 @@ public:
         return (*this)[size()] = std::move(value);
     }
 
-    JSONValue& operator[](const char *key);
+    JSONValue& operator[](const char *key) {
+        return resolveReference(key, strlen(key));
+    }
 
     JSONValue& operator[](const std::string &key) {
-        return (*this)[key.c_str()];
+        return resolveReference(key.data(), key.size());
     }
 
     const JSONValue& operator[](const char *key) const;
@@ -236,10 +364,14 @@ public:
         return get(key.c_str(), defaultValue);
     }
 
-    const JSONValue* find(const char *key) const;
+    const JSONValue* find(const char *key, size_t length) const;
+
+    const JSONValue* find(const char *key) const {
+        return find(key, strlen(key));
+    }
 
     const JSONValue* find(const std::string &key) const {
-        return find(key.c_str());
+        return find(key.data(), key.size());
     }
 
     bool removeMember(const char *key, JSONValue *removed= nullptr);
@@ -261,24 +393,22 @@ public:
     StringVector getMemberNames() const;
 
     void setComment(const char *comment, CommentPlacement placement) {
-        _comments[placement] = comment;
+        comments()[placement] = comment;
     }
 
     void setComment(const std::string &comment, CommentPlacement placement) {
-        _comments[placement] = comment;
+        comments()[placement] = comment;
     }
 
     void setComment(std::string &&comment, CommentPlacement placement) {
-        _comments[placement] = std::move(comment);
+        comments()[placement] = std::move(comment);
     }
 
     bool hasComment(CommentPlacement placement) const {
-        return !_comments[placement].empty();
+        return _comments && !(*_comments)[placement].empty();
     }
 
-    const std::string& getComment(CommentPlacement placement) const {
-        return _comments[placement];
-    }
+    const std::string& getComment(CommentPlacement placement) const;
 
     std::string toStyledString() const;
 
@@ -324,11 +454,57 @@ public:
 
     static const JSONValue& nullSingleton();
 private:
+    using CommentArray = std::array<std::string, COMMENT_COUNT>;
+
+    JSONValue& resolveReference(const char *key, size_t length);
+
+    CommentArray& comments() {
+        if (!_comments) {
+            _comments = std::make_unique<CommentArray>();
+        }
+        return *_comments;
+    }
+
     ValueType _value;
-    std::array<std::string, COMMENT_COUNT> _comments;
+    std::unique_ptr<CommentArray> _comments;
 };
 
 
+inline JSONObject::iterator JSONObject::begin() {
+    return _members.begin();
+}
+
+inline JSONObject::iterator JSONObject::end() {
+    return _members.end();
+}
+
+inline JSONObject::const_iterator JSONObject::begin() const {
+    return _members.begin();
+}
+
+inline JSONObject::const_iterator JSONObject::end() const {
+    return _members.end();
+}
+
+inline size_t JSONObject::size() const {
+    return _members.size();
+}
+
+inline bool JSONObject::empty() const {
+    return _members.empty();
+}
+
+inline JSONObject::iterator JSONObject::find(const char *key, size_t length) {
+    size_t position = lookup(key, length);
+    return position < _members.size() ? std::next(_members.begin(), position) : _members.end();
+}
+
+inline JSONObject::const_iterator JSONObject::find(const char *key, size_t length) const {
+    size_t position = lookup(key, length);
+    return position < _members.size() ? std::next(_members.begin(), position) : _members.end();
+}
+
+
 inline bool operator<(const JSONValue &lhs, const JSONValue &rhs) {
     return lhs._value < rhs._value;
 }
@@ -503,6 +679,42 @@ NET4CXX_COMMON_API std::string writeString(const StreamWriter::Factory &factory,
 NET4CXX_COMMON_API std::ostream& operator<<(std::ostream &sout, const JSONValue &root);
 
 
+class MessageBuffer;
+
+
+/// Compact writer appending straight to a caller-owned buffer. Doubles get the shortest digits that read back to
+/// the same value, non-ASCII characters are emitted as UTF-8 and comments are dropped.
+class NET4CXX_COMMON_API FastWriter {
+public:
+    static const size_t maxDoubleLength = 32;
+
+    explicit FastWriter(bool useSpecialFloats=false)
+            : _useSpecialFloats(useSpecialFloats) {
+
+    }
+
+    void write(const JSONValue &root, std::string &out) const;
+
+    void write(const JSONValue &root, ByteArray &out) const;
+
+    void write(const JSONValue &root, MessageBuffer &out) const;
+
+    std::string write(const JSONValue &root) const {
+        std::string out;
+        write(root, out);
+        return out;
+    }
+
+    /// value must be finite, buffer needs maxDoubleLength bytes, returns the number of bytes written
+    static size_t formatDouble(double value, char *buffer);
+protected:
+    template <typename SinkT>
+    class WriteVisitor;
+
+    bool _useSpecialFloats;
+};
+
+
 class NET4CXX_COMMON_API CharReader {
 public:
     virtual ~CharReader() = default;
@@ -672,6 +884,58 @@ protected:
 };
 
 
+/// Single-pass recursive descent reader, builds values in place and stops at the first error.
+/// Comments are skipped but never collected, single quotes, numeric keys and dropped nulls are not supported.
+class FastReader: public boost::noncopyable {
+public:
+    explicit FastReader(const ReaderFeatures &features)
+            : _features(features) {
+
+    }
+
+    bool parse(const char *beginDoc, const char *endDoc, JSONValue &root);
+
+    std::string getFormattedErrorMessages() const;
+
+    bool good() const {
+        return _errorLocation == nullptr;
+    }
+
+    static bool isSupported(const ReaderFeatures &features) {
+        return !features.allowDroppedNullPlaceholders && !features.allowNumericKeys && !features.allowSingleQuotes;
+    }
+protected:
+    bool readValue(JSONValue &value, int depth);
+
+    bool readObject(JSONValue &value, int depth);
+
+    bool readArray(JSONValue &value, int depth);
+
+    bool readNumber(JSONValue &value);
+
+    bool readString(std::string &decoded);
+
+    bool readLiteral(const char *literal, size_t length);
+
+    bool skipSpaces();
+
+    bool skipComment();
+
+    bool addError(const std::string &message, const char *location) {
+        _error = message;
+        _errorLocation = location;
+        return false;
+    }
+
+    const char *_begin{nullptr};
+    const char *_end{nullptr};
+    const char *_current{nullptr};
+    const char *_errorLocation{nullptr};
+    std::string _error;
+    ReaderFeatures _features;
+};
+
+
 class NET4CXX_COMMON_API BuiltCharReader: public CharReader {
 public:
     BuiltCharReader(bool collectComments, const ReaderFeatures &features)
@@ -687,6 +951,19 @@ protected:
 };
 
 
+class NET4CXX_COMMON_API FastCharReader: public CharReader {
+public:
+    explicit FastCharReader(const ReaderFeatures &features)
+            : _reader(features) {
+
+    }
+
+    bool parse(char const* beginDoc, char const* endDoc, JSONValue* root, std::string *errs) override;
+protected:
+    FastReader _reader;
+};
+
+
 class NET4CXX_COMMON_API CharReaderBuilder: public CharReader::Factory {
 public:
     CharReaderBuilder();
@@ -720,6 +997,434 @@ NET4CXX_COMMON_API bool parseFromStream(const CharReader::Factory &factory, std:
 
 NET4CXX_COMMON_API std::istream& operator>>(std::istream &sin, JSONValue &root);
 
+
+/// Receives the events of a JSONStreamReader, returning false from any of them aborts the parse
+class NET4CXX_COMMON_API JSONHandler {
+public:
+    virtual ~JSONHandler() = default;
+
+    virtual bool onNull() {
+        return true;
+    }
+
+    virtual bool onBool(bool value) {
+        return true;
+    }
+
+    virtual bool onInt64(int64_t value) {
+        return true;
+    }
+
+    virtual bool onUInt64(uint64_t value) {
+        return true;
+    }
+
+    virtual bool onDouble(double value) {
+        return true;
+    }
+
+    virtual bool onString(const std::string &value) {
+        return true;
+    }
+
+    virtual bool onStartObject() {
+        return true;
+    }
+
+    virtual bool onKey(const std::string &key) {
+        return true;
+    }
+
+    virtual bool onEndObject() {
+        return true;
+    }
+
+    virtual bool onStartArray() {
+        return true;
+    }
+
+    virtual bool onEndArray() {
+        return true;
+    }
+};
+
+
+/// Incremental reader fed with chunks as they arrive, reports a single strict JSON document as events.
+/// Memory stays bounded by the nesting depth and the longest token that straddles a chunk boundary.
+class NET4CXX_COMMON_API JSONStreamReader: public boost::noncopyable {
+public:
+    explicit JSONStreamReader(JSONHandler *handler, size_t maxTokenSize=16 * 1024 * 1024, size_t stackLimit=1000)
+            : _handler(handler)
+            , _maxTokenSize(maxTokenSize)
+            , _stackLimit(stackLimit) {
+
+    }
+
+    /// Returns false once the document turned out malformed or the handler aborted
+    bool feed(const char *data, size_t length);
+
+    bool feed(const ByteArray &data) {
+        return feed((const char *)data.data(), data.size());
+    }
+
+    /// Ends the input, a number at the very end of the document is only complete here
+    bool finish();
+
+    /// Called from onKey, skips the member's value; called from onStartObject or onStartArray, skips the contents
+    /// of that container up to its end event. Skipped values are scanned but never decoded or buffered.
+    void skipValue();
+
+    void reset();
+
+    bool isDone() const {
+        return _state == State::Done;
+    }
+
+    bool good() const {
+        return _state != State::Error;
+    }
+
+    const std::string& getError() const {
+        return _error;
+    }
+
+    size_t getErrorOffset() const {
+        return _errorOffset;
+    }
+protected:
+    enum class State {
+        Value,
+        FirstValueOrArrayEnd,
+        CommaOrArrayEnd,
+        FirstKeyOrObjectEnd,
+        Key,
+        Colon,
+        CommaOrObjectEnd,
+        Done,
+        Error,
+    };
+
+    enum class Token {
+        None,
+        String,
+        Key,
+        Number,
+        Literal,
+    };
+
+    const char* readValue(const char *current, const char *end);
+
+    const char* readString(const char *current, const char *end);
+
+    const char* readNumber(const char *current, const char *end);
+
+    const char* readLiteral(const char *current, const char *end);
+
+    bool finishString(const char *begin, const char *end);
+
+    bool finishNumber(const char *begin, const char *end);
+
+    bool finishLiteral(const char *begin, const char *end);
+
+    bool startContainer(char type);
+
+    bool endContainer(char type);
+
+    void completeValue();
+
+    void startToken(Token token, const char *current) {
+        _token = token;
+        _tokenOffset = getOffset(current);
+        _escaped = false;
+        _buffer.clear();
+    }
+
+    bool bufferToken(const char *begin, const char *end);
+
+    const char* getExpectation() const;
+
+    size_t getOffset(const char *location) const {
+        return _offset + static_cast<size_t>(location - _chunk);
+    }
+
+    bool emit(bool result) {
+        return result || fail("Parsing aborted by handler.", _tokenOffset);
+    }
+
+    bool fail(const std::string &message, size_t offset);
+
+    JSONHandler *_handler;
+    size_t _maxTokenSize;
+    size_t _stackLimit;
+    State _state{State::Value};
+    Token _token{Token::None};
+    bool _escaped{false};
+    bool _skipping{false};
+    bool _skipContainer{false};
+    bool _inStartEvent{false};
+    size_t _skipDepth{0};
+    std::vector<char> _stack;
+    std::string _buffer;
+    std::string _decoded;
+    size_t _offset{0};
+    size_t _tokenOffset{0};
+    const char *_chunk{nullptr};
+    std::string _error;
+    size_t _errorOffset{0};
+};
+
+
+/// Builds a JSONValue from the events of a JSONStreamReader
+class NET4CXX_COMMON_API JSONValueBuilder: public JSONHandler {
+public:
+    explicit JSONValueBuilder(JSONValue &root)
+            : _root(root) {
+
+    }
+
+    bool onNull() override {
+        addValue(JSONValue());
+        return true;
+    }
+
+    bool onBool(bool value) override {
+        addValue(value);
+        return true;
+    }
+
+    bool onInt64(int64_t value) override {
+        addValue(value);
+        return true;
+    }
+
+    bool onUInt64(uint64_t value) override {
+        addValue(value);
+        return true;
+    }
+
+    bool onDouble(double value) override {
+        addValue(value);
+        return true;
+    }
+
+    bool onString(const std::string &value) override {
+        addValue(value);
+        return true;
+    }
+
+    bool onStartObject() override {
+        _stack.push_back(&addValue(JSONType::objectValue));
+        return true;
+    }
+
+    bool onKey(const std::string &key) override {
+        _key = key;
+        return true;
+    }
+
+    bool onEndObject() override {
+        _stack.pop_back();
+        return true;
+    }
+
+    bool onStartArray() override {
+        _stack.push_back(&addValue(JSONType::arrayValue));
+        return true;
+    }
+
+    bool onEndArray() override {
+        _stack.pop_back();
+        return true;
+    }
+protected:
+    JSONValue& addValue(JSONValue &&value);
+
+    JSONValue &_root;
+    std::vector<JSONValue *> _stack;
+    std::string _key;
+};
+
+
+/// Structural index over a strict JSON text, values are only decoded when they are accessed.
+/// The document never copies the text, which has to outlive it and every Node taken from it.
+class NET4CXX_COMMON_API JSONDocument: public boost::noncopyable {
+protected:
+    struct Entry;
+public:
+    /// Handle to a value of the document, a missing value reads as null
+    class NET4CXX_COMMON_API Node {
+    public:
+        Node() = default;
+
+        Node(const JSONDocument *document, size_t index)
+                : _document(document)
+                , _index(index) {
+
+        }
+
+        bool valid() const {
+            return _document != nullptr;
+        }
+
+        explicit operator bool() const {
+            return valid();
+        }
+
+        JSONType type() const;
+
+        bool isNull() const;
+
+        bool isString() const;
+
+        bool isArray() const;
+
+        bool isObject() const;
+
+        /// Number of members or elements, zero for anything else
+        size_t size() const;
+
+        Node find(const char *key, size_t length) const;
+
+        Node operator[](const char *key) const {
+            return find(key, strlen(key));
+        }
+
+        Node operator[](const std::string &key) const {
+            return find(key.data(), key.size());
+        }
+
+        Node operator[](size_t index) const;
+
+        Node operator[](int index) const {
+            NET4CXX_ASSERT(index >= 0);
+            return (*this)[static_cast<size_t>(index)];
+        }
+
+        StringVector getMemberNames() const;
+
+        /// Decodes this value and everything below it, throws ParsingError on a malformed number or string
+        JSONValue getValue() const;
+
+        std::string asString() const {
+            return getValue().asString();
+        }
+
+        int asInt() const {
+            return getValue().asInt();
+        }
+
+        int64_t asInt64() const {
+            return getValue().asInt64();
+        }
+
+        uint64_t asUInt64() const {
+            return getValue().asUInt64();
+        }
+
+        double asDouble() const {
+            return getValue().asDouble();
+        }
+
+        bool asBool() const {
+            return getValue().asBool();
+        }
+
+        /// The value's original text, ready to be forwarded untouched
+        const char* rawData() const;
+
+        size_t rawSize() const;
+
+        std::string getRaw() const {
+            return std::string(rawData(), rawSize());
+        }
+    protected:
+        const Entry& entry() const;
+
+        std::string decodeString() const;
+
+        const JSONDocument *_document{nullptr};
+        size_t _index{0};
+    };
+
+    explicit JSONDocument(size_t stackLimit=1000)
+            : _stackLimit(stackLimit) {
+
+    }
+
+    bool parse(const char *beginDoc, const char *endDoc);
+
+    bool good() const {
+        return !_entries.empty();
+    }
+
+    const std::string& getError() const {
+        return _error;
+    }
+
+    size_t getErrorOffset() const {
+        return _errorOffset;
+    }
+
+    Node root() const {
+        return _entries.empty() ? Node() : Node(this, 0);
+    }
+
+    /// Resolves a JSON pointer (RFC 6901) such as "/items/0/id"
+    Node at(const std::string &pointer) const;
+protected:
+    enum Kind: uint8_t {
+        NULL_VALUE,
+        TRUE_VALUE,
+        FALSE_VALUE,
+        NUMBER,
+        STRING,
+        ESCAPED_STRING,
+        OBJECT,
+        ARRAY,
+    };
+
+    /// Containers are followed by their children, key and value entries alternate within objects
+    struct Entry {
+        uint32_t begin;
+        uint32_t end;
+        uint32_t next;
+        uint32_t size;
+        Kind kind;
+    };
+
+    bool readValue(size_t depth);
+
+    bool readContainer(size_t depth, char close);
+
+    bool readString();
+
+    bool readNumber();
+
+    bool readLiteral(const char *literal, size_t length, Kind kind);
+
+    void skipSpaces();
+
+    size_t addEntry(Kind kind, const char *begin) {
+        _entries.push_back({static_cast<uint32_t>(begin - _begin), 0, 0, 0, kind});
+        return _entries.size() - 1;
+    }
+
+    void closeEntry(size_t index) {
+        _entries[index].end = static_cast<uint32_t>(_current - _begin);
+        _entries[index].next = static_cast<uint32_t>(_entries.size());
+    }
+
+    bool addError(const std::string &message, const char *location);
+
+    size_t _stackLimit;
+    const char *_begin{nullptr};
+    const char *_end{nullptr};
+    const char *_current{nullptr};
+    std::vector<Entry> _entries;
+    std::string _error;
+    size_t _errorOffset{0};
+};
+
 NS_END
 
 #endif //NET4CXX_COMMON_CONFIGURATION_JSON_H
@@ -0,0 +1,148 @@
+//
+// Created by agent on 26-10-18.
+//
+
+#include "net4cxx/common/debugging/metrics.h"
+#include <cmath>
+
+
+NS_BEGIN
+
+const size_t CacheAligned::cacheLineSize;
+
+
+const size_t ShardedValue::shardCount;
+
+std::atomic<size_t> ShardedValue::_nextShard{0};
+
+
+const int HistogramSnapshot::subBucketBits;
+
+const size_t HistogramSnapshot::subBucketCount;
+
+const int HistogramSnapshot::maxValueBits;
+
+const int64_t HistogramSnapshot::maxValue;
+
+const size_t HistogramSnapshot::bucketCount;
+
+void HistogramSnapshot::merge(const HistogramSnapshot &other) {
+    for (size_t i = 0; i != bucketCount; ++i) {
+        _counts[i] += other._counts[i];
+    }
+    _count += other._count;
+    _sum += other._sum;
+    _min = std::min(_min, other._min);
+    _max = std::max(_max, other._max);
+}
+
+int64_t HistogramSnapshot::percentile(double q) const {
+    if (_count == 0) {
+        return 0;
+    }
+    q = std::min(std::max(q, 0.0), 1.0);
+    auto rank = std::max((uint64_t)std::ceil(q * (double)_count), (uint64_t)1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i != bucketCount; ++i) {
+        seen += _counts[i];
+        if (seen >= rank) {
+            return std::max(std::min(bucketUpperBound(i), _max), _min);
+        }
+    }
+    return _max;
+}
+
+
+const size_t Histogram::shardCount;
+
+Histogram::Histogram(std::string name, std::string help)
+        : Metric(std::move(name), std::move(help), MetricType::Histogram) {
+    for (auto &shard: _shards) {
+        shard.counts.reset(new std::atomic<uint64_t>[HistogramSnapshot::bucketCount]);
+        for (size_t i = 0; i != HistogramSnapshot::bucketCount; ++i) {
+            shard.counts[i].store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    HistogramSnapshot snapshot;
+    for (auto &shard: _shards) {
+        for (size_t i = 0; i != HistogramSnapshot::bucketCount; ++i) {
+            snapshot._counts[i] += shard.counts[i].load(std::memory_order_relaxed);
+        }
+        snapshot._count += shard.count.load(std::memory_order_relaxed);
+        snapshot._sum += shard.sum.load(std::memory_order_relaxed);
+        snapshot._min = std::min(snapshot._min, shard.min.load(std::memory_order_relaxed));
+        snapshot._max = std::max(snapshot._max, shard.max.load(std::memory_order_relaxed));
+    }
+    return snapshot;
+}
+
+int64_t Histogram::value() const {
+    int64_t count = 0;
+    for (auto &shard: _shards) {
+        count += (int64_t)shard.count.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+
+Metric* MetricsRegistry::getMetric(const std::string &name) const {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto iter = _metrics.find(name);
+    return iter != _metrics.end() ? iter->second.get() : nullptr;
+}
+
+std::vector<const Metric *> MetricsRegistry::getMetrics() const {
+    std::lock_guard<std::mutex> lock(_lock);
+    std::vector<const Metric *> metrics;
+    metrics.reserve(_metrics.size());
+    for (auto &metric: _metrics) {
+        metrics.push_back(metric.second.get());
+    }
+    return metrics;
+}
+
+void MetricsRegistry::dumpAll(Logger *logger) const {
+    dump(false, logger);
+}
+
+void MetricsRegistry::dumpNonZero(Logger *logger) const {
+    dump(true, logger);
+}
+
+MetricsRegistry* MetricsRegistry::instance() {
+    // Never destroyed, connections held by other statics still update their metrics during exit
+    static MetricsRegistry *instance = new MetricsRegistry;
+    return instance;
+}
+
+void MetricsRegistry::dump(bool nonZero, Logger *logger) const {
+    if (logger == nullptr) {
+        logger = Logging::getRootLogger();
+    }
+    auto metrics = getMetrics();
+    if (metrics.empty()) {
+        return;
+    }
+    NET4CXX_LOG_INFO(logger, "+----------------------------------------|--------------------+");
+    NET4CXX_LOG_INFO(logger, "|%-40s|%-20s|", "MetricName", "CurrentValue");
+    for (auto metric: metrics) {
+        int64_t value = metric->value();
+        if (nonZero && value == 0) {
+            continue;
+        }
+        NET4CXX_LOG_INFO(logger, "+----------------------------------------|--------------------+");
+        NET4CXX_LOG_INFO(logger, "|%-40s|%-20d|", metric->getName(), value);
+        if (metric->getType() == MetricType::Histogram && value != 0) {
+            auto snapshot = static_cast<const Histogram *>(metric)->snapshot();
+            NET4CXX_LOG_INFO(logger, "|%40s|%-20s|", "p50/p99/max",
+                             StrUtil::format("%d/%d/%d", snapshot.percentile(0.5), snapshot.percentile(0.99),
+                                             snapshot.getMax()));
+        }
+    }
+    NET4CXX_LOG_INFO(logger, "+----------------------------------------|--------------------+");
+}
+
+NS_END
@@ -0,0 +1,360 @@
+//
+// Created by agent on 26-10-18.
+//
+
+#ifndef NET4CXX_COMMON_DEBUGGING_METRICS_H
+#define NET4CXX_COMMON_DEBUGGING_METRICS_H
+
+#include "net4cxx/common/common.h"
+#include <array>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <boost/align/aligned_alloc.hpp>
+#include <boost/noncopyable.hpp>
+#include "net4cxx/common/logging/logging.h"
+#include "net4cxx/common/utilities/errors.h"
+
+
+NS_BEGIN
+
+enum class MetricType {
+    Counter,
+    Gauge,
+    Histogram,
+};
+
+
+/// Heap allocation that honours alignas(cacheLineSize) members, which plain operator new does not before C++17
+class NET4CXX_COMMON_API CacheAligned {
+public:
+    static const size_t cacheLineSize = 64;
+
+    static void* operator new(size_t size) {
+        void *p = boost::alignment::aligned_alloc(cacheLineSize, size);
+        if (!p) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    static void operator delete(void *p) noexcept {
+        boost::alignment::aligned_free(p);
+    }
+};
+
+
+/// Sum spread over cache-line aligned shards, writers only touch the shard owned by their thread
+class NET4CXX_COMMON_API ShardedValue: public CacheAligned, public boost::noncopyable {
+public:
+    static const size_t shardCount = 16;
+
+    void add(int64_t value) {
+        _shards[shardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    int64_t load() const {
+        int64_t value = 0;
+        for (auto &shard: _shards) {
+            value += shard.value.load(std::memory_order_relaxed);
+        }
+        return value;
+    }
+
+    static size_t shardIndex() {
+        thread_local size_t index = _nextShard.fetch_add(1, std::memory_order_relaxed) % shardCount;
+        return index;
+    }
+protected:
+    struct alignas(cacheLineSize) Shard {
+        std::atomic<int64_t> value{0};
+    };
+
+    std::array<Shard, shardCount> _shards;
+
+    static std::atomic<size_t> _nextShard;
+};
+
+
+class NET4CXX_COMMON_API Metric: public CacheAligned, public boost::noncopyable {
+public:
+    Metric(std::string name, std::string help, MetricType type)
+            : _name(std::move(name))
+            , _help(std::move(help))
+            , _type(type) {
+
+    }
+
+    virtual ~Metric() = default;
+
+    const std::string& getName() const {
+        return _name;
+    }
+
+    const std::string& getHelp() const {
+        return _help;
+    }
+
+    MetricType getType() const {
+        return _type;
+    }
+
+    virtual int64_t value() const = 0;
+protected:
+    std::string _name;
+    std::string _help;
+    MetricType _type;
+};
+
+
+class NET4CXX_COMMON_API Counter: public Metric {
+public:
+    Counter(std::string name, std::string help)
+            : Metric(std::move(name), std::move(help), MetricType::Counter) {
+
+    }
+
+    void inc(int64_t increment=1) {
+        _value.add(increment);
+    }
+
+    int64_t value() const override {
+        return _value.load();
+    }
+protected:
+    ShardedValue _value;
+};
+
+
+class NET4CXX_COMMON_API Gauge: public Metric {
+public:
+    Gauge(std::string name, std::string help)
+            : Metric(std::move(name), std::move(help), MetricType::Gauge) {
+
+    }
+
+    void inc(int64_t increment=1) {
+        _value.add(increment);
+    }
+
+    void dec(int64_t decrement=1) {
+        _value.add(-decrement);
+    }
+
+    /// Not atomic with respect to concurrent inc/dec
+    void set(int64_t value) {
+        _value.add(value - _value.load());
+    }
+
+    int64_t value() const override {
+        return _value.load();
+    }
+protected:
+    ShardedValue _value;
+};
+
+
+/// Log-linear buckets: values below 32 are exact, above that every power of two is split into 16 sub-buckets,
+/// so a bucket never spans more than 1/16 of its lower bound
+class NET4CXX_COMMON_API HistogramSnapshot {
+public:
+    static const int subBucketBits = 4;
+    static const size_t subBucketCount = (size_t)1 << subBucketBits;
+    static const int maxValueBits = 40;
+    static const int64_t maxValue = (int64_t)1 << maxValueBits;
+    static const size_t bucketCount = (size_t)(maxValueBits - subBucketBits + 1) * subBucketCount;
+
+    HistogramSnapshot()
+            : _counts(bucketCount, 0) {
+
+    }
+
+    void merge(const HistogramSnapshot &other);
+
+    uint64_t getCount() const {
+        return _count;
+    }
+
+    int64_t getSum() const {
+        return _sum;
+    }
+
+    int64_t getMin() const {
+        return _count ? _min : 0;
+    }
+
+    int64_t getMax() const {
+        return _max;
+    }
+
+    double mean() const {
+        return _count ? (double)_sum / _count : 0.0;
+    }
+
+    /// Upper bound of the bucket holding the q-th quantile, q in [0.0, 1.0]
+    int64_t percentile(double q) const;
+
+    const std::vector<uint64_t>& getCounts() const {
+        return _counts;
+    }
+
+    static size_t bucketIndex(int64_t value) {
+        if (value <= 0) {
+            return 0;
+        }
+        if (value >= maxValue) {
+            value = maxValue - 1;
+        }
+        int shift = std::max(63 - __builtin_clzll((unsigned long long)value) - subBucketBits, 0);
+        return (size_t)shift * subBucketCount + (size_t)(value >> shift);
+    }
+
+    static int64_t bucketLowerBound(size_t index) {
+        if (index < 2 * subBucketCount) {
+            return (int64_t)index;
+        }
+        size_t shift = index / subBucketCount - 1;
+        return (int64_t)(index - shift * subBucketCount) << shift;
+    }
+
+    static int64_t bucketUpperBound(size_t index) {
+        return bucketLowerBound(index + 1) - 1;
+    }
+protected:
+    friend class Histogram;
+
+    std::vector<uint64_t> _counts;
+    uint64_t _count{0};
+    int64_t _sum{0};
+    int64_t _min{std::numeric_limits<int64_t>::max()};
+    int64_t _max{0};
+};
+
+
+/// Fixed-memory latency histogram, recording is wait-free and only touches the shard owned by the calling thread
+class NET4CXX_COMMON_API Histogram: public Metric {
+public:
+    static const size_t shardCount = 8;
+
+    class Timer: public boost::noncopyable {
+    public:
+        /// Reads no clock at all while the histogram is disabled
+        explicit Timer(Histogram *histogram)
+                : _histogram(histogram->isEnabled() ? histogram : nullptr) {
+            if (_histogram) {
+                _start = TimestampClock::now();
+            }
+        }
+
+        ~Timer() {
+            if (_histogram) {
+                _histogram->recordDuration(TimestampClock::now() - _start);
+            }
+        }
+    protected:
+        Histogram *_histogram;
+        Timestamp _start;
+    };
+
+    Histogram(std::string name, std::string help);
+
+    void record(int64_t value) {
+        if (value < 0) {
+            value = 0;
+        }
+        Shard &shard = _shards[ShardedValue::shardIndex() % shardCount];
+        shard.counts[HistogramSnapshot::bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value, std::memory_order_relaxed);
+        int64_t current = shard.min.load(std::memory_order_relaxed);
+        while (value < current && !shard.min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+
+        }
+        current = shard.max.load(std::memory_order_relaxed);
+        while (value > current && !shard.max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+
+        }
+    }
+
+    /// Durations are recorded in microseconds
+    void recordDuration(const Duration &duration) {
+        record(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+    }
+
+    HistogramSnapshot snapshot() const;
+
+    int64_t value() const override;
+
+    /// Only gates Histogram::Timer, direct record calls are always counted
+    void setEnabled(bool enabled) {
+        _enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool isEnabled() const {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+protected:
+    struct alignas(cacheLineSize) Shard {
+        std::unique_ptr<std::atomic<uint64_t>[]> counts;
+        std::atomic<uint64_t> count{0};
+        std::atomic<int64_t> sum{0};
+        std::atomic<int64_t> min{std::numeric_limits<int64_t>::max()};
+        std::atomic<int64_t> max{0};
+    };
+
+    std::array<Shard, shardCount> _shards;
+    std::atomic<bool> _enabled{true};
+};
+
+
+class NET4CXX_COMMON_API MetricsRegistry: public boost::noncopyable {
+public:
+    Counter* registerCounter(const std::string &name, const std::string &help="") {
+        return registerMetric<Counter>(name, help);
+    }
+
+    Gauge* registerGauge(const std::string &name, const std::string &help="") {
+        return registerMetric<Gauge>(name, help);
+    }
+
+    Histogram* registerHistogram(const std::string &name, const std::string &help="") {
+        return registerMetric<Histogram>(name, help);
+    }
+
+    Metric* getMetric(const std::string &name) const;
+
+    std::vector<const Metric *> getMetrics() const;
+
+    void dumpAll(Logger *logger=nullptr) const;
+
+    void dumpNonZero(Logger *logger=nullptr) const;
+
+    static MetricsRegistry* instance();
+protected:
+    template <typename MetricT>
+    MetricT* registerMetric(const std::string &name, const std::string &help) {
+        std::lock_guard<std::mutex> lock(_lock);
+        auto iter = _metrics.find(name);
+        if (iter != _metrics.end()) {
+            auto metric = dynamic_cast<MetricT *>(iter->second.get());
+            if (!metric) {
+                NET4CXX_THROW_EXCEPTION(DuplicateKey, "Metric registered with another type: " + name);
+            }
+            return metric;
+        }
+        auto metric = new MetricT(name, help);
+        _metrics.emplace(name, std::unique_ptr<Metric>(metric));
+        return metric;
+    }
+
+    void dump(bool nonZero, Logger *logger) const;
+
+    mutable std::mutex _lock;
+    std::map<std::string, std::unique_ptr<Metric>> _metrics;
+};
+
+NS_END
+
+#define NET4CXX_MetricsRegistry  net4cxx::MetricsRegistry::instance()
+
+#endif //NET4CXX_COMMON_DEBUGGING_METRICS_H
@@ -58,6 +58,11 @@ public:
 
     void dumpNonZero(Logger *logger=nullptr) const;
 
+    ObjectMap getObjects() const {
+        std::lock_guard<std::mutex> lock(_lock);
+        return _objs;
+    }
+
     static Watcher* instance();
 protected:
     void dumpHeader(Logger *logger) const {
@@ -5,6 +5,7 @@
 #include "net4cxx/common/global/initialize.h"
 #include "net4cxx/common/configuration/options.h"
 #include "net4cxx/common/debugging/assert.h"
+#include "net4cxx/common/debugging/metrics.h"
 #include "net4cxx/common/debugging/watcher.h"
 #include "net4cxx/common/global/loggers.h"
 #include "net4cxx/common/logging/logging.h"
@@ -22,7 +23,6 @@ void GlobalInit::initFromEnvironment(const boost::function1<std::string, std::st
     if (!Logging::isInitialized()) {
         Logging::init();
     }
-    setupWatcherHook();
     _inited = true;
 }
 
@@ -34,7 +34,6 @@ void GlobalInit::initFromCommandLine(int argc, const char *const *argv) {
     if (!Logging::isInitialized()) {
         Logging::init();
     }
-    setupWatcherHook();
     _inited = true;
 }
 
@@ -46,116 +45,16 @@ void GlobalInit::initFromConfigFile(const char *path) {
     if (!Logging::isInitialized()) {
         Logging::init();
     }
-    setupWatcherHook();
     _inited = true;
 }
 
 void GlobalInit::cleanup() {
     NET4CXX_ObjectManager->cleanup();
     NET4CXX_Watcher->dumpAll();
-    Logging::close();
-}
-
-void GlobalInit::setupWatcherHook() {
 #ifdef NET4CXX_DEBUG
-    NET4CXX_Watcher->addIncCallback(NET4CXX_TCPServerConnection_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create TCPServerConnection, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_TCPServerConnection_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy TCPServerConnection, current count:%d", value);
-    });
-
-    NET4CXX_Watcher->addIncCallback(NET4CXX_TCPListener_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create TCPListener, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_TCPListener_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy TCPListener, current count:%d", value);
-    });
-
-    NET4CXX_Watcher->addIncCallback(NET4CXX_TCPClientConnection_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create TCPClientConnection, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_TCPClientConnection_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy TCPClientConnection, current count:%d", value);
-    });
-
-    NET4CXX_Watcher->addIncCallback(NET4CXX_TCPConnector_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create TCPConnector, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_TCPConnector_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy TCPConnector, current count:%d", value);
-    });
-
-    NET4CXX_Watcher->addIncCallback(NET4CXX_SSLServerConnection_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create SSLServerConnection, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_SSLServerConnection_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy SSLServerConnection, current count:%d", value);
-    });
-
-    NET4CXX_Watcher->addIncCallback(NET4CXX_SSLListener_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create SSLListener, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_SSLListener_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy SSLListener, current count:%d", value);
-    });
-
-    NET4CXX_Watcher->addIncCallback(NET4CXX_SSLClientConnection_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create SSLClientConnection, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_SSLClientConnection_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy SSLClientConnection, current count:%d", value);
-    });
-
-    NET4CXX_Watcher->addIncCallback(NET4CXX_SSLConnector_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create SSLConnector, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_SSLConnector_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy SSLConnector, current count:%d", value);
-    });
-
-    NET4CXX_Watcher->addIncCallback(NET4CXX_UNIXServerConnection_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create UNIXServerConnection, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_UNIXServerConnection_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy UNIXServerConnection, current count:%d", value);
-    });
-
-    NET4CXX_Watcher->addIncCallback(NET4CXX_UNIXListener_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create UNIXListener, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_UNIXListener_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy UNIXListener, current count:%d", value);
-    });
-
-    NET4CXX_Watcher->addIncCallback(NET4CXX_UNIXClientConnection_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create UNIXClientConnection, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_UNIXClientConnection_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy UNIXClientConnection, current count:%d", value);
-    });
-
-    NET4CXX_Watcher->addIncCallback(NET4CXX_UNIXConnector_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create UNIXConnector, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_UNIXConnector_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy UNIXConnector, current count:%d", value);
-    });
-
-    NET4CXX_Watcher->addIncCallback(NET4CXX_UDPConnection_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create UDPConnection, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_UDPConnection_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy UDPConnection, current count:%d", value);
-    });
-
-    NET4CXX_Watcher->addIncCallback(NET4CXX_UNIXDatagramConnection_COUNT, [](int oldValue, int increment, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Create UNIXDatagramConnection, current count:%d", value);
-    });
-    NET4CXX_Watcher->addDecCallback(NET4CXX_UNIXDatagramConnection_COUNT, [](int oldValue, int decrement, int value) {
-        NET4CXX_LOG_TRACE(gGenLog, "Destroy UNIXDatagramConnection, current count:%d", value);
-    });
+    NET4CXX_MetricsRegistry->dumpAll();
 #endif
+    Logging::close();
 }
 
 NS_END
\ No newline at end of file
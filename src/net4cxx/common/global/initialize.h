@@ -37,7 +37,11 @@ public:
 
     static void cleanup();
 protected:
-    static void setupWatcherHook();
+    /// Object counts are gauges in the metrics registry now, so there is no Watcher hook left to install
+    [[deprecated("object counts moved to NET4CXX_MetricsRegistry")]]
+    static void setupWatcherHook() {
+
+    }
 
     static bool _inited;
 };
@@ -12,6 +12,48 @@ Logger *gAccessLog = nullptr;
 Logger *gAppLog = nullptr;
 Logger *gGenLog = nullptr;
 
+Gauge *gTCPServerConnectionCount = NET4CXX_MetricsRegistry->registerGauge(
+        NET4CXX_TCPServerConnection_COUNT, "Live TCP server connections");
+Gauge *gTCPListenerCount = NET4CXX_MetricsRegistry->registerGauge(NET4CXX_TCPListener_COUNT, "Live TCP listeners");
+Gauge *gTCPClientConnectionCount = NET4CXX_MetricsRegistry->registerGauge(
+        NET4CXX_TCPClientConnection_COUNT, "Live TCP client connections");
+Gauge *gTCPConnectorCount = NET4CXX_MetricsRegistry->registerGauge(NET4CXX_TCPConnector_COUNT, "Live TCP connectors");
+
+Gauge *gSSLServerConnectionCount = NET4CXX_MetricsRegistry->registerGauge(
+        NET4CXX_SSLServerConnection_COUNT, "Live SSL server connections");
+Gauge *gSSLListenerCount = NET4CXX_MetricsRegistry->registerGauge(NET4CXX_SSLListener_COUNT, "Live SSL listeners");
+Gauge *gSSLClientConnectionCount = NET4CXX_MetricsRegistry->registerGauge(
+        NET4CXX_SSLClientConnection_COUNT, "Live SSL client connections");
+Gauge *gSSLConnectorCount = NET4CXX_MetricsRegistry->registerGauge(NET4CXX_SSLConnector_COUNT, "Live SSL connectors");
+
+Gauge *gUNIXServerConnectionCount = NET4CXX_MetricsRegistry->registerGauge(
+        NET4CXX_UNIXServerConnection_COUNT, "Live UNIX server connections");
+Gauge *gUNIXListenerCount = NET4CXX_MetricsRegistry->registerGauge(NET4CXX_UNIXListener_COUNT, "Live UNIX listeners");
+Gauge *gUNIXClientConnectionCount = NET4CXX_MetricsRegistry->registerGauge(
+        NET4CXX_UNIXClientConnection_COUNT, "Live UNIX client connections");
+Gauge *gUNIXConnectorCount = NET4CXX_MetricsRegistry->registerGauge(
+        NET4CXX_UNIXConnector_COUNT, "Live UNIX connectors");
+
+Gauge *gUDPConnectionCount = NET4CXX_MetricsRegistry->registerGauge(
+        NET4CXX_UDPConnection_COUNT, "Live UDP connections");
+Gauge *gUNIXDatagramConnectionCount = NET4CXX_MetricsRegistry->registerGauge(
+        NET4CXX_UNIXDatagramConnection_COUNT, "Live UNIX datagram connections");
+
+Histogram *gReactorHandlerTime = []() {
+    auto histogram = NET4CXX_MetricsRegistry->registerHistogram(
+            "net4cxx.Reactor.handlerTime",
+            "Microseconds spent in posted and delayed callbacks, I/O completion handlers excluded");
+    histogram->setEnabled(false);
+    return histogram;
+}();
+Histogram *gWriteQueueWaitTime = NET4CXX_MetricsRegistry->registerHistogram(
+        "net4cxx.Connection.writeQueueWaitTime",
+        "Microseconds from queueing outgoing data until the write queue drains");
+Histogram *gTCPConnectTime = NET4CXX_MetricsRegistry->registerHistogram(
+        "net4cxx.TCPConnector.connectTime", "Microseconds from the first connection attempt until one succeeds");
+Histogram *gSSLConnectTime = NET4CXX_MetricsRegistry->registerHistogram(
+        "net4cxx.SSLConnector.connectTime", "Microseconds from the first connection attempt until one succeeds");
+
 
 void LogUtil::initGlobalLoggers() {
     gAccessLog = Logging::getLogger("access");
@@ -7,6 +7,7 @@
 
 #include "net4cxx/common/common.h"
 #include "net4cxx/common/configuration/options.h"
+#include "net4cxx/common/debugging/metrics.h"
 #include "net4cxx/common/logging/logging.h"
 
 NS_BEGIN
@@ -15,6 +16,31 @@ extern Logger *gAccessLog;
 extern Logger *gAppLog;
 extern Logger *gGenLog;
 
+extern Gauge *gTCPServerConnectionCount;
+extern Gauge *gTCPListenerCount;
+extern Gauge *gTCPClientConnectionCount;
+extern Gauge *gTCPConnectorCount;
+
+extern Gauge *gSSLServerConnectionCount;
+extern Gauge *gSSLListenerCount;
+extern Gauge *gSSLClientConnectionCount;
+extern Gauge *gSSLConnectorCount;
+
+extern Gauge *gUNIXServerConnectionCount;
+extern Gauge *gUNIXListenerCount;
+extern Gauge *gUNIXClientConnectionCount;
+extern Gauge *gUNIXConnectorCount;
+
+extern Gauge *gUDPConnectionCount;
+extern Gauge *gUNIXDatagramConnectionCount;
+
+/// Times Reactor::addCallback and timer callbacks only, asio I/O completion handlers are not measured. Disabled by
+/// default, enable it with gReactorHandlerTime->setEnabled(true).
+extern Histogram *gReactorHandlerTime;
+extern Histogram *gWriteQueueWaitTime;
+extern Histogram *gTCPConnectTime;
+extern Histogram *gSSLConnectTime;
+
 
 class LogUtil {
 public:
@@ -28,6 +54,8 @@ public:
 NS_END
 
 
+// Deprecated: object counts are no longer kept in the Watcher. The names now identify the matching gauges, read
+// them with NET4CXX_MetricsRegistry->getMetric(NET4CXX_TCPServerConnection_COUNT)->value().
 #define NET4CXX_TCPServerConnection_COUNT   "net4cxx.TCPServerConnection.count"
 #define NET4CXX_TCPListener_COUNT           "net4cxx.TCPListener.count"
 #define NET4CXX_TCPClientConnection_COUNT   "net4cxx.TCPClientConnection.count"
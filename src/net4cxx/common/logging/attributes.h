@@ -40,6 +40,7 @@ BOOST_LOG_ATTRIBUTE_KEYWORD(attr_timestamp, "TimeStamp", DateTime)
 BOOST_LOG_ATTRIBUTE_KEYWORD(attr_file, "File", StringLiteral)
 BOOST_LOG_ATTRIBUTE_KEYWORD(attr_line, "Line", size_t)
 BOOST_LOG_ATTRIBUTE_KEYWORD(attr_func, "Func", StringLiteral)
+BOOST_LOG_ATTRIBUTE_KEYWORD(attr_deferred, "Deferred", bool)
 
 
 class TimeStampFormatterFactory: public logging::basic_formatter_factory<char, DateTime> {
@@ -0,0 +1,282 @@
+//
+// Created by agent on 26-10-18.
+//
+
+#include "net4cxx/common/logging/binarylog.h"
+#include <boost/date_time/c_local_time_adjustor.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/log/utility/manipulators/dump.hpp>
+#include "net4cxx/common/logging/logging.h"
+
+NS_BEGIN
+
+const char BinaryLogFormat::magic[8] = {'N', '4', 'X', 'B', 'L', 'O', 'G', '1'};
+
+const size_t BinaryLogFormat::headerSize;
+
+
+std::shared_ptr<BinaryLogWriter> BinaryLogWriter::_active;
+
+BinaryLogWriter::BinaryLogWriter(std::string fileName, size_t segmentSize)
+        : _fileName(std::move(fileName))
+        , _segmentSize(std::max(segmentSize, (size_t)4096)) {
+    while (boost::filesystem::exists(_fileName + "." + std::to_string(_segmentIndex))) {
+        ++_segmentIndex;
+    }
+    openSegment();
+    if (!_segment.is_open()) {
+        NET4CXX_THROW_EXCEPTION(IOError, "Open binary log segment failed: " + _fileName);
+    }
+}
+
+BinaryLogWriter::~BinaryLogWriter() {
+    std::lock_guard<std::mutex> lock(_lock);
+    closeSegment();
+}
+
+void BinaryLogWriter::write(const std::string &channel, Severity severity, const Byte *data, size_t length,
+                            size_t limit) {
+    std::string &payload = localBuffer();
+    payload.clear();
+    uint32_t dumpLimit = (uint32_t)limit;
+    uint32_t dumpLength = (uint32_t)length;
+    payload.append((const char *)&dumpLimit, sizeof(dumpLimit));
+    payload.append((const char *)&dumpLength, sizeof(dumpLength));
+    if (limit > 0) {
+        length = std::min(length, limit);
+    }
+    payload.append((const char *)data, length);
+    append(BinaryLogFormat::RECORD_DUMP, channel, severity, nullptr, payload.data(), payload.size());
+}
+
+void BinaryLogWriter::append(BinaryLogFormat::RecordType type, const std::string &channel, Severity severity,
+                             const char *format, const char *payload, size_t length) {
+    int64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    std::lock_guard<std::mutex> lock(_lock);
+    if (!_segment.is_open()) {
+        return;
+    }
+    uint16_t channelId;
+    uint32_t formatId;
+    size_t segmentIndex;
+    do {
+        // Interning may rotate to a new segment, which invalidates ids handed out by the previous one
+        segmentIndex = _segmentIndex;
+        channelId = getChannelId(channel);
+        formatId = format ? getFormatId(format) : 0;
+        if (!reserve(BinaryLogFormat::headerSize + length)) {
+            return;
+        }
+    } while (segmentIndex != _segmentIndex);
+    appendRecord(type, severity, channelId, formatId, timestamp, payload, length);
+}
+
+uint16_t BinaryLogWriter::getChannelId(const std::string &channel) {
+    auto iter = _channels.find(channel);
+    if (iter != _channels.end()) {
+        return iter->second;
+    }
+    uint16_t channelId = (uint16_t)_channels.size();
+    if (reserve(BinaryLogFormat::headerSize + channel.size())) {
+        appendRecord(BinaryLogFormat::RECORD_CHANNEL, SEVERITY_TRACE, channelId, 0, 0, channel.data(),
+                     channel.size());
+        _channels.emplace(channel, channelId);
+    }
+    return channelId;
+}
+
+uint32_t BinaryLogWriter::getFormatId(const char *format) {
+    _formatKey.assign(format);
+    auto iter = _formats.find(_formatKey);
+    if (iter != _formats.end()) {
+        return iter->second;
+    }
+    uint32_t formatId = (uint32_t)_formats.size() + 1;
+    if (reserve(BinaryLogFormat::headerSize + _formatKey.size())) {
+        appendRecord(BinaryLogFormat::RECORD_FORMAT, SEVERITY_TRACE, 0, formatId, 0, _formatKey.data(),
+                     _formatKey.size());
+        _formats.emplace(_formatKey, formatId);
+    }
+    return formatId;
+}
+
+void BinaryLogWriter::appendRecord(BinaryLogFormat::RecordType type, Severity severity, uint16_t channel,
+                                   uint32_t format, int64_t timestamp, const char *payload, size_t length) {
+    char *data = _segment.data() + _offset;
+    data[0] = (char)type;
+    data[1] = (char)severity;
+    memcpy(data + 2, &channel, sizeof(channel));
+    memcpy(data + 4, &format, sizeof(format));
+    memcpy(data + 8, &timestamp, sizeof(timestamp));
+    uint32_t payloadLength = (uint32_t)length;
+    memcpy(data + 16, &payloadLength, sizeof(payloadLength));
+    memcpy(data + BinaryLogFormat::headerSize, payload, length);
+    _offset += BinaryLogFormat::headerSize + length;
+}
+
+bool BinaryLogWriter::reserve(size_t length) {
+    if (_offset + length <= _segmentSize) {
+        return true;
+    }
+    if (sizeof(BinaryLogFormat::magic) + length > _segmentSize) {
+        return false;
+    }
+    closeSegment();
+    ++_segmentIndex;
+    openSegment();
+    return _segment.is_open();
+}
+
+void BinaryLogWriter::openSegment() {
+    boost::iostreams::mapped_file_params params(_fileName + "." + std::to_string(_segmentIndex));
+    params.flags = boost::iostreams::mapped_file::readwrite;
+    params.new_file_size = (boost::iostreams::stream_offset)_segmentSize;
+    try {
+        _segment.open(params);
+    } catch (...) {
+        return;
+    }
+    boost::system::error_code ec;
+    boost::filesystem::permissions(params.path, boost::filesystem::owner_read | boost::filesystem::owner_write |
+                                                boost::filesystem::group_read | boost::filesystem::others_read, ec);
+    memcpy(_segment.data(), BinaryLogFormat::magic, sizeof(BinaryLogFormat::magic));
+    _offset = sizeof(BinaryLogFormat::magic);
+    _channels.clear();
+    _formats.clear();
+}
+
+void BinaryLogWriter::closeSegment() {
+    if (!_segment.is_open()) {
+        return;
+    }
+    _segment.close();
+    boost::system::error_code ec;
+    boost::filesystem::resize_file(_fileName + "." + std::to_string(_segmentIndex), _offset, ec);
+}
+
+
+BinaryLogReader::BinaryLogReader(const std::string &fileName)
+        : _segment(fileName) {
+    if (_segment.size() < sizeof(BinaryLogFormat::magic) ||
+        memcmp(_segment.data(), BinaryLogFormat::magic, sizeof(BinaryLogFormat::magic)) != 0) {
+        NET4CXX_THROW_EXCEPTION(ParsingError, "Not a binary log segment: " + fileName);
+    }
+    _offset = sizeof(BinaryLogFormat::magic);
+}
+
+bool BinaryLogReader::next(Record &record) {
+    const char *end = _segment.data() + _segment.size();
+    while (_offset + BinaryLogFormat::headerSize <= _segment.size()) {
+        const char *data = _segment.data() + _offset;
+        auto type = read<uint8_t>(data, end);
+        auto severity = read<uint8_t>(data, end);
+        auto channel = read<uint16_t>(data, end);
+        auto format = read<uint32_t>(data, end);
+        auto timestamp = read<int64_t>(data, end);
+        auto length = read<uint32_t>(data, end);
+        if (type == BinaryLogFormat::RECORD_END || data + length > end) {
+            break;
+        }
+        _offset += BinaryLogFormat::headerSize + length;
+        switch (type) {
+            case BinaryLogFormat::RECORD_CHANNEL: {
+                _channels[channel].assign(data, length);
+                break;
+            }
+            case BinaryLogFormat::RECORD_FORMAT: {
+                _formats[format].assign(data, length);
+                break;
+            }
+            case BinaryLogFormat::RECORD_MESSAGE:
+            case BinaryLogFormat::RECORD_DUMP: {
+                record.severity = (Severity)severity;
+                record.channel = _channels[channel];
+                record.timestamp = boost::posix_time::from_time_t(0) + boost::posix_time::microseconds(timestamp);
+                record.timestamp = boost::date_time::c_local_adjustor<DateTime>::utc_to_local(record.timestamp);
+                if (type == BinaryLogFormat::RECORD_MESSAGE) {
+                    record.message = decodeMessage(_formats[format], data, length);
+                } else {
+                    const char *dumpEnd = data + length;
+                    auto limit = read<uint32_t>(data, dumpEnd);
+                    auto dumpLength = read<uint32_t>(data, dumpEnd);
+                    std::ostringstream strm;
+                    if (limit > 0) {
+                        strm << logging::dump(data, dumpLength, std::min(limit, (uint32_t)(dumpEnd - data)));
+                    } else {
+                        strm << logging::dump(data, (size_t)(dumpEnd - data));
+                    }
+                    record.message = strm.str();
+                }
+                return true;
+            }
+            default: {
+                NET4CXX_THROW_EXCEPTION(ParsingError, "Unknown binary log record type: " + std::to_string(type));
+            }
+        }
+    }
+    return false;
+}
+
+std::string BinaryLogReader::render(const Record &record) {
+    auto date = record.timestamp.date();
+    auto time = record.timestamp.time_of_day();
+    std::ostringstream strm;
+    strm << StrUtil::format("[%04d-%02d-%02d %02d:%02d:%02d.%06d][", (int)date.year(), (int)date.month(),
+                            (int)date.day(), time.hours(), time.minutes(), time.seconds(),
+                            time.fractional_seconds())
+         << record.severity << ']' << record.message;
+    return strm.str();
+}
+
+std::string BinaryLogReader::decodeMessage(const std::string &format, const char *payload, size_t length) const {
+    boost::format formatter(format);
+    const char *end = payload + length;
+    while (payload < end) {
+        auto type = read<uint8_t>(payload, end);
+        switch (type) {
+            case BinaryLogFormat::ARG_INT: {
+                formatter % read<int64_t>(payload, end);
+                break;
+            }
+            case BinaryLogFormat::ARG_UINT: {
+                formatter % read<uint64_t>(payload, end);
+                break;
+            }
+            case BinaryLogFormat::ARG_DOUBLE: {
+                formatter % read<double>(payload, end);
+                break;
+            }
+            case BinaryLogFormat::ARG_STRING: {
+                auto size = read<uint32_t>(payload, end);
+                if (payload + size > end) {
+                    NET4CXX_THROW_EXCEPTION(ParsingError, "Truncated binary log argument");
+                }
+                formatter % std::string(payload, size);
+                payload += size;
+                break;
+            }
+            case BinaryLogFormat::ARG_BOOL: {
+                formatter % (read<uint8_t>(payload, end) != 0);
+                break;
+            }
+            case BinaryLogFormat::ARG_CHAR: {
+                formatter % read<char>(payload, end);
+                break;
+            }
+            default: {
+                NET4CXX_THROW_EXCEPTION(ParsingError, "Unknown binary log argument type: " + std::to_string(type));
+            }
+        }
+    }
+    return formatter.str();
+}
+
+
+void BinarySink::setFilter(const std::string &name, Severity severity) {
+    _name = Logging::getLoggerName(name);
+    setFilter(severity);
+}
+
+NS_END
@@ -0,0 +1,264 @@
+//
+// Created by agent on 26-10-18.
+//
+
+#ifndef NET4CXX_COMMON_LOGGING_BINARYLOG_H
+#define NET4CXX_COMMON_LOGGING_BINARYLOG_H
+
+#include "net4cxx/common/common.h"
+#include <atomic>
+#include <mutex>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/optional.hpp>
+#include "net4cxx/common/logging/attributes.h"
+#include "net4cxx/common/utilities/errors.h"
+
+NS_BEGIN
+
+/// Segment layout: 8-byte magic, then records of
+/// [u8 type][u8 severity][u16 channel][u32 format][i64 utc micros][u32 payload length][payload].
+/// Channel and format records define the ids used by the records that follow them in the same segment.
+class NET4CXX_COMMON_API BinaryLogFormat {
+public:
+    static const char magic[8];
+    static const size_t headerSize = 20;
+
+    enum RecordType: uint8_t {
+        RECORD_END = 0,
+        RECORD_CHANNEL = 1,
+        RECORD_FORMAT = 2,
+        RECORD_MESSAGE = 3,
+        RECORD_DUMP = 4,
+    };
+
+    enum ArgType: uint8_t {
+        ARG_INT = 'i',
+        ARG_UINT = 'u',
+        ARG_DOUBLE = 'd',
+        ARG_STRING = 's',
+        ARG_BOOL = 'b',
+        ARG_CHAR = 'c',
+    };
+};
+
+
+class NET4CXX_COMMON_API BinaryLogWriter: public boost::noncopyable {
+public:
+    BinaryLogWriter(std::string fileName, size_t segmentSize);
+
+    ~BinaryLogWriter();
+
+    template <typename... Args>
+    void write(const std::string &channel, Severity severity, const char *format, Args&&... args) {
+        std::string &payload = localBuffer();
+        payload.clear();
+        encodeArgs(payload, std::forward<Args>(args)...);
+        append(BinaryLogFormat::RECORD_MESSAGE, channel, severity, format, payload.data(), payload.size());
+    }
+
+    void write(const std::string &channel, Severity severity, const Byte *data, size_t length, size_t limit);
+
+    const std::string& getFileName() const {
+        return _fileName;
+    }
+
+    size_t getSegmentIndex() const {
+        return _segmentIndex;
+    }
+
+    /// Writers loaded here stay alive until the caller drops them, even if the sink is closed meanwhile
+    static std::shared_ptr<BinaryLogWriter> active() {
+        return std::atomic_load_explicit(&_active, std::memory_order_acquire);
+    }
+
+    static void setActive(std::shared_ptr<BinaryLogWriter> writer) {
+        std::atomic_store_explicit(&_active, std::move(writer), std::memory_order_release);
+    }
+protected:
+    static std::string& localBuffer() {
+        thread_local std::string buffer;
+        return buffer;
+    }
+
+    static void encodeArgs(std::string &payload) {
+
+    }
+
+    template <typename ValueT, typename... Args>
+    static void encodeArgs(std::string &payload, ValueT &&value, Args&&... args) {
+        encode(payload, value);
+        encodeArgs(payload, std::forward<Args>(args)...);
+    }
+
+    template <typename ValueT>
+    static void encodeRaw(std::string &payload, BinaryLogFormat::ArgType type, ValueT value) {
+        payload.push_back((char)type);
+        payload.append((const char *)&value, sizeof(value));
+    }
+
+    static void encodeString(std::string &payload, const char *data, size_t length) {
+        encodeRaw(payload, BinaryLogFormat::ARG_STRING, (uint32_t)length);
+        payload.append(data, length);
+    }
+
+    static void encode(std::string &payload, bool value) {
+        encodeRaw(payload, BinaryLogFormat::ARG_BOOL, (uint8_t)value);
+    }
+
+    static void encode(std::string &payload, char value) {
+        encodeRaw(payload, BinaryLogFormat::ARG_CHAR, value);
+    }
+
+    static void encode(std::string &payload, signed char value) {
+        encodeRaw(payload, BinaryLogFormat::ARG_CHAR, (char)value);
+    }
+
+    static void encode(std::string &payload, unsigned char value) {
+        encodeRaw(payload, BinaryLogFormat::ARG_CHAR, (char)value);
+    }
+
+    static void encode(std::string &payload, const char *value) {
+        encodeString(payload, value, strlen(value));
+    }
+
+    static void encode(std::string &payload, const std::string &value) {
+        encodeString(payload, value.data(), value.size());
+    }
+
+    template <typename ValueT>
+    static typename std::enable_if<std::is_integral<ValueT>::value && std::is_signed<ValueT>::value>::type
+    encode(std::string &payload, ValueT value) {
+        encodeRaw(payload, BinaryLogFormat::ARG_INT, (int64_t)value);
+    }
+
+    template <typename ValueT>
+    static typename std::enable_if<std::is_integral<ValueT>::value && std::is_unsigned<ValueT>::value>::type
+    encode(std::string &payload, ValueT value) {
+        encodeRaw(payload, BinaryLogFormat::ARG_UINT, (uint64_t)value);
+    }
+
+    template <typename ValueT>
+    static typename std::enable_if<std::is_floating_point<ValueT>::value>::type
+    encode(std::string &payload, ValueT value) {
+        encodeRaw(payload, BinaryLogFormat::ARG_DOUBLE, (double)value);
+    }
+
+    template <typename ValueT>
+    static typename std::enable_if<!std::is_arithmetic<ValueT>::value &&
+                                   !std::is_convertible<const ValueT&, const char *>::value>::type
+    encode(std::string &payload, const ValueT &value) {
+        std::ostringstream strm;
+        strm << value;
+        encode(payload, strm.str());
+    }
+
+    void append(BinaryLogFormat::RecordType type, const std::string &channel, Severity severity, const char *format,
+                const char *payload, size_t length);
+
+    uint16_t getChannelId(const std::string &channel);
+
+    uint32_t getFormatId(const char *format);
+
+    void appendRecord(BinaryLogFormat::RecordType type, Severity severity, uint16_t channel, uint32_t format,
+                      int64_t timestamp, const char *payload, size_t length);
+
+    bool reserve(size_t length);
+
+    void openSegment();
+
+    void closeSegment();
+
+    std::mutex _lock;
+    std::string _fileName;
+    size_t _segmentSize;
+    size_t _segmentIndex{0};
+    size_t _offset{0};
+    boost::iostreams::mapped_file_sink _segment;
+    // Interned by content, formats need not be literals and channel names may outlive their loggers
+    std::unordered_map<std::string, uint16_t> _channels;
+    std::unordered_map<std::string, uint32_t> _formats;
+    std::string _formatKey;
+
+    static std::shared_ptr<BinaryLogWriter> _active;
+};
+
+
+class NET4CXX_COMMON_API BinaryLogReader: public boost::noncopyable {
+public:
+    struct Record {
+        Severity severity;
+        std::string channel;
+        DateTime timestamp;
+        std::string message;
+    };
+
+    explicit BinaryLogReader(const std::string &fileName);
+
+    bool next(Record &record);
+
+    static std::string render(const Record &record);
+protected:
+    std::string decodeMessage(const std::string &format, const char *payload, size_t length) const;
+
+    template <typename ValueT>
+    ValueT read(const char *&data, const char *end) const {
+        if (data + sizeof(ValueT) > end) {
+            NET4CXX_THROW_EXCEPTION(ParsingError, "Truncated binary log record");
+        }
+        ValueT value;
+        memcpy(&value, data, sizeof(value));
+        data += sizeof(value);
+        return value;
+    }
+
+    boost::iostreams::mapped_file_source _segment;
+    size_t _offset{0};
+    std::unordered_map<uint16_t, std::string> _channels;
+    std::unordered_map<uint32_t, std::string> _formats;
+};
+
+
+class NET4CXX_COMMON_API BinarySink {
+public:
+    explicit BinarySink(std::string fileName, size_t segmentSize = 64 * 1024 * 1024)
+            : _fileName(std::move(fileName))
+            , _segmentSize(segmentSize) {
+
+    }
+
+    void setFilter(Severity severity) {
+        _severity = severity;
+    }
+
+    void setFilter(const std::string &name, Severity severity);
+
+    void setSegmentSize(size_t segmentSize) {
+        _segmentSize = segmentSize;
+    }
+
+    const std::string& getFileName() const {
+        return _fileName;
+    }
+
+    size_t getSegmentSize() const {
+        return _segmentSize;
+    }
+
+    Severity getMinSeverity() const {
+        return _severity;
+    }
+
+    const boost::optional<std::string>& getChannelFilter() const {
+        return _name;
+    }
+protected:
+    std::string _fileName;
+    size_t _segmentSize;
+    Severity _severity{SEVERITY_INFO};
+    boost::optional<std::string> _name;
+};
+
+NS_END
+
+#endif //NET4CXX_COMMON_LOGGING_BINARYLOG_H
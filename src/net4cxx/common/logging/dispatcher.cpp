@@ -0,0 +1,140 @@
+//
+// Created by agent on 26-10-18.
+//
+
+#include "net4cxx/common/logging/dispatcher.h"
+#include <boost/date_time/c_local_time_adjustor.hpp>
+#include "net4cxx/common/logging/logger.h"
+
+NS_BEGIN
+
+const size_t LogDispatcher::argsCapacity;
+
+const size_t LogDispatcher::formatCapacity;
+
+const size_t LogDispatcher::ringCapacity;
+
+
+LogDispatcher::~LogDispatcher() {
+    stop();
+}
+
+void LogDispatcher::start() {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_running) {
+        return;
+    }
+    _running = true;
+    _thread = std::thread([this]() {
+        run();
+    });
+}
+
+void LogDispatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        if (!_running) {
+            return;
+        }
+        _running = false;
+    }
+    wakeup();
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+    drain();
+}
+
+void LogDispatcher::sinkAdded(bool deferred, Severity severity) {
+    if (deferred) {
+        int minSeverity = _minSeverity;
+        while ((int)severity < minSeverity && !_minSeverity.compare_exchange_weak(minSeverity, (int)severity)) {
+
+        }
+        ++_deferredSinks;
+        start();
+    } else {
+        ++_syncSinks;
+    }
+}
+
+void LogDispatcher::sinksRemoved() {
+    _deferredSinks = 0;
+    _syncSinks = 0;
+    _minSeverity = (int)SEVERITY_FATAL;
+}
+
+LogDispatcher* LogDispatcher::instance() {
+    static LogDispatcher instance;
+    return &instance;
+}
+
+void LogDispatcher::run() {
+    while (_running) {
+        if (drain()) {
+            continue;
+        }
+        _sleeping = true;
+        if (!drain()) {
+            // Producers check the flag with a relaxed load, a wakeup lost to that race waits for the timeout
+            std::unique_lock<std::mutex> lock(_wakeLock);
+            _wakeup.wait_for(lock, std::chrono::milliseconds(100), [this]() {
+                return _signalled || !_running;
+            });
+            _signalled = false;
+        }
+        _sleeping = false;
+    }
+}
+
+void LogDispatcher::wakeup() {
+    std::lock_guard<std::mutex> lock(_wakeLock);
+    _signalled = true;
+    _wakeup.notify_one();
+}
+
+bool LogDispatcher::drain() {
+    std::vector<RingPtr> rings;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        rings = _rings;
+    }
+    bool drained = false;
+    bool expired = false;
+    for (auto &ring: rings) {
+        Entry *entry;
+        while ((entry = ring->front()) != nullptr) {
+            dispatch(*entry);
+            ring->pop();
+            drained = true;
+        }
+        // Only the dispatcher still holds rings of exited threads
+        if (ring.use_count() == 2) {
+            expired = true;
+        }
+    }
+    if (expired) {
+        rings.clear();
+        std::lock_guard<std::mutex> lock(_lock);
+        _rings.erase(std::remove_if(_rings.begin(), _rings.end(), [](const RingPtr &ring) {
+            return ring.use_count() == 1 && !ring->front();
+        }), _rings.end());
+    }
+    return drained;
+}
+
+void LogDispatcher::dispatch(Entry &entry) {
+    std::string message;
+    try {
+        entry.formatter(entry, message);
+    } catch (std::exception &e) {
+        message = StrUtil::format("Bad log format \"%s\": %s", entry.format, e.what());
+    }
+    auto timestamp = boost::posix_time::from_time_t(std::chrono::system_clock::to_time_t(entry.timestamp));
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(entry.timestamp.time_since_epoch()).count();
+    timestamp += boost::posix_time::microseconds(micros % 1000000);
+    timestamp = boost::date_time::c_local_adjustor<DateTime>::utc_to_local(timestamp);
+    entry.logger->writeDeferred(entry.file, entry.line, entry.func, entry.severity, timestamp, message);
+}
+
+NS_END
@@ -0,0 +1,208 @@
+//
+// Created by agent on 26-10-18.
+//
+
+#ifndef NET4CXX_COMMON_LOGGING_DISPATCHER_H
+#define NET4CXX_COMMON_LOGGING_DISPATCHER_H
+
+#include "net4cxx/common/common.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <boost/scope_exit.hpp>
+#include "net4cxx/common/logging/attributes.h"
+#include "net4cxx/common/utilities/strutil.h"
+
+NS_BEGIN
+
+class Logger;
+
+
+template <typename ArgT>
+struct DeferredArg {
+    using type = typename std::decay<ArgT>::type;
+};
+
+template <>
+struct DeferredArg<char *> {
+    using type = std::string;
+};
+
+template <>
+struct DeferredArg<const char *> {
+    using type = std::string;
+};
+
+
+/// Captures log calls into per-thread lock-free rings, formatting and sink I/O happen on a background thread
+class NET4CXX_COMMON_API LogDispatcher: public boost::noncopyable {
+public:
+    static const size_t argsCapacity = 192;
+    static const size_t formatCapacity = 128;
+    static const size_t ringCapacity = 1024;
+
+    struct Entry {
+        Logger *logger;
+        Severity severity;
+        StringLiteral file;
+        size_t line;
+        StringLiteral func;
+        char format[formatCapacity];
+        std::chrono::system_clock::time_point timestamp;
+        void (*formatter)(Entry &entry, std::string &message);
+        alignas(std::max_align_t) unsigned char args[argsCapacity];
+    };
+
+    class Ring {
+    public:
+        Ring()
+                : _entries(new Entry[ringCapacity]) {
+
+        }
+
+        Entry* acquire() {
+            size_t tail = _tail.load(std::memory_order_relaxed);
+            if (tail - _head.load(std::memory_order_acquire) == ringCapacity) {
+                return nullptr;
+            }
+            return &_entries[tail % ringCapacity];
+        }
+
+        void commit() {
+            _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        Entry* front() {
+            size_t head = _head.load(std::memory_order_relaxed);
+            if (head == _tail.load(std::memory_order_acquire)) {
+                return nullptr;
+            }
+            return &_entries[head % ringCapacity];
+        }
+
+        void pop() {
+            _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+    protected:
+        std::unique_ptr<Entry[]> _entries;
+        alignas(64) std::atomic<size_t> _head{0};
+        alignas(64) std::atomic<size_t> _tail{0};
+    };
+
+    using RingPtr = std::shared_ptr<Ring>;
+
+    ~LogDispatcher();
+
+    void start();
+
+    void stop();
+
+    void sinkAdded(bool deferred, Severity severity);
+
+    void sinksRemoved();
+
+    bool isDeferred(Severity severity) const {
+        return _deferredSinks.load(std::memory_order_relaxed) != 0 &&
+               (int)severity >= _minSeverity.load(std::memory_order_relaxed);
+    }
+
+    bool hasSyncSinks() const {
+        return _syncSinks.load(std::memory_order_relaxed) != 0;
+    }
+
+    size_t getFallbackCount() const {
+        return _fallbacks;
+    }
+
+    template <typename... Args>
+    bool post(Logger *logger, const StringLiteral &file, size_t line, const StringLiteral &func, Severity severity,
+              const char *format, Args&... args) {
+        using ArgsType = std::tuple<typename DeferredArg<typename std::decay<Args>::type>::type...>;
+        static_assert(alignof(ArgsType) <= alignof(std::max_align_t), "over-aligned log argument");
+        // The format is copied as well, callers may pass one that doesn't outlive the call
+        size_t formatLength = strlen(format);
+        if (sizeof(ArgsType) > argsCapacity || formatLength >= formatCapacity) {
+            ++_fallbacks;
+            return false;
+        }
+        Ring *ring = localRing();
+        Entry *entry = ring->acquire();
+        if (!entry) {
+            ++_fallbacks;
+            return false;
+        }
+        entry->logger = logger;
+        entry->severity = severity;
+        entry->file = file;
+        entry->line = line;
+        entry->func = func;
+        memcpy(entry->format, format, formatLength + 1);
+        entry->timestamp = std::chrono::system_clock::now();
+        entry->formatter = &LogDispatcher::formatEntry<ArgsType>;
+        new (entry->args) ArgsType(args...);
+        ring->commit();
+        if (_sleeping.load(std::memory_order_relaxed)) {
+            wakeup();
+        }
+        return true;
+    }
+
+    static LogDispatcher* instance();
+protected:
+    LogDispatcher() = default;
+
+    Ring* localRing() {
+        thread_local RingPtr ring;
+        if (!ring) {
+            ring = std::make_shared<Ring>();
+            std::lock_guard<std::mutex> lock(_lock);
+            _rings.push_back(ring);
+        }
+        return ring.get();
+    }
+
+    void run();
+
+    void wakeup();
+
+    bool drain();
+
+    void dispatch(Entry &entry);
+
+    template <typename ArgsType>
+    static void formatEntry(Entry &entry, std::string &message) {
+        auto &args = *reinterpret_cast<ArgsType *>(entry.args);
+        // The arguments live in the ring slot, destroy them even when the format string throws
+        BOOST_SCOPE_EXIT_TPL(&args) {
+            args.~ArgsType();
+        } BOOST_SCOPE_EXIT_END
+        message = formatArgs(entry.format, args, std::make_index_sequence<std::tuple_size<ArgsType>::value>());
+    }
+
+    template <typename ArgsType, size_t... Indexes>
+    static std::string formatArgs(const char *format, ArgsType &args, std::index_sequence<Indexes...>) {
+        return StrUtil::format(format, std::get<Indexes>(args)...);
+    }
+
+    std::mutex _lock;
+    std::vector<RingPtr> _rings;
+    std::thread _thread;
+    std::mutex _wakeLock;
+    std::condition_variable _wakeup;
+    bool _signalled{false};
+    std::atomic<bool> _running{false};
+    std::atomic<bool> _sleeping{false};
+    std::atomic<int> _deferredSinks{0};
+    std::atomic<int> _syncSinks{0};
+    std::atomic<int> _minSeverity{(int)SEVERITY_FATAL};
+    std::atomic<size_t> _fallbacks{0};
+};
+
+NS_END
+
+#define NET4CXX_LogDispatcher   net4cxx::LogDispatcher::instance()
+
+#endif //NET4CXX_COMMON_LOGGING_DISPATCHER_H
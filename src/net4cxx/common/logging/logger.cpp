@@ -14,7 +14,38 @@ Logger* Logger::getChild(const std::string &suffix) const {
 
 
 void Logger::write(Severity severity, const Byte *data, size_t length, size_t limit) {
-    logging::record rec = _logger.open_record(keywords::severity=severity);
+    write(StringLiteral(), 0, StringLiteral(), severity, data, length, limit);
+}
+
+void Logger::write(const StringLiteral &file, size_t line, const StringLiteral &func, Severity severity,
+                   const Byte *data, size_t length, size_t limit) {
+    if (!isEnabledFor(severity)) {
+        return;
+    }
+    if ((int)severity >= _binaryLevel.load(std::memory_order_relaxed)) {
+        auto writer = BinaryLogWriter::active();
+        if (writer) {
+            writer->write(_name, severity, data, length, limit);
+        }
+        if ((int)severity < _textLevel.load(std::memory_order_relaxed)) {
+            return;
+        }
+    }
+    auto dispatcher = NET4CXX_LogDispatcher;
+    if (dispatcher->isDeferred(severity)) {
+        writeRecord(file, line, func, severity, true, data, length, limit);
+        if (!dispatcher->hasSyncSinks()) {
+            return;
+        }
+    }
+    writeRecord(file, line, func, severity, false, data, length, limit);
+}
+
+void Logger::writeRecord(const StringLiteral &file, size_t line, const StringLiteral &func, Severity severity,
+                         bool deferred, const Byte *data, size_t length, size_t limit) {
+    logging::record rec = _logger.open_record((keywords::severity=severity, logger_keywords::file=file,
+                                               logger_keywords::line=line, logger_keywords::func=func,
+                                               logger_keywords::deferred=deferred));
     if (rec) {
         logging::record_ostream strm(rec);
         if (limit > 0) {
@@ -26,19 +57,17 @@ void Logger::write(Severity severity, const Byte *data, size_t length, size_t li
     }
 }
 
-void Logger::write(const StringLiteral &file, size_t line, const StringLiteral &func, Severity severity,
-                   const Byte *data, size_t length, size_t limit) {
+void Logger::writeDeferred(const StringLiteral &file, size_t line, const StringLiteral &func, Severity severity,
+                           const DateTime &timestamp, const std::string &message) {
     logging::record rec = _logger.open_record((keywords::severity=severity, logger_keywords::file=file,
-                                               logger_keywords::line=line, logger_keywords::func=func));
+                                               logger_keywords::line=line, logger_keywords::func=func,
+                                               logger_keywords::timestamp=timestamp,
+                                               logger_keywords::deferred=true));
     if (rec) {
         logging::record_ostream strm(rec);
-        if (limit > 0) {
-            strm << logging::dump(data, length, limit);
-        } else {
-            strm << logging::dump(data, length);
-        }
+        strm << message;
         _logger.push_record(std::move(rec));
     }
 }
 
-NS_END
\ No newline at end of file
+NS_END
@@ -15,6 +15,8 @@
 #include <boost/noncopyable.hpp>
 #include <boost/scope_exit.hpp>
 #include "net4cxx/common/logging/attributes.h"
+#include "net4cxx/common/logging/binarylog.h"
+#include "net4cxx/common/logging/dispatcher.h"
 #include "net4cxx/common/utilities/strutil.h"
 
 
@@ -28,6 +30,8 @@ namespace logger_keywords {
 BOOST_PARAMETER_KEYWORD(file_ns, file)
 BOOST_PARAMETER_KEYWORD(line_ns, line)
 BOOST_PARAMETER_KEYWORD(func_ns, func)
+BOOST_PARAMETER_KEYWORD(timestamp_ns, timestamp)
+BOOST_PARAMETER_KEYWORD(deferred_ns, deferred)
 }
 
 template <typename BaseT>
@@ -62,11 +66,15 @@ protected:
         StringLiteral fileValue = args[logger_keywords::file | StringLiteral()];
         size_t lineValue = args[logger_keywords::line | 0];
         StringLiteral funcValue = args[logger_keywords::func | StringLiteral()];
+        DateTime timestampValue = args[logger_keywords::timestamp | DateTime()];
+        bool deferredValue = args[logger_keywords::deferred | false];
 
         logging::attribute_set &attrs = BaseT::attributes();
         logging::attribute_set::iterator fileIter = attrs.end();
         logging::attribute_set::iterator lineIter = attrs.end();
         logging::attribute_set::iterator funcIter = attrs.end();
+        logging::attribute_set::iterator timestampIter = attrs.end();
+        logging::attribute_set::iterator deferredIter = attrs.end();
 
         if (!fileValue.empty()) {
             auto res = BaseT::add_attribute_unlocked("File", attrs::constant<StringLiteral>(fileValue));
@@ -86,8 +94,20 @@ protected:
                 funcIter = res.first;
             }
         }
+        if (!timestampValue.is_not_a_date_time()) {
+            auto res = BaseT::add_attribute_unlocked("TimeStamp", attrs::constant<DateTime>(timestampValue));
+            if (res.second) {
+                timestampIter = res.first;
+            }
+        }
+        if (deferredValue) {
+            auto res = BaseT::add_attribute_unlocked("Deferred", attrs::constant<bool>(true));
+            if (res.second) {
+                deferredIter = res.first;
+            }
+        }
 
-        BOOST_SCOPE_EXIT_TPL(&fileIter, &lineIter, &funcIter, &attrs) {
+        BOOST_SCOPE_EXIT_TPL(&fileIter, &lineIter, &funcIter, &timestampIter, &deferredIter, &attrs) {
                 if (fileIter != attrs.end()) {
                     attrs.erase(fileIter);
                 }
@@ -97,6 +117,12 @@ protected:
                 if (funcIter != attrs.end()) {
                     attrs.erase(funcIter);
                 }
+                if (timestampIter != attrs.end()) {
+                    attrs.erase(timestampIter);
+                }
+                if (deferredIter != attrs.end()) {
+                    attrs.erase(deferredIter);
+                }
         } BOOST_SCOPE_EXIT_END
 
         return BaseT::open_record_unlocked(args);
@@ -121,11 +147,22 @@ class PositionLoggerMT: public src::basic_composite_logger<
 class NET4CXX_COMMON_API Logger: public boost::noncopyable {
 public:
     friend class boost::factory<Logger*>;
+    friend class LogDispatcher;
+    friend class Logging;
+    friend class LoggingHelper;
 
     const std::string& getName() const {
         return _name;
     }
 
+    bool isEnabledFor(Severity severity) const {
+        return (int)severity >= _level.load(std::memory_order_relaxed);
+    }
+
+    int getLevel() const {
+        return _level.load(std::memory_order_relaxed);
+    }
+
     Logger* getChild(const std::string &suffix) const;
 
     template <typename... Args>
@@ -251,19 +288,42 @@ protected:
 
     template <typename... Args>
     void write(Severity severity, const char *format, Args&&... args) {
-        logging::record rec = _logger.open_record(keywords::severity=severity);
-        if (rec) {
-            logging::record_ostream strm(rec);
-            strm << StrUtil::format(format, std::forward<Args>(args)...);
-            _logger.push_record(std::move(rec));
-        }
+        write(StringLiteral(), 0, StringLiteral(), severity, format, std::forward<Args>(args)...);
     }
 
     template <typename... Args>
     void write(const StringLiteral &file, size_t line, const StringLiteral &func, Severity severity, const char *format,
                Args&&... args) {
+        if (!isEnabledFor(severity)) {
+            return;
+        }
+        if ((int)severity >= _binaryLevel.load(std::memory_order_relaxed)) {
+            auto writer = BinaryLogWriter::active();
+            if (writer) {
+                writer->write(_name, severity, format, args...);
+            }
+            if ((int)severity < _textLevel.load(std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        auto dispatcher = NET4CXX_LogDispatcher;
+        if (dispatcher->isDeferred(severity)) {
+            if (!dispatcher->post(this, file, line, func, severity, format, args...)) {
+                writeRecord(file, line, func, severity, true, format, args...);
+            }
+            if (!dispatcher->hasSyncSinks()) {
+                return;
+            }
+        }
+        writeRecord(file, line, func, severity, false, format, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    void writeRecord(const StringLiteral &file, size_t line, const StringLiteral &func, Severity severity,
+                     bool deferred, const char *format, Args&&... args) {
         logging::record rec = _logger.open_record((keywords::severity=severity, logger_keywords::file=file,
-                                                   logger_keywords::line=line, logger_keywords::func=func));
+                                                   logger_keywords::line=line, logger_keywords::func=func,
+                                                   logger_keywords::deferred=deferred));
         if (rec) {
             logging::record_ostream strm(rec);
             strm << StrUtil::format(format, std::forward<Args>(args)...);
@@ -271,12 +331,27 @@ protected:
         }
     }
 
+    void writeDeferred(const StringLiteral &file, size_t line, const StringLiteral &func, Severity severity,
+                       const DateTime &timestamp, const std::string &message);
+
     void write(Severity severity, const Byte *data, size_t length, size_t limit=0);
 
     void write(const StringLiteral &file, size_t line, const StringLiteral &func, Severity severity,
                const Byte *data, size_t length, size_t limit=0);
 
+    void writeRecord(const StringLiteral &file, size_t line, const StringLiteral &func, Severity severity,
+                     bool deferred, const Byte *data, size_t length, size_t limit);
+
+    void setLevel(int textLevel, int binaryLevel) {
+        _textLevel.store(textLevel, std::memory_order_relaxed);
+        _binaryLevel.store(binaryLevel, std::memory_order_relaxed);
+        _level.store(std::min(textLevel, binaryLevel), std::memory_order_relaxed);
+    }
+
     std::string _name;
+    std::atomic<int> _level{(int)SEVERITY_TRACE};
+    std::atomic<int> _textLevel{(int)SEVERITY_TRACE};
+    std::atomic<int> _binaryLevel{(int)SEVERITY_FATAL + 1};
     PositionLoggerMT<Severity> _logger;
 };
 
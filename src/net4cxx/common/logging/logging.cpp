@@ -16,6 +16,18 @@ Logging::LoggerMap Logging::_loggers;
 
 Logger* Logging::_rootLogger = nullptr;
 
+std::vector<Logging::SinkLevel> Logging::_sinkLevels;
+
+bool Logging::_settingsSinks = false;
+
+boost::optional<Logging::SinkLevel> Logging::_binarySinkLevel;
+
+std::shared_ptr<BinaryLogWriter> Logging::_binaryWriter;
+
+bool Logging::_enabled = true;
+
+int Logging::_coreLevel = (int)SEVERITY_TRACE;
+
 const std::map<std::string, Severity> Logging::_severityMapping = {
         {"trace",   SEVERITY_TRACE},
         {"debug",   SEVERITY_DEBUG},
@@ -35,6 +47,9 @@ void Logging::init() {
 void Logging::initFromSettings(const Settings &settings) {
     onPreInit();
     logging::init_from_settings(settings);
+    updateLevels([]() {
+        _settingsSinks = true;
+    });
     onPostInit();
 }
 
@@ -42,9 +57,28 @@ void Logging::initFromFile(const std::string &fileName) {
     onPreInit();
     std::ifstream file(fileName);
     logging::init_from_stream(file);
+    updateLevels([]() {
+        _settingsSinks = true;
+    });
     onPostInit();
 }
 
+void Logging::close() {
+    LogSiteLimiter::flushSuppressed();
+    NET4CXX_LogDispatcher->stop();
+    NET4CXX_LogDispatcher->sinksRemoved();
+    logging::core::get()->flush();
+    logging::core::get()->remove_all_sinks();
+    std::lock_guard<std::mutex> lock(_lock);
+    _sinkLevels.clear();
+    _settingsSinks = false;
+    _binarySinkLevel = boost::none;
+    BinaryLogWriter::setActive(nullptr);
+    _binaryWriter.reset();
+    _loggers.clear();
+    _rootLogger = nullptr;
+}
+
 Severity Logging::toSeverity(std::string severity) {
     boost::to_lower(severity);
     auto iter  = _severityMapping.find(severity);
@@ -83,8 +117,49 @@ Logger* Logging::getLoggerByName(std::string loggerName) {
         return iter->second;
     }
     Logger *logger = boost::factory<Logger*>()(loggerName);
+    logger->setLevel(getTextLevel(loggerName), getBinaryLevel(loggerName));
     _loggers.insert(loggerName, logger);
     return logger;
 }
 
+int Logging::getTextLevel(const std::string &loggerName) {
+    const int disabled = (int)SEVERITY_FATAL + 1;
+    if (!_enabled) {
+        return disabled;
+    }
+    int level = (int)SEVERITY_TRACE;
+    if (!_settingsSinks && (!_sinkLevels.empty() || _binarySinkLevel)) {
+        level = disabled;
+        for (auto &sinkLevel: _sinkLevels) {
+            if (!sinkLevel.channel || ChannelFilterFactory::isChildOf(loggerName, *sinkLevel.channel)) {
+                level = std::min(level, sinkLevel.severity);
+            }
+        }
+    }
+    return std::max(level, _coreLevel);
+}
+
+int Logging::getBinaryLevel(const std::string &loggerName) {
+    const int disabled = (int)SEVERITY_FATAL + 1;
+    if (!_enabled || !_binarySinkLevel) {
+        return disabled;
+    }
+    if (_binarySinkLevel->channel && !ChannelFilterFactory::isChildOf(loggerName, *_binarySinkLevel->channel)) {
+        return disabled;
+    }
+    return std::max(_binarySinkLevel->severity, _coreLevel);
+}
+
+void Logging::addSink(const BinarySink &sink) {
+    if (_binaryWriter) {
+        NET4CXX_THROW_EXCEPTION(AlreadyExist, "Binary sink already added");
+    }
+    auto writer = std::make_shared<BinaryLogWriter>(sink.getFileName(), sink.getSegmentSize());
+    updateLevels([&sink, &writer]() {
+        BinaryLogWriter::setActive(writer);
+        _binaryWriter = std::move(writer);
+        _binarySinkLevel = SinkLevel{sink.getChannelFilter(), (int)sink.getMinSeverity()};
+    });
+}
+
 NS_END
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include <boost/ptr_container/ptr_map.hpp>
 #include "net4cxx/common/debugging/assert.h"
 #include "net4cxx/common/logging/logger.h"
+#include "net4cxx/common/logging/ratelimiter.h"
 #include "net4cxx/common/logging/sinks.h"
 
 NS_BEGIN
@@ -27,31 +28,41 @@ public:
 
     static void initFromFile(const std::string &fileName);
 
-    static void close() {
-        logging::core::get()->flush();
-        logging::core::get()->remove_all_sinks();
-        _loggers.clear();
-        _rootLogger = nullptr;
-    }
+    static void close();
 
     static void disable() {
         logging::core::get()->set_logging_enabled(false);
+        updateLevels([]() {
+            _enabled = false;
+        });
     }
 
     static void enable() {
         logging::core::get()->set_logging_enabled(true);
+        updateLevels([]() {
+            _enabled = true;
+        });
     }
 
     static void setFilter(Severity severity) {
         logging::core::get()->set_filter(attr_severity >= severity);
+        updateLevels([severity]() {
+            _coreLevel = (int)severity;
+        });
     }
 
     static void setFilter(const std::string &filter) {
         logging::core::get()->set_filter(logging::parse_filter(filter));
+        updateLevels([]() {
+            _coreLevel = (int)SEVERITY_TRACE;
+        });
     }
 
     static void resetFilter() {
         logging::core::get()->reset_filter();
+        updateLevels([]() {
+            _coreLevel = (int)SEVERITY_TRACE;
+        });
     }
 
     static Logger* getRootLogger() {
@@ -78,8 +89,14 @@ public:
 
     static void addSink(const BaseSink &sink) {
         logging::core::get()->add_sink(sink.makeSink());
+        NET4CXX_LogDispatcher->sinkAdded(sink.isDeferred(), sink.getMinSeverity());
+        updateLevels([&sink]() {
+            _sinkLevels.push_back({sink.getChannelFilter(), (int)sink.getMinSeverity()});
+        });
     }
 
+    static void addSink(const BinarySink &sink);
+
     static Severity toSeverity(std::string severity);
 
     template <typename... Args>
@@ -242,15 +259,80 @@ protected:
         return name + '.' + suffix;
     }
 
+    template <typename UpdaterT>
+    static void updateLevels(UpdaterT &&updater) {
+        std::lock_guard<std::mutex> lock(_lock);
+        updater();
+        for (auto iter = _loggers.begin(); iter != _loggers.end(); ++iter) {
+            iter->second->setLevel(getTextLevel(iter->first), getBinaryLevel(iter->first));
+        }
+    }
+
+    static int getTextLevel(const std::string &loggerName);
+
+    static int getBinaryLevel(const std::string &loggerName);
+
+    struct SinkLevel {
+        boost::optional<std::string> channel;
+        int severity;
+    };
+
     static std::mutex _lock;
     static LoggerMap _loggers;
     static Logger *_rootLogger;
+    static std::vector<SinkLevel> _sinkLevels;
+    static bool _settingsSinks;
+    static boost::optional<SinkLevel> _binarySinkLevel;
+    static std::shared_ptr<BinaryLogWriter> _binaryWriter;
+    static bool _enabled;
+    static int _coreLevel;
     static const std::map<std::string, Severity> _severityMapping;
 };
 
 
 class NET4CXX_COMMON_API LoggingHelper {
 public:
+    static bool isEnabledFor(Severity severity, Logger *logger) {
+        return logger->isEnabledFor(severity);
+    }
+
+    static bool isEnabledFor(Severity severity, const char *) {
+        Logger *logger = Logging::getRootLogger();
+        return logger && logger->isEnabledFor(severity);
+    }
+
+    static bool isEnabledFor(Severity severity, const Byte *) {
+        Logger *logger = Logging::getRootLogger();
+        return logger && logger->isEnabledFor(severity);
+    }
+
+    static Logger* getLogger(Logger *logger) {
+        return logger;
+    }
+
+    static Logger* getLogger(const char *) {
+        return Logging::getRootLogger();
+    }
+
+    static Logger* getLogger(const Byte *) {
+        return Logging::getRootLogger();
+    }
+
+    static void suppressed(const StringLiteral &file, size_t line, const StringLiteral &func, Severity severity,
+                           size_t count, Logger *logger) {
+        logger->write(file, line, func, severity, "Suppressed %u similar messages", count);
+    }
+
+    static void suppressed(const StringLiteral &file, size_t line, const StringLiteral &func, Severity severity,
+                           size_t count, const char *) {
+        suppressed(file, line, func, severity, count, Logging::getRootLogger());
+    }
+
+    static void suppressed(const StringLiteral &file, size_t line, const StringLiteral &func, Severity severity,
+                           size_t count, const Byte *) {
+        suppressed(file, line, func, severity, count, Logging::getRootLogger());
+    }
+
     template <typename... Args>
     static void trace(const StringLiteral &file, size_t line, const StringLiteral &func, const char *format,
                       Args&&... args) {
@@ -392,16 +474,86 @@ public:
 
 NS_END
 
-#define NET4CXX_LOG_TRACE(...)      net4cxx::LoggingHelper::trace(__FILE__, __LINE__, __FUNCTION__, ##__VA_ARGS__)
-#ifdef NET4CXX_DEBUG
-#define NET4CXX_LOG_DEBUG(...)      net4cxx::LoggingHelper::debug(__FILE__, __LINE__, __FUNCTION__, ##__VA_ARGS__)
+#define NET4CXX_LOG_LEVEL_TRACE     0
+#define NET4CXX_LOG_LEVEL_DEBUG     1
+#define NET4CXX_LOG_LEVEL_INFO      2
+
+#ifndef NET4CXX_LOG_MIN_LEVEL
+#define NET4CXX_LOG_MIN_LEVEL       NET4CXX_LOG_LEVEL_TRACE
+#endif
+
+#define NET4CXX_LOG_FIRST_ARG(first, ...)   first
+#define NET4CXX_LOG_FIRST(...)              NET4CXX_LOG_FIRST_ARG(__VA_ARGS__, 0)
+
+#define NET4CXX_LOG_CALL(method, target, first, ...) \
+    net4cxx::LoggingHelper::method(__FILE__, __LINE__, __FUNCTION__, target, ##__VA_ARGS__)
+
+#define NET4CXX_LOG_IF_ENABLED(severity, method, ...) \
+    do { \
+        auto &&logTarget = NET4CXX_LOG_FIRST(__VA_ARGS__); \
+        if (net4cxx::LoggingHelper::isEnabledFor(severity, logTarget)) { \
+            NET4CXX_LOG_CALL(method, logTarget, __VA_ARGS__); \
+        } \
+    } while (false)
+
+#define NET4CXX_LOG_DISCARD(...)    do { } while (false)
+
+#define NET4CXX_LOG_SITE(severity)  net4cxx::LogSite{__FILE__, __LINE__, __FUNCTION__, severity}
+
+#define NET4CXX_LOG_IF_ACQUIRED(severity, method, limiter, ...) \
+    do { \
+        auto &&logTarget = NET4CXX_LOG_FIRST(__VA_ARGS__); \
+        if (net4cxx::LoggingHelper::isEnabledFor(severity, logTarget)) { \
+            static limiter; \
+            size_t suppressedCount = 0; \
+            if (logLimiter.tryAcquire(net4cxx::LoggingHelper::getLogger(logTarget), suppressedCount)) { \
+                if (suppressedCount != 0) { \
+                    net4cxx::LoggingHelper::suppressed(__FILE__, __LINE__, __FUNCTION__, severity, suppressedCount, \
+                                                       logTarget); \
+                } \
+                NET4CXX_LOG_CALL(method, logTarget, __VA_ARGS__); \
+            } \
+        } \
+    } while (false)
+
+#define NET4CXX_LOG_LIMITED(severity, method, ...) \
+    NET4CXX_LOG_IF_ACQUIRED(severity, method, net4cxx::LogRateLimiter logLimiter(NET4CXX_LOG_SITE(severity)), \
+                            ##__VA_ARGS__)
+
+#define NET4CXX_LOG_SAMPLED(severity, method, n, ...) \
+    NET4CXX_LOG_IF_ACQUIRED(severity, method, net4cxx::LogSampler logLimiter(NET4CXX_LOG_SITE(severity), n), \
+                            ##__VA_ARGS__)
+
+#if NET4CXX_LOG_MIN_LEVEL <= NET4CXX_LOG_LEVEL_TRACE
+#define NET4CXX_LOG_TRACE(...)      NET4CXX_LOG_IF_ENABLED(SEVERITY_TRACE, trace, ##__VA_ARGS__)
+#else
+#define NET4CXX_LOG_TRACE(...)      NET4CXX_LOG_DISCARD(__VA_ARGS__)
+#endif
+#if defined(NET4CXX_DEBUG) && NET4CXX_LOG_MIN_LEVEL <= NET4CXX_LOG_LEVEL_DEBUG
+#define NET4CXX_LOG_DEBUG(...)      NET4CXX_LOG_IF_ENABLED(SEVERITY_DEBUG, debug, ##__VA_ARGS__)
+#else
+#define NET4CXX_LOG_DEBUG(...)      NET4CXX_LOG_DISCARD(__VA_ARGS__)
+#endif
+#if NET4CXX_LOG_MIN_LEVEL <= NET4CXX_LOG_LEVEL_INFO
+#define NET4CXX_LOG_INFO(...)       NET4CXX_LOG_IF_ENABLED(SEVERITY_INFO, info, ##__VA_ARGS__)
+#else
+#define NET4CXX_LOG_INFO(...)       NET4CXX_LOG_DISCARD(__VA_ARGS__)
+#endif
+#define NET4CXX_LOG_WARN(...)       NET4CXX_LOG_IF_ENABLED(SEVERITY_WARN, warn, ##__VA_ARGS__)
+#define NET4CXX_LOG_ERROR(...)      NET4CXX_LOG_IF_ENABLED(SEVERITY_ERROR, error, ##__VA_ARGS__)
+#define NET4CXX_LOG_FATAL(...)      NET4CXX_LOG_IF_ENABLED(SEVERITY_FATAL, fatal, ##__VA_ARGS__)
+
+#if NET4CXX_LOG_MIN_LEVEL <= NET4CXX_LOG_LEVEL_INFO
+#define NET4CXX_LOG_INFO_LIMITED(...)       NET4CXX_LOG_LIMITED(SEVERITY_INFO, info, ##__VA_ARGS__)
+#define NET4CXX_LOG_INFO_SAMPLED(n, ...)    NET4CXX_LOG_SAMPLED(SEVERITY_INFO, info, n, ##__VA_ARGS__)
 #else
-#define NET4CXX_LOG_DEBUG(...)
+#define NET4CXX_LOG_INFO_LIMITED(...)       NET4CXX_LOG_DISCARD(__VA_ARGS__)
+#define NET4CXX_LOG_INFO_SAMPLED(n, ...)    NET4CXX_LOG_DISCARD(__VA_ARGS__)
 #endif
-#define NET4CXX_LOG_INFO(...)       net4cxx::LoggingHelper::info(__FILE__, __LINE__, __FUNCTION__, ##__VA_ARGS__)
-#define NET4CXX_LOG_WARN(...)       net4cxx::LoggingHelper::warn(__FILE__, __LINE__, __FUNCTION__, ##__VA_ARGS__)
-#define NET4CXX_LOG_ERROR(...)      net4cxx::LoggingHelper::error(__FILE__, __LINE__, __FUNCTION__, ##__VA_ARGS__)
-#define NET4CXX_LOG_FATAL(...)      net4cxx::LoggingHelper::fatal(__FILE__, __LINE__, __FUNCTION__, ##__VA_ARGS__)
+#define NET4CXX_LOG_WARN_LIMITED(...)       NET4CXX_LOG_LIMITED(SEVERITY_WARN, warn, ##__VA_ARGS__)
+#define NET4CXX_LOG_WARN_SAMPLED(n, ...)    NET4CXX_LOG_SAMPLED(SEVERITY_WARN, warn, n, ##__VA_ARGS__)
+#define NET4CXX_LOG_ERROR_LIMITED(...)      NET4CXX_LOG_LIMITED(SEVERITY_ERROR, error, ##__VA_ARGS__)
+#define NET4CXX_LOG_ERROR_SAMPLED(n, ...)   NET4CXX_LOG_SAMPLED(SEVERITY_ERROR, error, n, ##__VA_ARGS__)
 
 
 #endif //NET4CXX_COMMON_LOGGING_LOGGING_H
@@ -0,0 +1,92 @@
+//
+// Created by agent on 26-10-18.
+//
+
+#include "net4cxx/common/logging/ratelimiter.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include "net4cxx/common/logging/logging.h"
+
+NS_BEGIN
+
+static std::mutex& siteLimitersLock() {
+    static std::mutex lock;
+    return lock;
+}
+
+static std::vector<LogSiteLimiter *>& siteLimiters() {
+    static std::vector<LogSiteLimiter *> limiters;
+    return limiters;
+}
+
+
+LogSiteLimiter::LogSiteLimiter(const LogSite &site)
+        : _site(site) {
+    std::lock_guard<std::mutex> lock(siteLimitersLock());
+    siteLimiters().push_back(this);
+}
+
+LogSiteLimiter::~LogSiteLimiter() {
+    std::lock_guard<std::mutex> lock(siteLimitersLock());
+    auto &limiters = siteLimiters();
+    limiters.erase(std::remove(limiters.begin(), limiters.end(), this), limiters.end());
+}
+
+void LogSiteLimiter::flushSuppressed() {
+    struct Report {
+        LogSite site;
+        Logger *logger;
+        size_t count;
+    };
+    std::vector<Report> reports;
+    {
+        std::lock_guard<std::mutex> lock(siteLimitersLock());
+        for (auto limiter: siteLimiters()) {
+            size_t count = limiter->takeSuppressed();
+            if (count != 0) {
+                reports.push_back({limiter->_site, limiter->_logger.load(std::memory_order_relaxed), count});
+            }
+        }
+    }
+    for (auto &report: reports) {
+        Logger *logger = report.logger ? report.logger : Logging::getRootLogger();
+        if (logger) {
+            LoggingHelper::suppressed(report.site.file, report.site.line, report.site.func, report.site.severity,
+                                      report.count, logger);
+        }
+    }
+}
+
+
+const double LogRateLimiter::defaultRate = 5.0;
+
+const size_t LogRateLimiter::defaultBurst = 10;
+
+
+LogRateLimiter::LogRateLimiter(const LogSite &site, double rate, size_t burst)
+        : LogSiteLimiter(site)
+        , _interval((int64_t)(1000000000.0 / std::max(rate, 0.001)))
+        , _tolerance(_interval * (int64_t)(std::max(burst, (size_t)1) - 1)) {
+
+}
+
+bool LogRateLimiter::tryAcquire(Logger *logger, size_t &suppressed) {
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t arrival = _arrival.load(std::memory_order_relaxed);
+    do {
+        int64_t base = std::max(arrival, now);
+        if (base - now > _tolerance) {
+            suppress(logger);
+            return false;
+        }
+        if (_arrival.compare_exchange_weak(arrival, base + _interval, std::memory_order_relaxed)) {
+            break;
+        }
+    } while (true);
+    suppressed = takeSuppressed();
+    return true;
+}
+
+NS_END
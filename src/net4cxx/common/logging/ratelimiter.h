@@ -0,0 +1,91 @@
+//
+// Created by agent on 26-10-18.
+//
+
+#ifndef NET4CXX_COMMON_LOGGING_RATELIMITER_H
+#define NET4CXX_COMMON_LOGGING_RATELIMITER_H
+
+#include "net4cxx/common/common.h"
+#include <atomic>
+#include <boost/noncopyable.hpp>
+#include "net4cxx/common/logging/attributes.h"
+
+NS_BEGIN
+
+class Logger;
+
+
+struct LogSite {
+    StringLiteral file;
+    size_t line;
+    StringLiteral func;
+    Severity severity;
+};
+
+
+/// Counts the calls one log site held back, so they can be reported even after the site goes quiet
+class NET4CXX_COMMON_API LogSiteLimiter: public boost::noncopyable {
+public:
+    explicit LogSiteLimiter(const LogSite &site);
+
+    ~LogSiteLimiter();
+
+    /// Reports "Suppressed N similar messages" for every site that dropped calls since its last report
+    static void flushSuppressed();
+protected:
+    void suppress(Logger *logger) {
+        _logger.store(logger, std::memory_order_relaxed);
+        _suppressed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    size_t takeSuppressed() {
+        return _suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+    LogSite _site;
+    std::atomic<Logger *> _logger{nullptr};
+    std::atomic<size_t> _suppressed{0};
+};
+
+
+/// Token bucket shared by all calls of one log site, implemented as a lock-free GCRA
+class NET4CXX_COMMON_API LogRateLimiter: public LogSiteLimiter {
+public:
+    static const double defaultRate;
+    static const size_t defaultBurst;
+
+    explicit LogRateLimiter(const LogSite &site, double rate=defaultRate, size_t burst=defaultBurst);
+
+    bool tryAcquire(Logger *logger, size_t &suppressed);
+protected:
+    int64_t _interval;
+    int64_t _tolerance;
+    std::atomic<int64_t> _arrival{0};
+};
+
+
+/// Lets one of every N calls of one log site through
+class NET4CXX_COMMON_API LogSampler: public LogSiteLimiter {
+public:
+    LogSampler(const LogSite &site, size_t rate)
+            : LogSiteLimiter(site)
+            , _rate(std::max(rate, (size_t)1)) {
+
+    }
+
+    bool tryAcquire(Logger *logger, size_t &suppressed) {
+        if (_count.fetch_add(1, std::memory_order_relaxed) % _rate != 0) {
+            suppress(logger);
+            return false;
+        }
+        suppressed = takeSuppressed();
+        return true;
+    }
+protected:
+    size_t _rate;
+    std::atomic<size_t> _count{0};
+};
+
+NS_END
+
+#endif //NET4CXX_COMMON_LOGGING_RATELIMITER_H
@@ -17,14 +17,19 @@ void BaseSink::setFilter(const std::string &name, Severity severity) {
 
 
 void BaseSink::onSetFilter(FrontendSinkPtr sink) const {
+    logging::filter filter;
     if (_filter) {
-        sink->set_filter(logging::parse_filter(*_filter));
+        filter = logging::parse_filter(*_filter);
     } else if (_name) {
-        sink->set_filter(boost::phoenix::bind(&BaseSink::filter, attr_severity.or_none(), attr_channel.or_none(),
-                                              *_name, _severity));
+        filter = boost::phoenix::bind(&BaseSink::filter, attr_severity.or_none(), attr_channel.or_none(), *_name,
+                                      _severity);
     } else {
-        sink->set_filter(attr_severity >= _severity);
+        filter = attr_severity >= _severity;
     }
+    bool deferred = _deferred;
+    sink->set_filter([filter, deferred](const logging::attribute_value_set &attrs) {
+        return filterDeferred(attrs[attr_deferred], deferred) && filter(attrs);
+    });
 }
 
 void BaseSink::onSetFormatter(FrontendSinkPtr sink) const {
@@ -45,6 +50,10 @@ bool BaseSink::filter(const logging::value_ref <Severity, tag::attr_severity> &s
     return ChannelFilterFactory::isChildOf(channel.get(), name);
 }
 
+bool BaseSink::filterDeferred(const logging::value_ref<bool, tag::attr_deferred> &deferred, bool expected) {
+    return (deferred && deferred.get()) == expected;
+}
+
 
 ConsoleSink::FrontendSinkPtr ConsoleSink::createSink() const {
     auto backend = createBackend();
@@ -41,6 +41,23 @@ public:
         _async = async;
     }
 
+    /// Records are formatted on the LogDispatcher thread instead of the logging thread
+    void setDeferred(bool deferred) {
+        _deferred = deferred;
+    }
+
+    bool isDeferred() const {
+        return _deferred;
+    }
+
+    Severity getMinSeverity() const {
+        return _filter ? SEVERITY_TRACE : _severity;
+    }
+
+    boost::optional<std::string> getChannelFilter() const {
+        return _filter ? boost::none : _name;
+    }
+
     FrontendSinkPtr makeSink() const {
         FrontendSinkPtr sink;
         if (_async) {
@@ -67,11 +84,14 @@ protected:
                        const logging::value_ref<std::string, tag::attr_channel> &channel,
                        const std::string &name, Severity severity);
 
+    static bool filterDeferred(const logging::value_ref<bool, tag::attr_deferred> &deferred, bool expected);
+
     Severity _severity{SEVERITY_INFO};
     boost::optional<std::string> _name;
     boost::optional<std::string> _formatter;
     boost::optional<std::string> _filter;
     bool _async{false};
+    bool _deferred{false};
 };
 
 
@@ -9,7 +9,8 @@ NS_BEGIN
 
 
 IArchive& IArchive::operator>>(float &value) {
-    value = read<float>();
+    auto bits = read<uint32_t>();
+    memcpy(&value, &bits, sizeof(value));
     if (!std::isfinite(value)) {
         NET4CXX_THROW_EXCEPTION(ArchiveError, "Infinite float value");
     }
@@ -17,7 +18,8 @@ IArchive& IArchive::operator>>(float &value) {
 }
 
 IArchive& IArchive::operator>>(double &value) {
-    value = read<double>();
+    auto bits = read<uint64_t>();
+    memcpy(&value, &bits, sizeof(value));
     if (!std::isfinite(value)) {
         NET4CXX_THROW_EXCEPTION(ArchiveError, "Infinite double value");
     }
@@ -25,10 +27,7 @@ IArchive& IArchive::operator>>(double &value) {
 }
 
 IArchive& IArchive::operator>>(std::string &value) {
-    size_t len = read<uint8_t>();
-    if (len == 0xFF) {
-        len = read<uint32_t>();
-    }
+    size_t len = readLength();
     std::string result;
     if (len > 0) {
         result.resize(len);
@@ -39,10 +38,7 @@ IArchive& IArchive::operator>>(std::string &value) {
 }
 
 IArchive& IArchive::operator>>(ByteArray &value) {
-    size_t len = read<uint8_t>();
-    if (len == 0xFF) {
-        len = read<uint32_t>();
-    }
+    size_t len = readLength();
     ByteArray result;
     if (len > 0) {
         result.resize(len);
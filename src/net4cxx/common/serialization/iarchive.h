@@ -7,7 +7,10 @@
 
 #include "net4cxx/common/common.h"
 #include <boost/endian/conversion.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <boost/utility/string_ref.hpp>
 #include "net4cxx/common/utilities/errors.h"
+#include "net4cxx/common/utilities/messagebuffer.h"
 
 
 NS_BEGIN
@@ -17,20 +20,58 @@ NET4CXX_DECLARE_EXCEPTION(ArchiveError, Exception);
 NET4CXX_DECLARE_EXCEPTION(ArchivePositionError, ArchiveError);
 
 
+enum class ArchiveFormat {
+    /// Little-endian integers at their full width, lengths below 255 in one byte and five bytes otherwise
+    Fixed,
+    /// LEB128 varints for integers wider than a byte and for lengths, zigzag mapped when signed
+    Compact,
+};
+
+
+/// Points into the archive's input, only valid while that buffer is
+typedef boost::iterator_range<const Byte *> ByteView;
+
+
+/// Element types whose in-memory layout matches the wire, so contiguous containers of them take one memcpy.
+/// Other trivially copyable types are not included: they are archived member by member through their own
+/// operators, and their memory image carries padding and host layout that the wire format does not.
+template <typename ValueT>
+struct ArchiveBulkCopy: public std::integral_constant<bool, std::is_arithmetic<ValueT>::value &&
+                                                            !std::is_same<ValueT, bool>::value &&
+                                                            boost::endian::order::native ==
+                                                            boost::endian::order::little> {
+
+};
+
+
 class IArchive {
 public:
-    IArchive(const Byte *data, size_t size)
+    IArchive(const Byte *data, size_t size, ArchiveFormat format=ArchiveFormat::Fixed)
             : _storage(data)
-            , _size(size) {
+            , _size(size)
+            , _format(format) {
 
     }
 
-    explicit IArchive(const ByteArray &data)
+    explicit IArchive(const ByteArray &data, ArchiveFormat format=ArchiveFormat::Fixed)
             : _storage(data.data())
-            , _size(data.size()) {
+            , _size(data.size())
+            , _format(format) {
+
+    }
+
+    /// Reads the buffer's active region in place, call readCompleted(size() - remainSize()) on it afterwards
+    explicit IArchive(const MessageBuffer &data, ArchiveFormat format=ArchiveFormat::Fixed)
+            : _storage(data.getReadPointer())
+            , _size(data.getActiveSize())
+            , _format(format) {
 
     }
 
+    ArchiveFormat getFormat() const {
+        return _format;
+    }
+
     bool empty() const {
         return _pos == _size;
     }
@@ -59,17 +100,17 @@ public:
     }
 
     IArchive& operator>>(uint16_t &value) {
-        value = read<uint16_t>();
+        value = readInteger<uint16_t>();
         return *this;
     }
 
     IArchive& operator>>(uint32_t &value) {
-        value = read<uint32_t>();
+        value = readInteger<uint32_t>();
         return *this;
     }
 
     IArchive& operator>>(uint64_t &value) {
-        value = read<uint64_t>();
+        value = readInteger<uint64_t>();
         return *this;
     }
 
@@ -79,17 +120,17 @@ public:
     }
 
     IArchive& operator>>(int16_t &value) {
-        value = read<int16_t>();
+        value = readInteger<int16_t>();
         return *this;
     }
 
     IArchive& operator>>(int32_t &value) {
-        value = read<int32_t>();
+        value = readInteger<int32_t>();
         return *this;
     }
 
     IArchive& operator>>(int64_t &value) {
-        value = read<int64_t>();
+        value = readInteger<int64_t>();
         return *this;
     }
 
@@ -101,6 +142,24 @@ public:
 
     IArchive& operator>>(ByteArray &value);
 
+    /// Zero-copy counterpart of std::string, the view points into the input buffer
+    IArchive& operator>>(boost::string_ref &value) {
+        size_t len = readLength();
+        checkReadOverflow(len);
+        value = boost::string_ref((const char *)_storage + _pos, len);
+        _pos += len;
+        return *this;
+    }
+
+    /// Zero-copy counterpart of ByteArray, the view points into the input buffer
+    IArchive& operator>>(ByteView &value) {
+        size_t len = readLength();
+        checkReadOverflow(len);
+        value = ByteView(_storage + _pos, _storage + _pos + len);
+        _pos += len;
+        return *this;
+    }
+
     template <size_t LEN>
     IArchive& operator>>(std::array<char, LEN> &value) {
         read((Byte *)value.data(), value.size());
@@ -115,6 +174,10 @@ public:
 
     template <typename ElemT, size_t LEN>
     IArchive& operator>>(std::array<ElemT, LEN> &value) {
+        if (isBulkCopyable<ElemT>()) {
+            readBulk(value.data(), LEN);
+            return *this;
+        }
         for (auto &elem: value) {
             *this >> elem;
         }
@@ -123,6 +186,14 @@ public:
 
     template <typename ElemT, typename AllocT>
     IArchive& operator>>(std::vector<ElemT, AllocT> &value) {
+        if (isBulkCopyable<ElemT>()) {
+            size_t len = readLength();
+            checkReadOverflow(len * sizeof(ElemT));
+            std::vector<ElemT, AllocT> result(len);
+            readBulk(result.data(), len);
+            result.swap(value);
+            return *this;
+        }
         readSequence(value);
         return *this;
     }
@@ -198,12 +269,41 @@ public:
         return *this >> value;
     }
 protected:
+    template <typename ElemT>
+    bool isBulkCopyable() const {
+        return ArchiveBulkCopy<ElemT>::value && (_format == ArchiveFormat::Fixed || sizeof(ElemT) == 1 ||
+                                                 std::is_floating_point<ElemT>::value);
+    }
+
+    template <typename ElemT>
+    void readBulk(ElemT *dest, size_t len) {
+        if (len == 0) {
+            return;
+        }
+        read((Byte *)dest, len * sizeof(ElemT));
+        checkFinite(dest, len);
+    }
+
+    template <typename ElemT>
+    static typename std::enable_if<std::is_floating_point<ElemT>::value>::type checkFinite(const ElemT *data,
+                                                                                          size_t len) {
+        for (size_t i = 0; i != len; ++i) {
+            if (!std::isfinite(data[i])) {
+                NET4CXX_THROW_EXCEPTION(ArchiveError, sizeof(ElemT) == sizeof(float) ? "Infinite float value" :
+                                                      "Infinite double value");
+            }
+        }
+    }
+
+    template <typename ElemT>
+    static typename std::enable_if<!std::is_floating_point<ElemT>::value>::type checkFinite(const ElemT *data,
+                                                                                           size_t len) {
+
+    }
+
     template <typename ElemT, typename AllocT, template <typename, typename> class ContainerT>
     void readSequence(ContainerT<ElemT, AllocT> &value) {
-        size_t len = read<uint8_t>();
-        if (len == 0xFF) {
-            len = read<uint32_t>();
-        }
+        size_t len = readLength();
         ContainerT<ElemT, AllocT> result;
         ElemT elem;
         for (size_t i = 0; i != len; ++i) {
@@ -216,10 +316,7 @@ protected:
     template <typename ElemT, typename CompareT, typename AllocT,
             template <typename, typename, typename > class ContainerT>
     void readSet(ContainerT<ElemT, CompareT, AllocT> &value) {
-        size_t len = read<uint8_t>();
-        if (len == 0xFF) {
-            len = read<uint32_t>();
-        }
+        size_t len = readLength();
         ContainerT<ElemT, CompareT, AllocT> result;
         for (size_t i = 0; i != len; ++i) {
             ElemT elem;
@@ -232,10 +329,7 @@ protected:
     template <typename ElemT, typename HashT, typename PredT, typename AllocT,
             template <typename, typename, typename, typename> class ContainerT>
     void readSet(ContainerT<ElemT, HashT, PredT, AllocT> &value) {
-        size_t len = read<uint8_t>();
-        if (len == 0xFF) {
-            len = read<uint32_t>();
-        }
+        size_t len = readLength();
         ContainerT<ElemT, HashT, PredT, AllocT> result;
         for (size_t i = 0; i != len; ++i) {
             ElemT elem;
@@ -248,10 +342,7 @@ protected:
     template <typename KeyT, typename ValueT, typename CompareT, typename AllocT,
             template <typename, typename, typename, typename> class ContainerT>
     void readMapping(ContainerT<KeyT, ValueT, CompareT, AllocT> &value) {
-        size_t len = read<uint8_t>();
-        if (len == 0xFF) {
-            len = read<uint32_t>();
-        }
+        size_t len = readLength();
         ContainerT<KeyT, ValueT, CompareT, AllocT> result;
         for (size_t i = 0; i != len; ++i) {
             KeyT key;
@@ -265,10 +356,7 @@ protected:
     template <typename KeyT, typename ValueT, typename HashT, typename PredT, typename AllocT,
             template <typename, typename, typename, typename, typename> class ContainerT>
     void readMapping(ContainerT<KeyT, ValueT, HashT, PredT, AllocT> &value) {
-        size_t len = read<uint8_t>();
-        if (len == 0xFF) {
-            len = read<uint32_t>();
-        }
+        size_t len = readLength();
         ContainerT<KeyT, ValueT, HashT, PredT, AllocT> result;
         for (size_t i = 0; i != len; ++i) {
             KeyT key;
@@ -289,8 +377,71 @@ protected:
         return val;
     }
 
+    template <typename ValueT>
+    typename std::enable_if<std::is_unsigned<ValueT>::value, ValueT>::type readInteger() {
+        if (_format == ArchiveFormat::Fixed) {
+            return read<ValueT>();
+        }
+        uint64_t val = readVarint();
+        if (val > std::numeric_limits<ValueT>::max()) {
+            NET4CXX_THROW_EXCEPTION(ArchiveError, "Varint out of range");
+        }
+        return static_cast<ValueT>(val);
+    }
+
+    template <typename ValueT>
+    typename std::enable_if<std::is_signed<ValueT>::value, ValueT>::type readInteger() {
+        if (_format == ArchiveFormat::Fixed) {
+            return read<ValueT>();
+        }
+        uint64_t val = readVarint();
+        auto decoded = static_cast<int64_t>((val >> 1) ^ (~(val & 1) + 1));
+        if (decoded < std::numeric_limits<ValueT>::min() || decoded > std::numeric_limits<ValueT>::max()) {
+            NET4CXX_THROW_EXCEPTION(ArchiveError, "Varint out of range");
+        }
+        return static_cast<ValueT>(decoded);
+    }
+
+    uint64_t readVarint() {
+        if (_pos != _size && _storage[_pos] < 0x80) {
+            return _storage[_pos++];
+        }
+        const Byte *data = _storage + _pos;
+        size_t avail = _size - _pos;
+        uint64_t val = 0;
+        for (size_t i = 0; i != 10; ++i) {
+            if (i == avail) {
+                checkReadOverflow(i + 1);
+            }
+            Byte byte = data[i];
+            val |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+            if (byte < 0x80) {
+                if (i == 9 && byte > 1) {
+                    break;
+                }
+                _pos += i + 1;
+                return val;
+            }
+        }
+        NET4CXX_THROW_EXCEPTION(ArchiveError, "Malformed varint");
+    }
+
+    size_t readLength() {
+        if (_format == ArchiveFormat::Compact) {
+            return readInteger<uint32_t>();
+        }
+        size_t len = read<uint8_t>();
+        if (len == 0xFF) {
+            len = read<uint32_t>();
+        }
+        return len;
+    }
+
     void read(Byte *dest, size_t len) {
         checkReadOverflow(len);
+        if (len == 0) {
+            return;
+        }
         std::memcpy(dest, _storage + _pos, len);
         _pos += len;
     }
@@ -302,6 +453,7 @@ protected:
     const Byte *_storage;
     size_t _pos{0};
     size_t _size;
+    ArchiveFormat _format;
 };
 
 NS_END
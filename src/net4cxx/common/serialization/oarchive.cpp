@@ -8,36 +8,21 @@ NS_BEGIN
 
 OArchive& OArchive::operator<<(const char *value) {
     size_t len = strlen(value);
-    if (len >= 0xff) {
-        append<uint8_t>(0xff);
-        append<uint32_t>(static_cast<uint32_t>(len));
-    } else {
-        append<uint8_t>(static_cast<uint8_t>(len));
-    }
+    appendLength(len);
     append((const Byte *)value, len);
     return *this;
 }
 
 OArchive& OArchive::operator<<(std::string &value) {
     size_t len = value.size();
-    if (len >= 0xff) {
-        append<uint8_t>(0xff);
-        append<uint32_t>(static_cast<uint32_t>(len));
-    } else {
-        append<uint8_t>(static_cast<uint8_t>(len));
-    }
+    appendLength(len);
     append((const Byte *)value.data(), len);
     return *this;
 }
 
 OArchive& OArchive::operator<<(const ByteArray &value) {
     size_t len = value.size();
-    if (len >= 0xff) {
-        append<uint8_t>(0xff);
-        append<uint32_t>(static_cast<uint32_t>(len));
-    } else {
-        append<uint8_t>(static_cast<uint8_t>(len));
-    }
+    appendLength(len);
     append(value.data(), len);
     return *this;
 }
@@ -20,6 +20,22 @@ public:
         _storage.reserve(reserve);
     }
 
+    explicit OArchive(ArchiveFormat format, size_t reserve=0)
+            : _format(format) {
+        _storage.reserve(reserve);
+    }
+
+    /// Appends after the bytes already in storage, move() hands them all back
+    explicit OArchive(ByteArray &&storage, ArchiveFormat format=ArchiveFormat::Fixed)
+            : _storage(std::move(storage))
+            , _format(format) {
+
+    }
+
+    ArchiveFormat getFormat() const {
+        return _format;
+    }
+
     ByteArray&& move() noexcept {
         return std::move(_storage);
     }
@@ -52,17 +68,17 @@ public:
     }
 
     OArchive& operator<<(uint16_t value) {
-        append<uint16_t>(value);
+        appendInteger<uint16_t>(value);
         return *this;
     }
 
     OArchive& operator<<(uint32_t value) {
-        append<uint32_t>(value);
+        appendInteger<uint32_t>(value);
         return *this;
     }
 
     OArchive& operator<<(uint64_t value) {
-        append<uint64_t>(value);
+        appendInteger<uint64_t>(value);
         return *this;
     }
 
@@ -72,27 +88,31 @@ public:
     }
 
     OArchive& operator<<(int16_t value) {
-        append<int16_t>(value);
+        appendInteger<int16_t>(value);
         return *this;
     }
 
     OArchive& operator<<(int32_t value) {
-        append<int32_t>(value);
+        appendInteger<int32_t>(value);
         return *this;
     }
 
     OArchive& operator<<(int64_t value) {
-        append<int64_t>(value);
+        appendInteger<int64_t>(value);
         return *this;
     }
 
     OArchive& operator<<(float value) {
-        append<float>(value);
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        append<uint32_t>(bits);
         return *this;
     }
 
     OArchive& operator<<(double value) {
-        append<double>(value);
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        append<uint64_t>(bits);
         return *this;
     }
 
@@ -102,6 +122,18 @@ public:
 
     OArchive& operator<<(const ByteArray &value);
 
+    OArchive& operator<<(boost::string_ref value) {
+        appendLength(value.size());
+        append((const Byte *)value.data(), value.size());
+        return *this;
+    }
+
+    OArchive& operator<<(ByteView value) {
+        appendLength(value.size());
+        append(value.begin(), value.size());
+        return *this;
+    }
+
     template <size_t LEN>
     OArchive& operator<<(const std::array<char, LEN> &value) {
         append((const Byte *)value.data(), value.size());
@@ -116,6 +148,10 @@ public:
 
     template <typename ElemT, size_t LEN>
     OArchive& operator<<(std::array<ElemT, LEN> &value) {
+        if (isBulkCopyable<ElemT>()) {
+            append((const Byte *)value.data(), LEN * sizeof(ElemT));
+            return *this;
+        }
         for (auto &elem: value) {
             *this << elem;
         }
@@ -124,6 +160,11 @@ public:
 
     template <typename ElemT, typename AllocT>
     OArchive& operator<<(std::vector<ElemT, AllocT> &value) {
+        if (isBulkCopyable<ElemT>()) {
+            appendLength(value.size());
+            append((const Byte *)value.data(), value.size() * sizeof(ElemT));
+            return *this;
+        }
         appendSequence(value);
         return *this;
     }
@@ -199,15 +240,15 @@ public:
         return *this << value;
     }
 protected:
+    template <typename ElemT>
+    bool isBulkCopyable() const {
+        return ArchiveBulkCopy<ElemT>::value && (_format == ArchiveFormat::Fixed || sizeof(ElemT) == 1 ||
+                                                 std::is_floating_point<ElemT>::value);
+    }
+
     template <typename ElemT, typename AllocT, template <typename, typename > class ContainerT>
     void appendSequence(ContainerT<ElemT, AllocT> &value) {
-        size_t len = value.size();
-        if (len >= 0xFF) {
-            append<uint8>(0xff);
-            append<uint32>(static_cast<uint32>(len));
-        } else {
-            append<uint8>(static_cast<uint8>(len));
-        }
+        appendLength(value.size());
         for (ElemT &elem: value) {
             *this << elem;
         }
@@ -216,13 +257,7 @@ protected:
     template <typename KeyT, typename CompareT, typename AllocT,
             template <typename, typename, typename > class ContainerT>
     void appendSet(ContainerT<KeyT, CompareT, AllocT> &value) {
-        size_t len = value.size();
-        if (len >= 0xFF) {
-            append<uint8>(0xff);
-            append<uint32>(static_cast<uint32>(len));
-        } else {
-            append<uint8>(static_cast<uint8>(len));
-        }
+        appendLength(value.size());
         for (const KeyT &key: value) {
             *this << key;
         }
@@ -231,13 +266,7 @@ protected:
     template <typename KeyT, typename HashT, typename PredT, typename AllocT,
             template <typename, typename, typename, typename > class ContainerT>
     void appendSet(ContainerT<KeyT, HashT, PredT, AllocT> &value) {
-        size_t len = value.size();
-        if (len >= 0xFF) {
-            append<uint8>(0xff);
-            append<uint32>(static_cast<uint32>(len));
-        } else {
-            append<uint8>(static_cast<uint8>(len));
-        }
+        appendLength(value.size());
         for (const KeyT &key: value) {
             *this << key;
         }
@@ -246,13 +275,7 @@ protected:
     template <typename KeyT, typename ValueT, typename CompareT, typename AllocT,
             template <typename, typename, typename, typename> class ContainerT>
     void appendMapping(ContainerT<KeyT, ValueT, CompareT, AllocT> &value) {
-        size_t len = value.size();
-        if (len >= 0xFF) {
-            append<uint8>(0xff);
-            append<uint32>(static_cast<uint32>(len));
-        } else {
-            append<uint8>(static_cast<uint8>(len));
-        }
+        appendLength(value.size());
         for (auto &kv: value) {
             *this << kv.first << kv.second;
         }
@@ -261,17 +284,57 @@ protected:
     template <typename KeyT, typename ValueT, typename HashT, typename PredT, typename AllocT,
             template <typename, typename, typename, typename, typename > class ContainerT>
     void appendMapping(ContainerT<KeyT, ValueT, HashT, PredT, AllocT> &value) {
-        size_t len = value.size();
-        if (len >= 0xFF) {
+        appendLength(value.size());
+        for (auto &kv: value) {
+            *this << kv.first << kv.second;
+        }
+    };
+
+    template <typename ValueT>
+    typename std::enable_if<std::is_unsigned<ValueT>::value>::type appendInteger(ValueT value) {
+        if (_format == ArchiveFormat::Fixed) {
+            append<ValueT>(value);
+        } else {
+            appendVarint(value);
+        }
+    }
+
+    template <typename ValueT>
+    typename std::enable_if<std::is_signed<ValueT>::value>::type appendInteger(ValueT value) {
+        if (_format == ArchiveFormat::Fixed) {
+            append<ValueT>(value);
+        } else {
+            // Zigzag keeps small negative values short: 0, -1, 1, -2 become 0, 1, 2, 3
+            auto val = static_cast<int64_t>(value);
+            appendVarint((static_cast<uint64_t>(val) << 1) ^ static_cast<uint64_t>(val >> 63));
+        }
+    }
+
+    void appendVarint(uint64_t value) {
+        if (value < 0x80) {
+            _storage.push_back(static_cast<Byte>(value));
+            return;
+        }
+        Byte buffer[10];
+        size_t len = 0;
+        while (value >= 0x80) {
+            buffer[len++] = static_cast<Byte>(value | 0x80);
+            value >>= 7;
+        }
+        buffer[len++] = static_cast<Byte>(value);
+        append(buffer, len);
+    }
+
+    void appendLength(size_t len) {
+        if (_format == ArchiveFormat::Compact) {
+            appendVarint(static_cast<uint32_t>(len));
+        } else if (len >= 0xFF) {
             append<uint8>(0xff);
             append<uint32>(static_cast<uint32>(len));
         } else {
             append<uint8>(static_cast<uint8>(len));
         }
-        for (auto &kv: value) {
-            *this << kv.first << kv.second;
-        }
-    };
+    }
 
     template <typename ValueT>
     void append(ValueT value) {
@@ -281,10 +344,15 @@ protected:
     }
 
     void append(const Byte *src, size_t len) {
+        // Empty containers may hand in a null data()
+        if (len == 0) {
+            return;
+        }
         _storage.insert(_storage.end(), src, src + len);
     }
 
     ByteArray _storage;
+    ArchiveFormat _format{ArchiveFormat::Fixed};
 };
 
 
@@ -25,6 +25,14 @@ public:
         _storage.resize(initialSize);
     }
 
+    /// Takes over already written bytes, e.g. a finished OArchive, as the active region
+    explicit MessageBuffer(ByteArray &&storage)
+            : _wpos(storage.size())
+            , _rpos(0)
+            , _storage(std::move(storage)) {
+
+    }
+
     void reset() {
         _wpos = 0;
         _rpos = 0;
@@ -38,10 +46,18 @@ public:
         return _storage.data();
     }
 
+    const Byte* getBasePointer() const {
+        return _storage.data();
+    }
+
     Byte* getReadPointer() {
         return getBasePointer() + _rpos;
     }
 
+    const Byte* getReadPointer() const {
+        return getBasePointer() + _rpos;
+    }
+
     Byte* getWritePointer() {
         return getBasePointer() + _wpos;
     }
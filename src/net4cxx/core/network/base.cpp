@@ -3,8 +3,16 @@
 //
 
 #include "net4cxx/core/network/base.h"
+#include <fstream>
+#include <mutex>
 #include <boost/filesystem.hpp>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
 #include "net4cxx/common/debugging/assert.h"
+#include "net4cxx/common/global/loggers.h"
 #include "net4cxx/core/network/protocol.h"
 #include "net4cxx/core/network/reactor.h"
 
@@ -72,6 +80,268 @@ SSLOption::SSLOption(const SSLParams &sslParams)
             setCheckHost(checkHost);
         }
     }
+    setSessionCache(sslParams);
+    _dynamicRecordSize = sslParams.getDynamicRecordSize();
+#if PLATFORM == PLATFORM_UNIX && defined(SSL_OP_ENABLE_KTLS)
+    if (sslParams.getKernelTLS()) {
+        if (NetUtil::isKernelTLSAvailable()) {
+            SSL_CTX_set_options(_context.native_handle(), SSL_OP_ENABLE_KTLS);
+            _kernelTLS = true;
+        } else {
+            NET4CXX_LOG_WARN(gGenLog, "Kernel TLS is not available, falling back to user-space TLS");
+        }
+    }
+#endif
+}
+
+SSLOption::~SSLOption() {
+    clearSessions();
+}
+
+void SSLOption::prepareSession(SSL *ssl, const std::string *sessionKey) {
+    if (_serverSide || !_sessionCacheSize) {
+        return;
+    }
+    SSL_set_ex_data(ssl, sessionKeyIndex(), (void *)sessionKey);
+    std::lock_guard<std::mutex> lock(_sessionLock);
+    auto iter = _sessions.find(*sessionKey);
+    if (iter != _sessions.end()) {
+        SSL_set_session(ssl, iter->second.first);
+        _sessionOrder.splice(_sessionOrder.end(), _sessionOrder, iter->second.second);
+    }
+}
+
+void SSLOption::removeSession(const std::string &sessionKey) {
+    std::lock_guard<std::mutex> lock(_sessionLock);
+    auto iter = _sessions.find(sessionKey);
+    if (iter != _sessions.end()) {
+        SSL_SESSION_free(iter->second.first);
+        _sessionOrder.erase(iter->second.second);
+        _sessions.erase(iter);
+    }
+}
+
+void SSLOption::clearSessions() {
+    std::lock_guard<std::mutex> lock(_sessionLock);
+    for (auto &session: _sessions) {
+        SSL_SESSION_free(session.second.first);
+    }
+    _sessions.clear();
+    _sessionOrder.clear();
+}
+
+void SSLOption::rotateTicketKeys() {
+    std::lock_guard<std::mutex> lock(_sessionLock);
+    if (!addTicketKey()) {
+        NET4CXX_THROW_EXCEPTION(Exception, "generate session ticket key failed");
+    }
+}
+
+void SSLOption::setSessionCache(const SSLParams &sslParams) {
+    SSL_CTX *ctx = _context.native_handle();
+    SSL_CTX_set_ex_data(ctx, contextIndex(), this);
+    _sessionCacheSize = sslParams.getSessionCacheSize();
+    if (!_sessionCacheSize) {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+        SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+        return;
+    }
+    SSL_CTX_set_timeout(ctx, sslParams.getSessionTimeout());
+    if (_serverSide) {
+        static const unsigned char sessionIdContext[] = "net4cxx";
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+        SSL_CTX_sess_set_cache_size(ctx, (long)_sessionCacheSize);
+        SSL_CTX_set_session_id_context(ctx, sessionIdContext, sizeof(sessionIdContext) - 1);
+        if (sslParams.getSessionTickets()) {
+            _ticketKeyLifetime = std::chrono::milliseconds(int64_t(sslParams.getTicketKeyLifetime() * 1000));
+            rotateTicketKeys();
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+            SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, &SSLOption::onTicketKey);
+#else
+            SSL_CTX_set_tlsext_ticket_key_cb(ctx, &SSLOption::onTicketKey);
+#endif
+        } else {
+            SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+        }
+    } else {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_sess_set_new_cb(ctx, &SSLOption::onNewSession);
+        if (!sslParams.getSessionTickets()) {
+            SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+        }
+    }
+}
+
+void SSLOption::addSession(const std::string &sessionKey, SSL_SESSION *session) {
+    std::lock_guard<std::mutex> lock(_sessionLock);
+    auto iter = _sessions.find(sessionKey);
+    if (iter != _sessions.end()) {
+        SSL_SESSION_free(iter->second.first);
+        iter->second.first = session;
+        _sessionOrder.splice(_sessionOrder.end(), _sessionOrder, iter->second.second);
+        return;
+    }
+    while (_sessions.size() >= _sessionCacheSize) {
+        auto oldest = _sessions.find(_sessionOrder.front());
+        SSL_SESSION_free(oldest->second.first);
+        _sessions.erase(oldest);
+        _sessionOrder.pop_front();
+    }
+    _sessions.emplace(sessionKey, SessionEntry{session, _sessionOrder.insert(_sessionOrder.end(), sessionKey)});
+}
+
+bool SSLOption::addTicketKey() {
+    TicketKey key;
+    if (RAND_bytes(key.name, sizeof(key.name)) != 1 || RAND_bytes(key.hmacKey, sizeof(key.hmacKey)) != 1 ||
+        RAND_bytes(key.aesKey, sizeof(key.aesKey)) != 1) {
+        return false;
+    }
+    key.created = TimestampClock::now();
+    _ticketKeys.push_front(key);
+    while (_ticketKeys.size() > 2) {
+        _ticketKeys.pop_back();
+    }
+    return true;
+}
+
+int SSLOption::onNewSession(SSL *ssl, SSL_SESSION *session) {
+    auto sslOption = (SSLOption *)SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), contextIndex());
+    auto sessionKey = (const std::string *)SSL_get_ex_data(ssl, sessionKeyIndex());
+    if (!sslOption || !sessionKey) {
+        return 0;
+    }
+    sslOption->addSession(*sessionKey, session);
+    return 1;
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+int SSLOption::onTicketKey(SSL *ssl, unsigned char *keyName, unsigned char *iv, EVP_CIPHER_CTX *cipherCtx,
+                           EVP_MAC_CTX *macCtx, int enc) {
+#else
+int SSLOption::onTicketKey(SSL *ssl, unsigned char *keyName, unsigned char *iv, EVP_CIPHER_CTX *cipherCtx,
+                           HMAC_CTX *macCtx, int enc) {
+#endif
+    auto sslOption = (SSLOption *)SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), contextIndex());
+    if (!sslOption) {
+        return -1;
+    }
+    int result = sslOption->ticketKeyCallback(keyName, iv, cipherCtx, macCtx, enc);
+    if (result == 1 && !enc && SSL_version(ssl) == TLS1_3_VERSION) {
+        // TLS 1.3 clients use each ticket once, always hand out a fresh one
+        result = 2;
+    }
+    return result;
+}
+
+int SSLOption::ticketKeyCallback(unsigned char *keyName, unsigned char *iv, EVP_CIPHER_CTX *cipherCtx, void *macCtx,
+                                 int enc) {
+    TicketKey key;
+    int result = 1;
+    {
+        std::lock_guard<std::mutex> lock(_sessionLock);
+        if (enc) {
+            if (TimestampClock::now() - _ticketKeys.front().created > _ticketKeyLifetime && !addTicketKey()) {
+                return -1;
+            }
+            key = _ticketKeys.front();
+        } else {
+            auto iter = std::find_if(_ticketKeys.begin(), _ticketKeys.end(), [keyName](const TicketKey &ticketKey) {
+                return memcmp(ticketKey.name, keyName, sizeof(ticketKey.name)) == 0;
+            });
+            if (iter == _ticketKeys.end()) {
+                return 0;
+            }
+            key = *iter;
+            result = iter == _ticketKeys.begin() ? 1 : 2;
+        }
+    }
+    if (enc) {
+        memcpy(keyName, key.name, sizeof(key.name));
+        if (RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) != 1) {
+            return -1;
+        }
+        if (!EVP_EncryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key.aesKey, iv)) {
+            return -1;
+        }
+    } else {
+        if (!EVP_DecryptInit_ex(cipherCtx, EVP_aes_256_cbc(), nullptr, key.aesKey, iv)) {
+            return -1;
+        }
+    }
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    OSSL_PARAM params[] = {
+            OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, key.hmacKey, sizeof(key.hmacKey)),
+            OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, (char *)"SHA256", 0),
+            OSSL_PARAM_construct_end(),
+    };
+    if (!EVP_MAC_CTX_set_params((EVP_MAC_CTX *)macCtx, params)) {
+        return -1;
+    }
+#else
+    if (!HMAC_Init_ex((HMAC_CTX *)macCtx, key.hmacKey, sizeof(key.hmacKey), EVP_sha256(), nullptr)) {
+        return -1;
+    }
+#endif
+    return result;
+}
+
+int SSLOption::contextIndex() {
+    static int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+int SSLOption::sessionKeyIndex() {
+    static int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+
+bool NetUtil::isKernelTLSAvailable() {
+#if PLATFORM == PLATFORM_UNIX && defined(SSL_OP_ENABLE_KTLS)
+    static bool available = []() {
+        std::ifstream file("/proc/sys/net/ipv4/tcp_available_ulp");
+        std::string ulp;
+        while (file >> ulp) {
+            if (ulp == "tls") {
+                return true;
+            }
+        }
+        return false;
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+unsigned short NetUtil::getServicePort(const std::string &port, const char *protocol) {
+    boost::system::error_code ec;
+    auto result = getServicePort(port, ec, protocol);
+    if (ec) {
+        NET4CXX_THROW_EXCEPTION(ValueError, StrUtil::format("Unknown service \"%s\"", port.c_str()));
+    }
+    return result;
+}
+
+unsigned short NetUtil::getServicePort(const std::string &port, boost::system::error_code &ec,
+                                       const char *protocol) {
+    ec.clear();
+    if (isValidPort(port)) {
+        unsigned long value = port.size() <= 5 ? std::stoul(port) : ULONG_MAX;
+        if (value > 0xFFFF) {
+            ec = boost::asio::error::invalid_argument;
+            return 0;
+        }
+        return (unsigned short)value;
+    }
+    static std::mutex lock;
+    std::lock_guard<std::mutex> guard(lock);
+    auto service = ::getservbyname(port.c_str(), protocol);
+    if (!service) {
+        ec = boost::asio::error::service_not_found;
+        return 0;
+    }
+    return ntohs((unsigned short)service->s_port);
 }
 
 
@@ -90,15 +360,37 @@ void DelayedCall::cancel() {
 }
 
 
+void ConnectionStats::accumulate(const ConnectionStats &rhs) {
+    bytesReceived += rhs.bytesReceived;
+    bytesSent += rhs.bytesSent;
+    readCount += rhs.readCount;
+    writeCount += rhs.writeCount;
+    blockedTime += rhs.blockedTime;
+}
+
+ConnectionStats& ConnectionStats::operator+=(const ConnectionStats &rhs) {
+    accumulate(rhs);
+    queuedBytes += rhs.queuedBytes;
+    maxQueuedBytes = std::max(maxQueuedBytes, rhs.maxQueuedBytes);
+    return *this;
+}
+
+
 void Connection::dataReceived(Byte *data, size_t length) {
     auto protocol = _protocol.lock();
     NET4CXX_ASSERT(protocol);
+    _stats.bytesReceived += length;
+    ++_stats.readCount;
     protocol->dataReceived(data, length);
 }
 
 void Connection::connectionLost(std::exception_ptr reason) {
     auto protocol = _protocol.lock();
     NET4CXX_ASSERT(protocol);
+    auto factory = protocol->_factory.lock();
+    if (factory && factory->_connections.erase(this)) {
+        factory->_closedStats.accumulate(_stats);
+    }
     protocol->connectionLost(std::move(reason));
 }
 
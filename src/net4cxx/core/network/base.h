@@ -6,10 +6,13 @@
 #define NET4CXX_CORE_NETWORK_BASE_H
 
 #include "net4cxx/common/common.h"
+#include <atomic>
+#include <mutex>
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/algorithm/string.hpp>
+#include "net4cxx/common/global/loggers.h"
 #include "net4cxx/common/utilities/errors.h"
 #include "net4cxx/common/utilities/messagebuffer.h"
 
@@ -31,6 +34,8 @@ class Protocol;
 using ProtocolPtr = std::shared_ptr<Protocol>;
 class SSLOption;
 using SSLOptionPtr = std::shared_ptr<SSLOption>;
+class HandshakePool;
+using HandshakePoolPtr = std::shared_ptr<HandshakePool>;
 class DatagramProtocol;
 using DatagramProtocolPtr = std::shared_ptr<DatagramProtocol>;
 
@@ -96,6 +101,54 @@ public:
         return _checkHost;
     }
 
+    void setSessionCacheSize(size_t sessionCacheSize) {
+        _sessionCacheSize = sessionCacheSize;
+    }
+
+    size_t getSessionCacheSize() const {
+        return _sessionCacheSize;
+    }
+
+    void setSessionTimeout(long sessionTimeout) {
+        _sessionTimeout = sessionTimeout;
+    }
+
+    long getSessionTimeout() const {
+        return _sessionTimeout;
+    }
+
+    void setSessionTickets(bool enabled) {
+        _sessionTickets = enabled;
+    }
+
+    bool getSessionTickets() const {
+        return _sessionTickets;
+    }
+
+    void setTicketKeyLifetime(double ticketKeyLifetime) {
+        _ticketKeyLifetime = ticketKeyLifetime;
+    }
+
+    double getTicketKeyLifetime() const {
+        return _ticketKeyLifetime;
+    }
+
+    void setKernelTLS(bool enabled) {
+        _kernelTLS = enabled;
+    }
+
+    bool getKernelTLS() const {
+        return _kernelTLS;
+    }
+
+    void setDynamicRecordSize(bool enabled) {
+        _dynamicRecordSize = enabled;
+    }
+
+    bool getDynamicRecordSize() const {
+        return _dynamicRecordSize;
+    }
+
     bool isServerSide() const {
         return _serverSide;
     }
@@ -108,6 +161,55 @@ protected:
     std::string _password;
     std::string _verifyFile;
     std::string _checkHost;
+    size_t _sessionCacheSize{20480};
+    long _sessionTimeout{300};
+    bool _sessionTickets{true};
+    double _ticketKeyLifetime{3600.0};
+    bool _kernelTLS{false};
+    bool _dynamicRecordSize{true};
+};
+
+
+class ListenParams {
+public:
+    ListenParams() = default;
+
+    void setBacklog(int backlog) {
+        _backlog = backlog;
+    }
+
+    int getBacklog() const {
+        return _backlog;
+    }
+
+    void setAcceptCount(size_t acceptCount) {
+        _acceptCount = std::max(acceptCount, (size_t)1);
+    }
+
+    size_t getAcceptCount() const {
+        return _acceptCount;
+    }
+
+    void setMaxAcceptsPerCall(size_t maxAccepts) {
+        _maxAcceptsPerCall = std::max(maxAccepts, (size_t)1);
+    }
+
+    size_t getMaxAcceptsPerCall() const {
+        return _maxAcceptsPerCall;
+    }
+
+    void setDeferAccept(int seconds) {
+        _deferAccept = seconds;
+    }
+
+    int getDeferAccept() const {
+        return _deferAccept;
+    }
+protected:
+    int _backlog{boost::asio::socket_base::max_listen_connections};
+    size_t _acceptCount{1};
+    size_t _maxAcceptsPerCall{64};
+    int _deferAccept{0};
 };
 
 
@@ -115,6 +217,8 @@ class NET4CXX_COMMON_API SSLOption: public boost::noncopyable {
 public:
     typedef boost::asio::ssl::context SSLContextType;
 
+    ~SSLOption();
+
     bool isServerSide() const {
         return _serverSide;
     }
@@ -123,10 +227,90 @@ public:
         return _context;
     }
 
+    bool isKernelTLS() const {
+        return _kernelTLS;
+    }
+
+    bool isDynamicRecordSize() const {
+        return _dynamicRecordSize;
+    }
+
+    void prepareSession(SSL *ssl, const std::string *sessionKey);
+
+    void removeSession(const std::string &sessionKey);
+
+    void clearSessions();
+
+    void handshakeCompleted(SSL *ssl) {
+        ++_handshakes;
+        if (SSL_session_reused(ssl)) {
+            ++_resumedHandshakes;
+        }
+    }
+
+    size_t getHandshakeCount() const {
+        return _handshakes;
+    }
+
+    size_t getResumedHandshakeCount() const {
+        return _resumedHandshakes;
+    }
+
+    void recordsFlushed(size_t records, size_t bytes) {
+        ++_flushes;
+        _records += records;
+        _recordBytes += bytes;
+    }
+
+    double getRecordsPerFlush() const {
+        size_t flushes = _flushes;
+        return flushes ? (double)_records / flushes : 0.0;
+    }
+
+    double getBytesPerRecord() const {
+        size_t records = _records;
+        return records ? (double)_recordBytes / records : 0.0;
+    }
+
+    void rotateTicketKeys();
+
     static SSLOptionPtr create(const SSLParams &sslParams);
 protected:
+    struct TicketKey {
+        unsigned char name[16];
+        unsigned char hmacKey[32];
+        unsigned char aesKey[32];
+        Timestamp created;
+    };
+
+    using SessionOrder = std::list<std::string>;
+    using SessionEntry = std::pair<SSL_SESSION *, SessionOrder::iterator>;
+
     explicit SSLOption(const SSLParams &sslParams);
 
+    void setSessionCache(const SSLParams &sslParams);
+
+    void addSession(const std::string &sessionKey, SSL_SESSION *session);
+
+    bool addTicketKey();
+
+    static int onNewSession(SSL *ssl, SSL_SESSION *session);
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    static int onTicketKey(SSL *ssl, unsigned char *keyName, unsigned char *iv, EVP_CIPHER_CTX *cipherCtx,
+                           EVP_MAC_CTX *macCtx, int enc);
+#else
+    static int onTicketKey(SSL *ssl, unsigned char *keyName, unsigned char *iv, EVP_CIPHER_CTX *cipherCtx,
+                           HMAC_CTX *macCtx, int enc);
+#endif
+
+    int ticketKeyCallback(unsigned char *keyName, unsigned char *iv, EVP_CIPHER_CTX *cipherCtx, void *macCtx,
+                          int enc);
+
+    static int contextIndex();
+
+    static int sessionKeyIndex();
+
     void setCertFile(const std::string &certFile) {
         _context.use_certificate_chain_file(certFile);
     }
@@ -165,6 +349,19 @@ protected:
 
     bool _serverSide;
     SSLContextType _context;
+    std::mutex _sessionLock;
+    std::unordered_map<std::string, SessionEntry> _sessions;
+    SessionOrder _sessionOrder;
+    size_t _sessionCacheSize{0};
+    std::deque<TicketKey> _ticketKeys;
+    Duration _ticketKeyLifetime{0};
+    std::atomic<size_t> _handshakes{0};
+    std::atomic<size_t> _resumedHandshakes{0};
+    std::atomic<size_t> _flushes{0};
+    std::atomic<size_t> _records{0};
+    std::atomic<size_t> _recordBytes{0};
+    bool _kernelTLS{false};
+    bool _dynamicRecordSize{true};
 };
 
 
@@ -194,6 +391,40 @@ public:
         }
         return boost::all(port, boost::is_digit());
     }
+
+    static bool isKernelTLSAvailable();
+
+    static unsigned short getServicePort(const std::string &port, const char *protocol="tcp");
+
+    static unsigned short getServicePort(const std::string &port, boost::system::error_code &ec,
+                                         const char *protocol="tcp");
+
+    /// Alternate address families (RFC 8305, section 4), starting with the family of the first endpoint
+    template <typename EndpointT>
+    static std::vector<EndpointT> interleaveEndpoints(const std::vector<EndpointT> &endpoints) {
+        if (endpoints.size() < 2) {
+            return endpoints;
+        }
+        bool firstV6 = endpoints.front().address().is_v6();
+        std::vector<EndpointT> primary, secondary, results;
+        for (auto &endpoint: endpoints) {
+            if (endpoint.address().is_v6() == firstV6) {
+                primary.push_back(endpoint);
+            } else {
+                secondary.push_back(endpoint);
+            }
+        }
+        results.reserve(endpoints.size());
+        for (size_t i = 0; i < primary.size() || i < secondary.size(); ++i) {
+            if (i < primary.size()) {
+                results.push_back(primary[i]);
+            }
+            if (i < secondary.size()) {
+                results.push_back(secondary[i]);
+            }
+        }
+        return results;
+    }
 };
 
 class NET4CXX_COMMON_API Address {
@@ -289,6 +520,7 @@ protected:
         _timer.async_wait([callback = std::forward<CallbackT>(callback), timeout = shared_from_this()](
                 const boost::system::error_code &ec) {
             if (!ec) {
+                Histogram::Timer timer(gReactorHandlerTime);
                 callback();
             }
         });
@@ -325,6 +557,23 @@ protected:
 };
 
 
+struct NET4CXX_COMMON_API ConnectionStats {
+    size_t bytesReceived{0};
+    size_t bytesSent{0};
+    size_t readCount{0};
+    size_t writeCount{0};
+    size_t queuedBytes{0};
+    size_t maxQueuedBytes{0};
+    /// Time with an asynchronous write outstanding, i.e. waiting for room in the socket send buffer
+    Duration blockedTime{0};
+
+    /// Adds the cumulative counters only, the queue depth and its high-water mark describe a live connection
+    void accumulate(const ConnectionStats &rhs);
+
+    ConnectionStats& operator+=(const ConnectionStats &rhs);
+};
+
+
 class NET4CXX_COMMON_API Connection {
 public:
     Connection(const ProtocolPtr &protocol, Reactor *reactor)
@@ -337,6 +586,11 @@ public:
 
     virtual void write(const Byte *data, size_t length) = 0;
 
+    /// Queues the buffer's active region, stream transports take the buffer over instead of copying it
+    virtual void write(MessageBuffer &&data) {
+        write(data.getReadPointer(), data.getActiveSize());
+    }
+
     virtual void loseConnection() = 0;
 
     virtual void abortConnection() = 0;
@@ -360,15 +614,52 @@ public:
     Reactor* reactor() {
         return _reactor;
     }
+
+    const ConnectionStats& getStats() const {
+        return _stats;
+    }
+
+    bool isDisconnecting() const {
+        return _disconnecting || _disconnected;
+    }
 protected:
     void dataReceived(Byte *data, size_t length);
 
     void connectionLost(std::exception_ptr reason);
 
+    void writeQueued(size_t length) {
+        if (_writeQueue.size() == 1) {
+            _writeQueuedTime = TimestampClock::now();
+        }
+        _stats.queuedBytes += length;
+        _stats.maxQueuedBytes = std::max(_stats.maxQueuedBytes, _stats.queuedBytes);
+    }
+
+    void writeDrained() {
+        gWriteQueueWaitTime->recordDuration(TimestampClock::now() - _writeQueuedTime);
+    }
+
+    void writeBlocked() {
+        _writeBlockedTime = TimestampClock::now();
+    }
+
+    void writeUnblocked() {
+        _stats.blockedTime += TimestampClock::now() - _writeBlockedTime;
+    }
+
+    void writeCompleted(size_t length) {
+        _stats.bytesSent += length;
+        _stats.queuedBytes -= std::min(length, _stats.queuedBytes);
+        ++_stats.writeCount;
+    }
+
     std::weak_ptr<Protocol> _protocol;
     Reactor *_reactor{nullptr};
     MessageBuffer _readBuffer;
     std::deque<MessageBuffer> _writeQueue;
+    Timestamp _writeQueuedTime;
+    Timestamp _writeBlockedTime;
+    ConnectionStats _stats;
     bool _reading{false};
     bool _writing{false};
     bool _connected{false};
@@ -424,6 +715,140 @@ protected:
 using ConnectorPtr = std::shared_ptr<Connector>;
 
 
+/// Staggered connection attempts over resolved endpoints (RFC 8305), shared by the stream connectors.
+/// ConnectorT provides isConnecting(), makeTransport(exclusiveBind, ec) and cbConnect(ec, connection).
+template <typename ConnectorT, typename ConnectionT>
+class ConnectAttempts {
+public:
+    using EndpointType = boost::asio::ip::tcp::endpoint;
+    using EndpointList = std::vector<EndpointType>;
+    using ConnectionPtrType = std::shared_ptr<ConnectionT>;
+
+    ConnectAttempts(ConnectorT *connector, Histogram *connectTime)
+            : _connector(connector)
+            , _connectTime(connectTime) {
+
+    }
+
+    void start(const EndpointList &endpoints) {
+        _endpoints = NetUtil::interleaveEndpoints(endpoints);
+        _nextEndpoint = 0;
+        _connectAttempts = 0;
+        _connectStart = TimestampClock::now();
+        startAttempt();
+    }
+
+    /// Closes the pending attempts, their completions still arrive with operation_aborted
+    void abort() {
+        cancelAttemptDelay();
+        _endpoints.clear();
+        for (auto &attempt: _attempts) {
+            boost::system::error_code ec;
+            attempt->getSocket().lowest_layer().close(ec);
+        }
+    }
+
+    void clear() {
+        abort();
+        _nextEndpoint = 0;
+        _attempts.clear();
+    }
+
+    bool empty() const {
+        return _attempts.empty();
+    }
+
+    void setAttemptDelay(double attemptDelay) {
+        _attemptDelay = attemptDelay;
+    }
+
+    double getAttemptDelay() const {
+        return _attemptDelay;
+    }
+
+    Duration getConnectDuration() const {
+        return _connectDuration;
+    }
+
+    size_t getConnectAttempts() const {
+        return _connectAttempts;
+    }
+protected:
+    void cancelAttemptDelay() {
+        if (!_attemptId.cancelled()) {
+            _attemptId.cancel();
+        }
+    }
+
+    void startAttempt() {
+        const EndpointType &endpoint = _endpoints[_nextEndpoint++];
+        auto self = _connector->shared_from_this();
+        boost::system::error_code ec;
+        // Only an attempt racing no other may take the configured local port, the rest bind an ephemeral one
+        auto connection = _connector->makeTransport(_attempts.empty(), ec);
+        _attempts.push_back(connection);
+        ++_connectAttempts;
+        if (ec) {
+            _connector->reactor()->addCallback([this, self, connection, ec]() {
+                cbAttempt(ec, connection);
+            });
+        } else {
+            connection->getSocket().lowest_layer().async_connect(endpoint, [this, self, connection](
+                    const boost::system::error_code &ec) {
+                cbAttempt(ec, connection);
+            });
+        }
+        if (_nextEndpoint < _endpoints.size()) {
+            _attemptId = _connector->reactor()->callLater(_attemptDelay, [this, self]() {
+                if (_connector->isConnecting() && _nextEndpoint < _endpoints.size()) {
+                    startAttempt();
+                }
+            });
+        }
+    }
+
+    void cbAttempt(const boost::system::error_code &ec, ConnectionPtrType connection) {
+        auto iter = std::find(_attempts.begin(), _attempts.end(), connection);
+        if (iter == _attempts.end()) {
+            return;
+        }
+        _attempts.erase(iter);
+        if (!ec) {
+            _connectDuration = TimestampClock::now() - _connectStart;
+            _connectTime->recordDuration(_connectDuration);
+            NET4CXX_LOG_DEBUG(gGenLog, "Connected to %s:%u after %d attempt(s) in %dms",
+                              connection->getRemoteAddress().c_str(), (unsigned)connection->getRemotePort(),
+                              (int)_connectAttempts,
+                              (int)std::chrono::duration_cast<std::chrono::milliseconds>(_connectDuration).count());
+            clear();
+            _connector->cbConnect(ec, std::move(connection));
+            return;
+        }
+        if (ec != boost::asio::error::operation_aborted && _connector->isConnecting() &&
+            _nextEndpoint < _endpoints.size()) {
+            cancelAttemptDelay();
+            startAttempt();
+            return;
+        }
+        if (!_attempts.empty()) {
+            return;
+        }
+        _connector->cbConnect(ec, std::move(connection));
+    }
+
+    ConnectorT *_connector;
+    Histogram *_connectTime;
+    std::vector<ConnectionPtrType> _attempts;
+    EndpointList _endpoints;
+    size_t _nextEndpoint{0};
+    double _attemptDelay{0.25};
+    DelayedCall _attemptId;
+    Timestamp _connectStart;
+    Duration _connectDuration{0};
+    size_t _connectAttempts{0};
+};
+
+
 class NET4CXX_COMMON_API DatagramConnection {
 public:
     DatagramConnection(Address bindAddress, const DatagramProtocolPtr &protocol, size_t maxPacketSize, Reactor *reactor)
@@ -0,0 +1,202 @@
+//
+// Created by agent on 26-10-19.
+//
+
+#include "net4cxx/core/network/basic.h"
+#include "net4cxx/common/global/loggers.h"
+
+
+NS_BEGIN
+
+void BufferedReceiver::dataReceived(Byte *data, size_t length) {
+    if (stopped()) {
+        return;
+    }
+    if (_buffer.getActiveSize() == 0) {
+        size_t consumed = processFrames(data, length);
+        if (consumed != length && !stopped()) {
+            _buffer.reset();
+            _buffer.ensureFreeSpace(length - consumed);
+            _buffer.write(data + consumed, length - consumed);
+        }
+    } else {
+        _buffer.normalize();
+        _buffer.ensureFreeSpace(length);
+        _buffer.write(data, length);
+        _buffer.readCompleted(processFrames(_buffer.getReadPointer(), _buffer.getActiveSize()));
+        if (_buffer.getActiveSize() == 0 || stopped()) {
+            _buffer.reset();
+        }
+    }
+}
+
+
+const size_t LineReceiver::defaultMaxLength;
+
+void LineReceiver::rawDataReceived(boost::string_ref data) {
+    NET4CXX_THROW_EXCEPTION(NotImplementedError, "rawDataReceived");
+}
+
+void LineReceiver::lineLengthExceeded(boost::string_ref line) {
+    loseConnection();
+}
+
+void LineReceiver::sendLine(boost::string_ref line) {
+    ByteArray buffer(line.size() + _delimiter.size());
+    memcpy(buffer.data(), line.data(), line.size());
+    memcpy(buffer.data() + line.size(), _delimiter.data(), _delimiter.size());
+    write(std::move(buffer));
+}
+
+size_t LineReceiver::processFrames(const Byte *data, size_t length) {
+    auto begin = (const char *)data, end = begin + length, cursor = begin;
+    while (cursor != end && !stopped()) {
+        if (!_lineMode) {
+            _scanned = 0;
+            rawDataReceived(boost::string_ref(cursor, (size_t)(end - cursor)));
+            return length;
+        }
+        // A kept partial line was already searched, only its last bytes can start a delimiter
+        auto from = cursor;
+        if (_scanned >= _delimiter.size()) {
+            from += _scanned - _delimiter.size() + 1;
+        }
+        auto found = findDelimiter(from, end);
+        if (!found) {
+            _scanned = (size_t)(end - cursor);
+            if (_scanned > _maxLength) {
+                _brokenPeer = true;
+                lineLengthExceeded(boost::string_ref(cursor, _scanned));
+            }
+            break;
+        }
+        _scanned = 0;
+        boost::string_ref line(cursor, (size_t)(found - cursor));
+        cursor = found + _delimiter.size();
+        if (line.size() > _maxLength) {
+            _brokenPeer = true;
+            lineLengthExceeded(line);
+            break;
+        }
+        lineReceived(line);
+    }
+    return stopped() ? length : (size_t)(cursor - begin);
+}
+
+const char* LineReceiver::findDelimiter(const char *begin, const char *end) const {
+    size_t size = _delimiter.size();
+    if ((size_t)(end - begin) < size) {
+        return nullptr;
+    }
+    // memchr is vectorized by the C library, the rest of the delimiter is only compared on a hit
+    char last = _delimiter.back();
+    for (auto cursor = begin + size - 1; cursor != end; ++cursor) {
+        cursor = (const char *)memchr(cursor, last, (size_t)(end - cursor));
+        if (!cursor) {
+            return nullptr;
+        }
+        if (size == 1 || memcmp(cursor - size + 1, _delimiter.data(), size - 1) == 0) {
+            return cursor - size + 1;
+        }
+    }
+    return nullptr;
+}
+
+
+const size_t IntNStringReceiver::defaultMaxLength;
+
+void IntNStringReceiver::lengthLimitExceeded(size_t length) {
+    loseConnection();
+}
+
+void IntNStringReceiver::sendString(boost::string_ref data) {
+    if (_prefixLength < sizeof(uint32_t) ? data.size() >> (_prefixLength * 8) != 0 : data.size() > UINT32_MAX) {
+        NET4CXX_THROW_EXCEPTION(ValueError, "String of " + std::to_string(data.size()) +
+                                            " bytes does not fit a " + std::to_string(_prefixLength) +
+                                            " byte length prefix");
+    }
+    ByteArray buffer(_prefixLength + data.size());
+    size_t size = data.size();
+    for (size_t i = _prefixLength; i != 0; --i) {
+        buffer[i - 1] = (Byte)(size & 0xff);
+        size >>= 8;
+    }
+    memcpy(buffer.data() + _prefixLength, data.data(), data.size());
+    write(std::move(buffer));
+}
+
+size_t IntNStringReceiver::processFrames(const Byte *data, size_t length) {
+    size_t offset = 0;
+    while (length - offset >= _prefixLength && !stopped()) {
+        size_t frameSize = 0;
+        for (size_t i = 0; i != _prefixLength; ++i) {
+            frameSize = (frameSize << 8) | data[offset + i];
+        }
+        if (frameSize > _maxLength) {
+            _brokenPeer = true;
+            lengthLimitExceeded(frameSize);
+            break;
+        }
+        if (length - offset - _prefixLength < frameSize) {
+            break;
+        }
+        stringReceived(boost::string_ref((const char *)data + offset + _prefixLength, frameSize));
+        offset += _prefixLength + frameSize;
+    }
+    return stopped() ? length : offset;
+}
+
+
+const size_t NetstringReceiver::defaultMaxLength;
+
+void NetstringReceiver::sendString(boost::string_ref data) {
+    auto prefix = std::to_string(data.size()) + ':';
+    ByteArray buffer(prefix.size() + data.size() + 1);
+    memcpy(buffer.data(), prefix.data(), prefix.size());
+    memcpy(buffer.data() + prefix.size(), data.data(), data.size());
+    buffer.back() = ',';
+    write(std::move(buffer));
+}
+
+size_t NetstringReceiver::processFrames(const Byte *data, size_t length) {
+    auto begin = (const char *)data, end = begin + length, cursor = begin;
+    size_t maxDigits = std::to_string(_maxLength).size();
+    while (cursor != end && !stopped()) {
+        auto digits = cursor;
+        size_t size = 0;
+        while (digits != end && isdigit((unsigned char)*digits) && (size_t)(digits - cursor) < maxDigits) {
+            size = size * 10 + (size_t)(*digits - '0');
+            ++digits;
+        }
+        if (digits == end) {
+            break;
+        }
+        if (*digits != ':' || digits == cursor || (*cursor == '0' && digits - cursor > 1)) {
+            handleParseError("Invalid netstring length");
+            break;
+        }
+        if (size > _maxLength) {
+            handleParseError("Netstring too long");
+            break;
+        }
+        auto payload = digits + 1;
+        if ((size_t)(end - payload) <= size) {
+            break;
+        }
+        if (payload[size] != ',') {
+            handleParseError("Missing netstring terminator");
+            break;
+        }
+        stringReceived(boost::string_ref(payload, size));
+        cursor = payload + size + 1;
+    }
+    return stopped() ? length : (size_t)(cursor - begin);
+}
+
+void NetstringReceiver::handleParseError(const char *reason) {
+    NET4CXX_LOG_WARN(gGenLog, "Netstring parse error: %s", reason);
+    _brokenPeer = true;
+    loseConnection();
+}
+
+NS_END
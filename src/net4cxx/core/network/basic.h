@@ -0,0 +1,180 @@
+//
+// Created by agent on 26-10-19.
+//
+
+#ifndef NET4CXX_CORE_NETWORK_BASIC_H
+#define NET4CXX_CORE_NETWORK_BASIC_H
+
+#include "net4cxx/common/common.h"
+#include <boost/utility/string_ref.hpp>
+#include "net4cxx/common/utilities/messagebuffer.h"
+#include "net4cxx/core/network/protocol.h"
+
+
+NS_BEGIN
+
+/// Parses frames straight from the data handed to dataReceived, only a trailing partial frame is copied
+class NET4CXX_COMMON_API BufferedReceiver: public Protocol {
+public:
+    void dataReceived(Byte *data, size_t length) override;
+protected:
+    /// Delivers the complete frames at the front of data and returns how many bytes they took
+    virtual size_t processFrames(const Byte *data, size_t length) = 0;
+
+    /// True once the transport is closing or the stream is broken, frames still buffered are dropped
+    bool stopped() const {
+        return _brokenPeer || (_transport && _transport->isDisconnecting());
+    }
+
+    MessageBuffer _buffer{0};
+    /// Set on a framing violation, the stream cannot be resynchronized so all further input is discarded
+    bool _brokenPeer{false};
+};
+
+
+class NET4CXX_COMMON_API LineReceiver: public BufferedReceiver {
+public:
+    static const size_t defaultMaxLength = 16384;
+
+    /// The view is only valid during the call
+    virtual void lineReceived(boost::string_ref line) = 0;
+
+    /// Called in raw mode instead of lineReceived
+    virtual void rawDataReceived(boost::string_ref data);
+
+    /// Closes the connection by default, line holds as much of the line as has arrived. Further input is discarded.
+    virtual void lineLengthExceeded(boost::string_ref line);
+
+    void sendLine(boost::string_ref line);
+
+    /// Called from rawDataReceived, takes effect from the next read
+    void setLineMode() {
+        _lineMode = true;
+    }
+
+    /// Called from lineReceived, the rest of the current read already goes to rawDataReceived
+    void setRawMode() {
+        _lineMode = false;
+    }
+
+    void setDelimiter(std::string delimiter) {
+        NET4CXX_ASSERT(!delimiter.empty());
+        _delimiter = std::move(delimiter);
+        _scanned = 0;
+    }
+
+    const std::string& getDelimiter() const {
+        return _delimiter;
+    }
+
+    void setMaxLength(size_t maxLength) {
+        _maxLength = maxLength;
+    }
+
+    size_t getMaxLength() const {
+        return _maxLength;
+    }
+protected:
+    size_t processFrames(const Byte *data, size_t length) override;
+
+    const char* findDelimiter(const char *begin, const char *end) const;
+
+    std::string _delimiter{"\r\n"};
+    size_t _maxLength{defaultMaxLength};
+    size_t _scanned{0};
+    bool _lineMode{true};
+};
+
+
+/// Strings prefixed with their length as a big-endian unsigned integer of prefixLength bytes
+class NET4CXX_COMMON_API IntNStringReceiver: public BufferedReceiver {
+public:
+    static const size_t defaultMaxLength = 99999;
+
+    explicit IntNStringReceiver(size_t prefixLength)
+            : _prefixLength(prefixLength) {
+        NET4CXX_ASSERT(prefixLength == 1 || prefixLength == 2 || prefixLength == 4);
+    }
+
+    /// The view is only valid during the call
+    virtual void stringReceived(boost::string_ref data) = 0;
+
+    /// Closes the connection by default, further input is discarded
+    virtual void lengthLimitExceeded(size_t length);
+
+    void sendString(boost::string_ref data);
+
+    void setMaxLength(size_t maxLength) {
+        _maxLength = maxLength;
+    }
+
+    size_t getMaxLength() const {
+        return _maxLength;
+    }
+
+    size_t getPrefixLength() const {
+        return _prefixLength;
+    }
+protected:
+    size_t processFrames(const Byte *data, size_t length) override;
+
+    size_t _prefixLength;
+    size_t _maxLength{defaultMaxLength};
+};
+
+
+class NET4CXX_COMMON_API Int8StringReceiver: public IntNStringReceiver {
+public:
+    Int8StringReceiver()
+            : IntNStringReceiver(1) {
+
+    }
+};
+
+
+class NET4CXX_COMMON_API Int16StringReceiver: public IntNStringReceiver {
+public:
+    Int16StringReceiver()
+            : IntNStringReceiver(2) {
+
+    }
+};
+
+
+class NET4CXX_COMMON_API Int32StringReceiver: public IntNStringReceiver {
+public:
+    Int32StringReceiver()
+            : IntNStringReceiver(4) {
+
+    }
+};
+
+
+/// http://cr.yp.to/proto/netstrings.txt, a malformed netstring closes the connection
+class NET4CXX_COMMON_API NetstringReceiver: public BufferedReceiver {
+public:
+    static const size_t defaultMaxLength = 99999;
+
+    /// The view is only valid during the call
+    virtual void stringReceived(boost::string_ref data) = 0;
+
+    void sendString(boost::string_ref data);
+
+    void setMaxLength(size_t maxLength) {
+        _maxLength = maxLength;
+    }
+
+    size_t getMaxLength() const {
+        return _maxLength;
+    }
+protected:
+    size_t processFrames(const Byte *data, size_t length) override;
+
+    void handleParseError(const char *reason);
+
+    size_t _maxLength{defaultMaxLength};
+};
+
+NS_END
+
+#endif //NET4CXX_CORE_NETWORK_BASIC_H
@@ -7,17 +7,18 @@
 #include "net4cxx/common/utilities/strutil.h"
 #include "net4cxx/core/network/protocol.h"
 #include "net4cxx/core/network/reactor.h"
+#include "net4cxx/core/network/ssl.h"
 
 
 NS_BEGIN
 
 ListenerPtr TCPServerEndpoint::listen(std::shared_ptr<Factory> protocolFactory) const {
-    return _reactor->listenTCP(_port, std::move(protocolFactory), _interface);
+    return _reactor->listenTCP(_port, std::move(protocolFactory), _interface, _listenParams);
 }
 
 
 ListenerPtr SSLServerEndpoint::listen(std::shared_ptr<Factory> protocolFactory) const {
-    return _reactor->listenSSL(_port, std::move(protocolFactory), _sslOption, _interface);
+    return _reactor->listenSSL(_port, std::move(protocolFactory), _sslOption, _interface, _handshakePool);
 }
 
 #ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
@@ -34,7 +35,21 @@ ServerEndpointPtr _parseTCP(Reactor *reactor, const StringVector &args, const St
     if (params.find("interface") != params.end()) {
         interface = params.at("interface");
     }
-    return std::make_shared<TCPServerEndpoint>(reactor, port, std::move(interface));
+    ListenParams listenParams;
+    decltype(params.begin()) iter;
+    if ((iter = params.find("backlog")) != params.end()) {
+        listenParams.setBacklog(std::stoi(iter->second));
+    }
+    if ((iter = params.find("acceptCount")) != params.end()) {
+        listenParams.setAcceptCount(std::stoul(iter->second));
+    }
+    if ((iter = params.find("maxAcceptsPerCall")) != params.end()) {
+        listenParams.setMaxAcceptsPerCall(std::stoul(iter->second));
+    }
+    if ((iter = params.find("deferAccept")) != params.end()) {
+        listenParams.setDeferAccept(std::stoi(iter->second));
+    }
+    return std::make_shared<TCPServerEndpoint>(reactor, port, std::move(interface), std::move(listenParams));
 }
 
 ServerEndpointPtr _parseSSL(Reactor *reactor, const StringVector &args, const StringMap &params) {
@@ -52,7 +67,18 @@ ServerEndpointPtr _parseSSL(Reactor *reactor, const StringVector &args, const St
     if (!certKey.empty()) {
         sslParams.setCertFile(certKey);
     }
-    return std::make_shared<SSLServerEndpoint>(reactor, port, SSLOption::create(sslParams), std::move(interface));
+    HandshakePoolPtr handshakePool;
+    decltype(params.begin()) iter;
+    if ((iter = params.find("handshakeThreads")) != params.end()) {
+        size_t maxPending = 1024;
+        auto maxPendingIter = params.find("maxPendingHandshakes");
+        if (maxPendingIter != params.end()) {
+            maxPending = std::stoul(maxPendingIter->second);
+        }
+        handshakePool = HandshakePool::create(std::stoul(iter->second), maxPending);
+    }
+    return std::make_shared<SSLServerEndpoint>(reactor, port, SSLOption::create(sslParams), std::move(interface),
+                                               std::move(handshakePool));
 }
 
 #ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
@@ -44,10 +44,11 @@ using ServerEndpointPtr = std::shared_ptr<ServerEndpoint>;
 
 class NET4CXX_COMMON_API TCPServerEndpoint: public ServerEndpoint {
 public:
-    TCPServerEndpoint(Reactor *reactor, std::string port, std::string interface={})
+    TCPServerEndpoint(Reactor *reactor, std::string port, std::string interface={}, ListenParams listenParams={})
             : ServerEndpoint(reactor)
             , _port(std::move(port))
-            , _interface(std::move(interface)) {
+            , _interface(std::move(interface))
+            , _listenParams(std::move(listenParams)) {
 
     }
 
@@ -55,16 +56,19 @@ public:
 protected:
     std::string _port;
     std::string _interface;
+    ListenParams _listenParams;
 };
 
 
 class NET4CXX_COMMON_API SSLServerEndpoint: public ServerEndpoint {
 public:
-    SSLServerEndpoint(Reactor *reactor, std::string port, SSLOptionPtr sslOption, std::string interface={})
+    SSLServerEndpoint(Reactor *reactor, std::string port, SSLOptionPtr sslOption, std::string interface={},
+                      HandshakePoolPtr handshakePool={})
             : ServerEndpoint(reactor)
             , _port(std::move(port))
             , _interface(std::move(interface))
-            , _sslOption(std::move(sslOption)) {
+            , _sslOption(std::move(sslOption))
+            , _handshakePool(std::move(handshakePool)) {
 
     }
 
@@ -73,6 +77,7 @@ protected:
     std::string _port;
     std::string _interface;
     SSLOptionPtr _sslOption;
+    HandshakePoolPtr _handshakePool;
 };
 
 
@@ -99,7 +104,9 @@ protected:
 /// \param description
 ///     tcp:80
 ///     tcp:80:interface=127.0.0.1
+///     tcp:80:backlog=1024:acceptCount=4:maxAcceptsPerCall=64:deferAccept=5
 ///     ssl:443:privateKey=key.pem:certKey=crt.pem
+///     ssl:443:privateKey=key.pem:certKey=crt.pem:handshakeThreads=4:maxPendingHandshakes=1024
 ///     unix:/var/run/finger
 /// \return
 NET4CXX_COMMON_API ServerEndpointPtr serverFromString(Reactor *reactor, const std::string &description);
@@ -0,0 +1,223 @@
+//
+// Created by agent on 26-10-18.
+//
+
+#include "net4cxx/core/network/metricsserver.h"
+#include "net4cxx/common/debugging/watcher.h"
+#include "net4cxx/common/utilities/strutil.h"
+
+
+NS_BEGIN
+
+const char *PrometheusFormat::contentType = "text/plain; version=0.0.4; charset=utf-8";
+
+std::string PrometheusFormat::metricName(const std::string &name) {
+    std::string result(name);
+    for (auto &c: result) {
+        if (!isalnum((unsigned char)c) && c != '_' && c != ':') {
+            c = '_';
+        }
+    }
+    if (result.empty() || isdigit((unsigned char)result[0])) {
+        result.insert(result.begin(), '_');
+    }
+    return result;
+}
+
+std::string PrometheusFormat::escapeHelp(const std::string &help) {
+    std::string result;
+    result.reserve(help.size());
+    for (auto c: help) {
+        if (c == '\\') {
+            result += "\\\\";
+        } else if (c == '\n') {
+            result += "\\n";
+        } else {
+            result.push_back(c);
+        }
+    }
+    return result;
+}
+
+std::string PrometheusFormat::escapeLabel(const std::string &value) {
+    std::string result;
+    result.reserve(value.size());
+    for (auto c: value) {
+        if (c == '\\') {
+            result += "\\\\";
+        } else if (c == '\n') {
+            result += "\\n";
+        } else if (c == '"') {
+            result += "\\\"";
+        } else {
+            result.push_back(c);
+        }
+    }
+    return result;
+}
+
+void PrometheusFormat::writeHeader(std::string &out, const std::string &name, const std::string &help,
+                                   const char *type) {
+    if (!help.empty()) {
+        out += "# HELP " + name + " " + escapeHelp(help) + "\n";
+    }
+    out += "# TYPE " + name + " " + type + "\n";
+}
+
+void PrometheusFormat::writeMetric(std::string &out, const Metric *metric) {
+    std::string name = metricName(metric->getName());
+    switch (metric->getType()) {
+        case MetricType::Counter: {
+            if (!boost::ends_with(name, "_total")) {
+                name += "_total";
+            }
+            writeHeader(out, name, metric->getHelp(), "counter");
+            out += name + " " + std::to_string(metric->value()) + "\n";
+            break;
+        }
+        case MetricType::Gauge: {
+            writeHeader(out, name, metric->getHelp(), "gauge");
+            out += name + " " + std::to_string(metric->value()) + "\n";
+            break;
+        }
+        case MetricType::Histogram: {
+            auto snapshot = static_cast<const Histogram *>(metric)->snapshot();
+            writeHeader(out, name, metric->getHelp(), "summary");
+            for (auto quantile: {"0.5", "0.9", "0.99", "0.999"}) {
+                out += name + "{quantile=\"" + quantile + "\"} " +
+                       std::to_string(snapshot.percentile(std::stod(quantile))) + "\n";
+            }
+            out += name + "_sum " + std::to_string(snapshot.getSum()) + "\n";
+            out += name + "_count " + std::to_string(snapshot.getCount()) + "\n";
+            break;
+        }
+    }
+}
+
+
+const size_t MetricsProtocol::maxRequestSize;
+
+const size_t MetricsProtocol::batchSize;
+
+void MetricsProtocol::dataReceived(Byte *data, size_t length) {
+    if (_responding) {
+        return;
+    }
+    _request.append((const char *)data, length);
+    auto end = _request.find("\r\n\r\n");
+    if (end == std::string::npos) {
+        end = _request.find("\n\n");
+    }
+    if (end == std::string::npos) {
+        if (_request.size() > maxRequestSize) {
+            sendError("431 Request Header Fields Too Large");
+        }
+        return;
+    }
+    _responding = true;
+    auto lineEnd = _request.find_first_of("\r\n");
+    handleRequest(_request.substr(0, lineEnd));
+    _request.clear();
+}
+
+void MetricsProtocol::connectionLost(std::exception_ptr reason) {
+    _finished = true;
+    _metrics.clear();
+}
+
+void MetricsProtocol::handleRequest(const std::string &requestLine) {
+    auto parts = StrUtil::split(requestLine, false);
+    if (parts.size() < 2) {
+        sendError("400 Bad Request");
+        return;
+    }
+    if (parts[0] != "GET") {
+        sendError("405 Method Not Allowed");
+        return;
+    }
+    auto path = parts[1].substr(0, parts[1].find('?'));
+    if (path != "/metrics" && path != "/") {
+        sendError("404 Not Found");
+        return;
+    }
+    write(StrUtil::format("HTTP/1.1 200 OK\r\nContent-Type: %s\r\nConnection: close\r\n\r\n",
+                          PrometheusFormat::contentType));
+    _metrics = NET4CXX_MetricsRegistry->getMetrics();
+    _next = 0;
+    renderNext();
+}
+
+void MetricsProtocol::sendError(const char *status) {
+    _responding = true;
+    write(StrUtil::format("HTTP/1.1 %s\r\nContent-Type: text/plain\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+                          status));
+    loseConnection();
+}
+
+void MetricsProtocol::renderNext() {
+    if (_finished) {
+        return;
+    }
+    std::string out;
+    size_t last = std::min(_next + batchSize, _metrics.size());
+    for (; _next != last; ++_next) {
+        PrometheusFormat::writeMetric(out, _metrics[_next]);
+    }
+    if (_next == _metrics.size()) {
+        renderReactor(out);
+        renderWatcher(out);
+        write(out);
+        _finished = true;
+        _metrics.clear();
+        loseConnection();
+        return;
+    }
+    write(out);
+    reactor()->addCallback([self = shared_from_this()]() {
+        self->renderNext();
+    });
+}
+
+void MetricsProtocol::renderReactor(std::string &out) {
+    Reactor *reactor = this->reactor();
+    if (reactor->isLagProbeRunning()) {
+        std::string name = "net4cxx_reactor_loop_lag_seconds";
+        PrometheusFormat::writeHeader(out, name, "Delay between a probe timer's deadline and its callback", "summary");
+        for (auto quantile: {"0.5", "0.9", "0.99"}) {
+            out += name + "{quantile=\"" + quantile + "\"} " +
+                   StrUtil::format("%.6f", reactor->getLoopLag(std::stod(quantile))) + "\n";
+        }
+    }
+    auto factories = reactor->getListenedFactories();
+    if (!factories.empty()) {
+        std::string name = "net4cxx_factory_connections";
+        PrometheusFormat::writeHeader(out, name, "Live connections built by each listening factory", "gauge");
+        for (auto &factory: factories) {
+            auto ptr = factory.second.lock();
+            if (ptr) {
+                out += name + "{listener=\"" + PrometheusFormat::escapeLabel(factory.first) + "\"} " +
+                       std::to_string(ptr->getConnectionCount()) + "\n";
+            }
+        }
+    }
+}
+
+void MetricsProtocol::renderWatcher(std::string &out) {
+    auto objects = NET4CXX_Watcher->getObjects();
+    if (objects.empty()) {
+        return;
+    }
+    std::string name = "net4cxx_watcher_objects";
+    PrometheusFormat::writeHeader(out, name, "Current value of each Watcher key", "gauge");
+    for (auto &object: objects) {
+        out += name + "{key=\"" + PrometheusFormat::escapeLabel(object.first) + "\"} " +
+               std::to_string(object.second) + "\n";
+    }
+}
+
+
+ProtocolPtr MetricsFactory::buildProtocol(const Address &address) {
+    return std::make_shared<MetricsProtocol>();
+}
+
+NS_END
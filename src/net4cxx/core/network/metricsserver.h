@@ -0,0 +1,69 @@
+//
+// Created by agent on 26-10-18.
+//
+
+#ifndef NET4CXX_CORE_NETWORK_METRICSSERVER_H
+#define NET4CXX_CORE_NETWORK_METRICSSERVER_H
+
+#include "net4cxx/common/common.h"
+#include "net4cxx/common/debugging/metrics.h"
+#include "net4cxx/core/network/protocol.h"
+#include "net4cxx/core/network/reactor.h"
+
+
+NS_BEGIN
+
+
+/// Prometheus text exposition format, version 0.0.4
+class NET4CXX_COMMON_API PrometheusFormat {
+public:
+    static const char *contentType;
+
+    static std::string metricName(const std::string &name);
+
+    static std::string escapeHelp(const std::string &help);
+
+    static std::string escapeLabel(const std::string &value);
+
+    static void writeHeader(std::string &out, const std::string &name, const std::string &help, const char *type);
+
+    static void writeMetric(std::string &out, const Metric *metric);
+};
+
+
+/// Answers a single GET per connection, the body is rendered a batch of metrics per reactor turn
+class NET4CXX_COMMON_API MetricsProtocol: public Protocol, public std::enable_shared_from_this<MetricsProtocol> {
+public:
+    static const size_t maxRequestSize = 8192;
+    static const size_t batchSize = 64;
+
+    void dataReceived(Byte *data, size_t length) override;
+
+    void connectionLost(std::exception_ptr reason) override;
+protected:
+    void handleRequest(const std::string &requestLine);
+
+    void sendError(const char *status);
+
+    void renderNext();
+
+    void renderReactor(std::string &out);
+
+    void renderWatcher(std::string &out);
+
+    std::string _request;
+    bool _responding{false};
+    bool _finished{false};
+    std::vector<const Metric *> _metrics;
+    size_t _next{0};
+};
+
+
+class NET4CXX_COMMON_API MetricsFactory: public Factory {
+public:
+    ProtocolPtr buildProtocol(const Address &address) override;
+};
+
+NS_END
+
+#endif //NET4CXX_CORE_NETWORK_METRICSSERVER_H
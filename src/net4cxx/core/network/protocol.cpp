@@ -3,6 +3,7 @@
 //
 
 #include "net4cxx/core/network/protocol.h"
+#include "net4cxx/common/serialization/oarchive.h"
 #include "net4cxx/common/utilities/random.h"
 #include "net4cxx/core/network/reactor.h"
 
@@ -27,6 +28,14 @@ void Factory::doStop() {
     }
 }
 
+ConnectionStats Factory::getAggregatedStats() const {
+    ConnectionStats stats = _closedStats;
+    forEachConnection([&stats](const ConnectionPtr &connection) {
+        stats += connection->getStats();
+    });
+    return stats;
+}
+
 void Factory::startFactory() {
 
 }
@@ -119,6 +128,10 @@ void Protocol::connectionLost(std::exception_ptr reason) {
 
 }
 
+void Protocol::write(OArchive &&archive) {
+    write(archive.move());
+}
+
 
 void DatagramProtocol::startProtocol() {
 
@@ -13,9 +13,14 @@
 
 NS_BEGIN
 
+class OArchive;
+
 
 class NET4CXX_COMMON_API Factory {
 public:
+    friend class Connection;
+    friend class Protocol;
+
     virtual ~Factory() = default;
 
     void doStart();
@@ -27,8 +32,34 @@ public:
     virtual void stopFactory();
 
     virtual ProtocolPtr buildProtocol(const Address &address) = 0;
+
+    size_t getConnectionCount() const {
+        return _connections.size();
+    }
+
+    /// Cumulative counters over live connections and those already closed, queued bytes and their high-water mark
+    /// over live connections only
+    ConnectionStats getAggregatedStats() const;
+
+    /// The callback may close connections, it only sees those that were live when the iteration started
+    template <typename CallbackT>
+    void forEachConnection(CallbackT &&callback) const {
+        std::vector<ConnectionPtr> connections;
+        connections.reserve(_connections.size());
+        for (auto &connection: _connections) {
+            auto transport = connection.second.lock();
+            if (transport) {
+                connections.push_back(std::move(transport));
+            }
+        }
+        for (auto &connection: connections) {
+            callback(connection);
+        }
+    }
 protected:
     int _numPorts{0};
+    std::unordered_map<Connection *, std::weak_ptr<Connection>> _connections;
+    ConnectionStats _closedStats;
 };
 
 
@@ -119,6 +150,10 @@ public:
     void makeConnection(ConnectionPtr transport) {
         _connected = true;
         _transport = std::move(transport);
+        auto factory = _factory.lock();
+        if (factory) {
+            factory->_connections.emplace(_transport.get(), _transport);
+        }
         connectionMade();
     }
 
@@ -135,6 +170,18 @@ public:
         write(data.data(), data.size());
     }
 
+    void write(ByteArray &&data) {
+        write(MessageBuffer(std::move(data)));
+    }
+
+    void write(MessageBuffer &&data) {
+        NET4CXX_ASSERT(_transport);
+        _transport->write(std::move(data));
+    }
+
+    /// Hands the archive's storage to the transport's write queue without copying it
+    void write(OArchive &&archive);
+
     void write(const char *data) {
         write((const Byte *)data, strlen(data));
     }
@@ -193,6 +240,11 @@ public:
         return _transport->getRemotePort();
     }
 
+    const ConnectionStats& getConnectionStats() const {
+        NET4CXX_ASSERT(_transport);
+        return _transport->getStats();
+    }
+
     void setFactory(const std::shared_ptr<Factory> &factory) {
         _factory = factory;
     }
@@ -5,6 +5,7 @@
 #include "net4cxx/core/network/reactor.h"
 #include "net4cxx/common/global/loggers.h"
 #include "net4cxx/common/utilities/random.h"
+#include "net4cxx/core/network/metricsserver.h"
 #include "net4cxx/core/network/protocol.h"
 #include "net4cxx/core/network/ssl.h"
 #include "net4cxx/core/network/tcp.h"
@@ -19,7 +20,12 @@ thread_local Reactor* Reactor::_current = nullptr;
 Reactor::Reactor()
         : _ioService()
         , _signalSet(_ioService) {
+    // Constructed first so that it outlives every reactor, which unregister from it on destruction
+    NET4CXX_ResolverCache;
+}
 
+Reactor::~Reactor() {
+    NET4CXX_ResolverCache->removeReactor(this);
 }
 
 void Reactor::run(bool installSignalHandlers) {
@@ -33,7 +39,11 @@ void Reactor::run(bool installSignalHandlers) {
     Reactor *oldCurrent = _current;
     _current = this;
     WorkType work(_ioService);
+    scheduleSuppressedFlush();
     startRunning(installSignalHandlers);
+    if (!_suppressedFlush.cancelled()) {
+        _suppressedFlush.cancel();
+    }
     _running = false;
     _current = oldCurrent;
 }
@@ -49,10 +59,44 @@ void Reactor::stop() {
     _ioService.stop();
 }
 
+void Reactor::startLagProbe(double interval, size_t sampleCount) {
+    stopLagProbe();
+    _lagInterval = interval;
+    _lagSampleCount = std::max(sampleCount, (size_t)1);
+    _lagSampleIndex = 0;
+    _lagSamples.clear();
+    scheduleLagProbe();
+}
+
+void Reactor::stopLagProbe() {
+    if (!_lagProbe.cancelled()) {
+        _lagProbe.cancel();
+    }
+}
+
+double Reactor::getLoopLag(double percentile) const {
+    if (_lagSamples.empty()) {
+        return 0.0;
+    }
+    std::vector<double> samples(_lagSamples);
+    auto rank = std::min((size_t)(percentile * samples.size()), samples.size() - 1);
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples[rank];
+}
+
+std::vector<Reactor::ListenedFactory> Reactor::getListenedFactories() {
+    _listenedFactories.erase(std::remove_if(_listenedFactories.begin(), _listenedFactories.end(),
+                                            [](const ListenedFactory &factory) {
+        return factory.second.expired();
+    }), _listenedFactories.end());
+    return _listenedFactories;
+}
+
 ListenerPtr Reactor::listenTCP(const std::string &port, std::shared_ptr<Factory> factory,
-                               const std::string &interface) {
-    auto l = std::make_shared<TCPListener>(port, std::move(factory), interface, this);
+                               const std::string &interface, const ListenParams &listenParams) {
+    auto l = std::make_shared<TCPListener>(port, factory, interface, this, listenParams);
     l->startListening();
+    addListenedFactory("tcp:" + port, factory);
     return l;
 }
 
@@ -64,9 +108,11 @@ ConnectorPtr Reactor::connectTCP(const std::string &host, const std::string &por
 }
 
 ListenerPtr Reactor::listenSSL(const std::string &port, std::shared_ptr<Factory> factory, SSLOptionPtr sslOption,
-                               const std::string &interface) {
-    auto l = std::make_shared<SSLListener>(port, std::move(factory), std::move(sslOption), interface, this);
+                               const std::string &interface, HandshakePoolPtr handshakePool) {
+    auto l = std::make_shared<SSLListener>(port, factory, std::move(sslOption), interface, this,
+                                           std::move(handshakePool));
     l->startListening();
+    addListenedFactory("ssl:" + port, factory);
     return l;
 }
 
@@ -79,6 +125,13 @@ ConnectorPtr Reactor::connectSSL(const std::string &host, const std::string &por
     return c;
 }
 
+ListenerPtr Reactor::listenMetrics(const std::string &port, const std::string &interface) {
+    // Not added to the listened factories, the endpoint would otherwise count its own scrapes
+    auto l = std::make_shared<TCPListener>(port, std::make_shared<MetricsFactory>(), interface, this);
+    l->startListening();
+    return l;
+}
+
 DatagramConnectionPtr Reactor::listenUDP(unsigned short port, DatagramProtocolPtr protocol,
                                          const std::string &interface, size_t maxPacketSize, bool listenMultiple) {
     auto l = std::make_shared<UDPConnection>(port, protocol, interface, maxPacketSize, listenMultiple, this);
@@ -96,8 +149,9 @@ DatagramConnectionPtr Reactor::connectUDP(const std::string &address, unsigned s
 #ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
 
 ListenerPtr Reactor::listenUNIX(const std::string &path, std::shared_ptr<Factory> factory) {
-    auto l = std::make_shared<UNIXListener>(path, std::move(factory), this);
+    auto l = std::make_shared<UNIXListener>(path, factory, this);
     l->startListening();
+    addListenedFactory("unix:" + path, factory);
     return l;
 }
 
@@ -123,6 +177,27 @@ DatagramConnectionPtr Reactor::connectUNIXDatagram(const std::string &path, Data
 
 #endif
 
+void Reactor::scheduleLagProbe() {
+    auto expected = TimestampClock::now() + std::chrono::milliseconds(int64_t(_lagInterval * 1000));
+    _lagProbe = callAt(expected, [this, expected]() {
+        double lag = std::chrono::duration<double>(TimestampClock::now() - expected).count();
+        if (_lagSamples.size() < _lagSampleCount) {
+            _lagSamples.push_back(lag);
+        } else {
+            _lagSamples[_lagSampleIndex] = lag;
+        }
+        _lagSampleIndex = (_lagSampleIndex + 1) % _lagSampleCount;
+        scheduleLagProbe();
+    });
+}
+
+void Reactor::scheduleSuppressedFlush() {
+    _suppressedFlush = callLater(1.0, [this]() {
+        LogSiteLimiter::flushSuppressed();
+        scheduleSuppressedFlush();
+    });
+}
+
 void Reactor::startRunning(bool installSignalHandlers) {
     if (installSignalHandlers) {
         _installSignalHandlers = installSignalHandlers;
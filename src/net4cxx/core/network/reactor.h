@@ -24,13 +24,14 @@ public:
     using WorkType = ServiceType::work;
     using SignalSet = boost::asio::signal_set;
     using StopCallbacks = boost::signals2::signal<void ()>;
+    using ListenedFactory = std::pair<std::string, std::weak_ptr<Factory>>;
 
     Reactor(const Reactor&) = delete;
     Reactor& operator=(const Reactor&) = delete;
 
     Reactor();
 
-    ~Reactor() = default;
+    ~Reactor();
 
     void makeCurrent() {
         _current = this;
@@ -68,7 +69,10 @@ public:
 
     template <typename CallbackT>
     void addCallback(CallbackT &&callback) {
-        _ioService.post(std::forward<CallbackT>(callback));
+        _ioService.post([callback = std::forward<CallbackT>(callback)]() mutable {
+            Histogram::Timer timer(gReactorHandlerTime);
+            callback();
+        });
     }
 
     template <typename CallbackT>
@@ -76,13 +80,14 @@ public:
         _stopCallbacks.connect(std::forward<CallbackT>(callback));
     }
 
-    ListenerPtr listenTCP(const std::string &port, std::shared_ptr<Factory> factory, const std::string &interface={});
+    ListenerPtr listenTCP(const std::string &port, std::shared_ptr<Factory> factory, const std::string &interface={},
+                          const ListenParams &listenParams={});
 
     ConnectorPtr connectTCP(const std::string &host, const std::string &port, std::shared_ptr<ClientFactory> factory,
                             double timeout=30.0, const Address &bindAddress={});
 
     ListenerPtr listenSSL(const std::string &port, std::shared_ptr<Factory> factory, SSLOptionPtr sslOption,
-                          const std::string &interface={});
+                          const std::string &interface={}, HandshakePoolPtr handshakePool={});
 
     ConnectorPtr connectSSL(const std::string &host, const std::string &port, std::shared_ptr<ClientFactory> factory,
                             SSLOptionPtr sslOption, double timeout=30.0, const Address &bindAddress={});
@@ -94,6 +99,9 @@ public:
                                      size_t maxPacketSize=8192, const Address &bindAddress={},
                                      bool listenMultiple=false);
 
+    /// Serves the metrics registry, loop lag and per-factory connection counts in Prometheus text format
+    ListenerPtr listenMetrics(const std::string &port, const std::string &interface={});
+
 #ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
     ListenerPtr listenUNIX(const std::string &path, std::shared_ptr<Factory> factory);
 
@@ -123,6 +131,18 @@ public:
 
     void stop();
 
+    void startLagProbe(double interval=0.1, size_t sampleCount=1024);
+
+    void stopLagProbe();
+
+    double getLoopLag(double percentile=0.99) const;
+
+    bool isLagProbeRunning() const {
+        return !_lagProbe.cancelled();
+    }
+
+    std::vector<ListenedFactory> getListenedFactories();
+
     static Reactor *current() {
         return _current;
     }
@@ -145,11 +165,27 @@ protected:
 
     void sigQuit();
 
+    void scheduleLagProbe();
+
+    /// Reports the calls held back by rate-limited log sites that have gone quiet since
+    void scheduleSuppressedFlush();
+
+    void addListenedFactory(std::string endpoint, const std::shared_ptr<Factory> &factory) {
+        _listenedFactories.emplace_back(std::move(endpoint), factory);
+    }
+
     ServiceType _ioService;
     SignalSet _signalSet;
     bool _installSignalHandlers{false};
     volatile bool _running{false};
     StopCallbacks _stopCallbacks;
+    DelayedCall _lagProbe;
+    DelayedCall _suppressedFlush;
+    double _lagInterval{0.1};
+    size_t _lagSampleCount{0};
+    size_t _lagSampleIndex{0};
+    std::vector<double> _lagSamples;
+    std::vector<ListenedFactory> _listenedFactories;
     thread_local static Reactor *_current;
 };
 
@@ -3,15 +3,325 @@
 //
 
 #include "net4cxx/core/network/resolver.h"
+#include <fstream>
+#include <boost/algorithm/string.hpp>
 #include "net4cxx/core/network/reactor.h"
 
 
 NS_BEGIN
 
+const int ResolverCache::maxAbortRetries;
+
+
+ResolverCache::ResolverCache()
+        : _ttl(std::chrono::seconds(60))
+        , _negativeTTL(std::chrono::seconds(5))
+        , _backend(&ResolverCache::defaultBackend) {
+
+}
+
+ResolverCache::~ResolverCache() {
+    if (_thread.joinable()) {
+        _work.reset();
+        _ioService.stop();
+        _thread.join();
+    }
+}
+
+void ResolverCache::resolve(Reactor *reactor, const std::string &host, ResolveCallback callback) {
+    boost::system::error_code ec;
+    auto address = AddressType::from_string(host, ec);
+    if (!ec) {
+        notify(reactor, std::move(callback), ec, {address});
+        return;
+    }
+    auto key = boost::to_lower_copy(host);
+    Backend backend;
+    bool cached = true;
+    uint64_t detachedId = 0;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        auto hostIter = _hosts.find(key);
+        if (hostIter != _hosts.end()) {
+            notify(reactor, std::move(callback), {}, hostIter->second);
+            return;
+        }
+        auto now = TimestampClock::now();
+        auto iter = _entries.find(key);
+        if (iter != _entries.end()) {
+            Entry &entry = iter->second;
+            if (entry.pending) {
+                entry.waiters.emplace_back(Waiter{reactor, std::move(callback)});
+                return;
+            }
+            if (entry.expiration > now) {
+                notify(reactor, std::move(callback), entry.error, entry.addresses);
+                return;
+            }
+        } else if (_entries.size() >= _maxEntries) {
+            cached = makeRoom(now);
+        }
+        if (cached) {
+            Entry &entry = _entries[key];
+            entry.pending = true;
+            entry.aborts = 0;
+            entry.waiters.emplace_back(Waiter{reactor, std::move(callback)});
+        } else {
+            // Every slot holds an in-flight lookup, resolve this one without caching it
+            detachedId = ++_nextDetached;
+            _detached.emplace(detachedId, Waiter{reactor, std::move(callback)});
+        }
+        backend = _backend;
+    }
+    if (!cached) {
+        getService().post([this, backend = std::move(backend), host, detachedId]() {
+            backend(_ioService, host, [this, detachedId](const boost::system::error_code &ec,
+                                                         const AddressList &addresses) {
+                onDetachedResolved(detachedId, ec, addresses);
+            });
+        });
+        return;
+    }
+    startLookup(std::move(backend), host, key);
+}
+
+void ResolverCache::removeReactor(Reactor *reactor) {
+    std::lock_guard<std::mutex> lock(_lock);
+    for (auto &entry: _entries) {
+        auto &waiters = entry.second.waiters;
+        waiters.erase(std::remove_if(waiters.begin(), waiters.end(), [reactor](const Waiter &waiter) {
+            return waiter.reactor == reactor;
+        }), waiters.end());
+    }
+    for (auto iter = _detached.begin(); iter != _detached.end();) {
+        if (iter->second.reactor == reactor) {
+            iter = _detached.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void ResolverCache::addHost(const std::string &host, const std::string &address) {
+    auto addr = AddressType::from_string(address);
+    std::lock_guard<std::mutex> lock(_lock);
+    _hosts[boost::to_lower_copy(host)].emplace_back(std::move(addr));
+}
+
+void ResolverCache::removeHost(const std::string &host) {
+    std::lock_guard<std::mutex> lock(_lock);
+    _hosts.erase(boost::to_lower_copy(host));
+}
+
+void ResolverCache::clearHosts() {
+    std::lock_guard<std::mutex> lock(_lock);
+    _hosts.clear();
+}
+
+void ResolverCache::loadHostsFile(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) {
+        NET4CXX_THROW_EXCEPTION(IOError, "Can't open hosts file: " + path);
+    }
+    std::string line;
+    StringVector fields;
+    boost::system::error_code ec;
+    while (std::getline(file, line)) {
+        auto pos = line.find('#');
+        if (pos != std::string::npos) {
+            line.erase(pos);
+        }
+        boost::trim(line);
+        if (line.empty()) {
+            continue;
+        }
+        boost::split(fields, line, boost::is_space(), boost::token_compress_on);
+        if (fields.size() < 2) {
+            continue;
+        }
+        auto address = AddressType::from_string(fields[0], ec);
+        if (ec) {
+            NET4CXX_LOG_WARN(gGenLog, "Invalid address in hosts file: %s", fields[0].c_str());
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(_lock);
+        for (auto iter = std::next(fields.begin()); iter != fields.end(); ++iter) {
+            _hosts[boost::to_lower_copy(*iter)].emplace_back(address);
+        }
+    }
+}
+
+void ResolverCache::setBackend(Backend backend) {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (backend) {
+        _backend = std::move(backend);
+    } else {
+        _backend = &ResolverCache::defaultBackend;
+    }
+}
+
+void ResolverCache::clear() {
+    std::lock_guard<std::mutex> lock(_lock);
+    for (auto iter = _entries.begin(); iter != _entries.end();) {
+        if (iter->second.pending) {
+            ++iter;
+        } else {
+            iter = _entries.erase(iter);
+        }
+    }
+}
+
+ResolverCache* ResolverCache::instance() {
+    static ResolverCache instance;
+    return &instance;
+}
+
+ResolverCache::ServiceType& ResolverCache::getService() {
+    std::call_once(_started, [this]() {
+        _work = std::make_unique<WorkType>(_ioService);
+        _thread = std::thread([this]() {
+            while (!_ioService.stopped()) {
+                try {
+                    _ioService.run();
+                } catch (std::exception &e) {
+                    NET4CXX_LOG_ERROR(gGenLog, "Unexpected resolver exception:%s", e.what());
+                }
+            }
+        });
+    });
+    return _ioService;
+}
+
+void ResolverCache::startLookup(Backend backend, const std::string &host, const std::string &key) {
+    getService().post([this, backend = std::move(backend), host, key]() {
+        backend(_ioService, host, [this, host, key](const boost::system::error_code &ec,
+                                                    const AddressList &addresses) {
+            onResolved(host, key, ec, addresses);
+        });
+    });
+}
+
+void ResolverCache::onResolved(const std::string &host, const std::string &key, const boost::system::error_code &ec,
+                               const AddressList &addresses) {
+    // Waiters are notified under the lock, so removeReactor guarantees nothing is posted to a reactor afterwards
+    std::lock_guard<std::mutex> lock(_lock);
+    auto iter = _entries.find(key);
+    if (iter == _entries.end()) {
+        return;
+    }
+    Entry &entry = iter->second;
+    boost::system::error_code error = ec;
+    if (ec == boost::asio::error::operation_aborted) {
+        // Nobody waiting on a shared lookup asked for it to stop, try again rather than failing them all
+        if (entry.aborts < maxAbortRetries) {
+            ++entry.aborts;
+            startLookup(_backend, host, key);
+            return;
+        }
+        error = boost::asio::error::host_not_found_try_again;
+    }
+    std::vector<Waiter> waiters;
+    waiters.swap(entry.waiters);
+    if (ec == boost::asio::error::operation_aborted) {
+        _entries.erase(iter);
+    } else {
+        entry.pending = false;
+        entry.error = error;
+        entry.addresses = addresses;
+        entry.expiration = TimestampClock::now() + (error || addresses.empty() ? _negativeTTL : _ttl);
+    }
+    for (auto &waiter: waiters) {
+        notify(waiter.reactor, std::move(waiter.callback), error, addresses);
+    }
+}
+
+void ResolverCache::onDetachedResolved(uint64_t id, const boost::system::error_code &ec,
+                                       const AddressList &addresses) {
+    std::lock_guard<std::mutex> lock(_lock);
+    auto iter = _detached.find(id);
+    if (iter == _detached.end()) {
+        return;
+    }
+    boost::system::error_code error = ec;
+    if (ec == boost::asio::error::operation_aborted) {
+        error = boost::asio::error::host_not_found_try_again;
+    }
+    notify(iter->second.reactor, std::move(iter->second.callback), error, addresses);
+    _detached.erase(iter);
+}
+
+void ResolverCache::purgeExpired(const Timestamp &now) {
+    for (auto iter = _entries.begin(); iter != _entries.end();) {
+        if (!iter->second.pending && iter->second.expiration <= now) {
+            iter = _entries.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+bool ResolverCache::makeRoom(const Timestamp &now) {
+    purgeExpired(now);
+    if (_entries.size() < _maxEntries) {
+        return true;
+    }
+    auto oldest = _entries.end();
+    for (auto iter = _entries.begin(); iter != _entries.end(); ++iter) {
+        if (iter->second.pending) {
+            continue;
+        }
+        if (oldest == _entries.end() || iter->second.expiration < oldest->second.expiration) {
+            oldest = iter;
+        }
+    }
+    if (oldest == _entries.end()) {
+        return false;
+    }
+    _entries.erase(oldest);
+    return true;
+}
+
+void ResolverCache::notify(Reactor *reactor, ResolveCallback callback, const boost::system::error_code &ec,
+                           const AddressList &addresses) {
+    reactor->addCallback([callback = std::move(callback), ec, addresses]() {
+        callback(ec, addresses);
+    });
+}
+
+void ResolverCache::defaultBackend(ServiceType &service, const std::string &host, ResolveCallback callback) {
+    using ResolverType = boost::asio::ip::tcp::resolver;
+    auto resolver = std::make_shared<ResolverType>(service);
+    ResolverType::query query(host, "");
+    resolver->async_resolve(query, [resolver, callback = std::move(callback)](const boost::system::error_code &ec,
+                                                                              ResolverType::iterator iterator) {
+        AddressList addresses;
+        if (!ec) {
+            ResolverType::iterator end;
+            for (; iterator != end; ++iterator) {
+                auto address = iterator->endpoint().address();
+                if (std::find(addresses.begin(), addresses.end(), address) == addresses.end()) {
+                    addresses.emplace_back(std::move(address));
+                }
+            }
+        }
+        callback(ec, addresses);
+    });
+}
+
 
 Resolver::Resolver(Reactor *reactor)
-        : _resolver(reactor->getService()){
+        : _reactor(reactor) {
+
+}
 
+void Resolver::resolveAddresses(const std::string &host, ResolveCallback callback) {
+    NET4CXX_ResolverCache->resolve(_reactor, host, [resolver = shared_from_this(), callback = std::move(callback)](
+            const boost::system::error_code &ec, const AddressList &addresses) {
+        if (resolver->_cancelled) {
+            return;
+        }
+        callback(ec, addresses);
+    });
 }
 
 
@@ -24,4 +334,4 @@ void DelayedResolve::cancel() {
 }
 
 
-NS_END
\ No newline at end of file
+NS_END
@@ -7,52 +7,161 @@
 
 #include "net4cxx/common/common.h"
 #include "net4cxx/common/global/loggers.h"
+#include <mutex>
+#include <thread>
 #include <boost/asio.hpp>
 
 NS_BEGIN
 
 class Reactor;
 
+
+/// Lookups run on an io_service owned by the cache, so a lookup shared by several reactors does not depend on the
+/// one that started it. Results are posted back to each requesting reactor.
+class NET4CXX_COMMON_API ResolverCache {
+public:
+    using AddressType = boost::asio::ip::address;
+    using AddressList = std::vector<AddressType>;
+    using ResolveCallback = std::function<void (const boost::system::error_code &, const AddressList &)>;
+    using ServiceType = boost::asio::io_service;
+    using WorkType = ServiceType::work;
+    /// Runs on the cache's io_service and must eventually call the callback exactly once
+    using Backend = std::function<void (ServiceType &, const std::string &, ResolveCallback)>;
+
+    static const int maxAbortRetries = 1;
+
+    ResolverCache();
+    ResolverCache(const ResolverCache&) = delete;
+    ResolverCache& operator=(const ResolverCache&) = delete;
+    ~ResolverCache();
+
+    void resolve(Reactor *reactor, const std::string &host, ResolveCallback callback);
+
+    /// Drops every callback still owed to reactor, called when the reactor is destroyed
+    void removeReactor(Reactor *reactor);
+
+    void addHost(const std::string &host, const std::string &address);
+
+    void removeHost(const std::string &host);
+
+    void clearHosts();
+
+    void loadHostsFile(const std::string &path);
+
+    void setBackend(Backend backend);
+
+    void setTTL(double ttl) {
+        std::lock_guard<std::mutex> lock(_lock);
+        _ttl = std::chrono::milliseconds(int64_t(ttl * 1000));
+    }
+
+    void setNegativeTTL(double ttl) {
+        std::lock_guard<std::mutex> lock(_lock);
+        _negativeTTL = std::chrono::milliseconds(int64_t(ttl * 1000));
+    }
+
+    void setMaxEntries(size_t maxEntries) {
+        std::lock_guard<std::mutex> lock(_lock);
+        _maxEntries = maxEntries;
+    }
+
+    void clear();
+
+    static ResolverCache* instance();
+protected:
+    struct Waiter {
+        Reactor *reactor;
+        ResolveCallback callback;
+    };
+
+    struct Entry {
+        boost::system::error_code error;
+        AddressList addresses;
+        Timestamp expiration;
+        bool pending{false};
+        int aborts{0};
+        std::vector<Waiter> waiters;
+    };
+
+    ServiceType& getService();
+
+    void startLookup(Backend backend, const std::string &host, const std::string &key);
+
+    void onResolved(const std::string &host, const std::string &key, const boost::system::error_code &ec,
+                    const AddressList &addresses);
+
+    void onDetachedResolved(uint64_t id, const boost::system::error_code &ec, const AddressList &addresses);
+
+    void purgeExpired(const Timestamp &now);
+
+    bool makeRoom(const Timestamp &now);
+
+    static void notify(Reactor *reactor, ResolveCallback callback, const boost::system::error_code &ec,
+                       const AddressList &addresses);
+
+    static void defaultBackend(ServiceType &service, const std::string &host, ResolveCallback callback);
+
+    std::mutex _lock;
+    Duration _ttl;
+    Duration _negativeTTL;
+    size_t _maxEntries{4096};
+    Backend _backend;
+    std::unordered_map<std::string, Entry> _entries;
+    std::unordered_map<std::string, AddressList> _hosts;
+    std::unordered_map<uint64_t, Waiter> _detached;
+    uint64_t _nextDetached{0};
+    ServiceType _ioService;
+    std::unique_ptr<WorkType> _work;
+    std::thread _thread;
+    std::once_flag _started;
+};
+
+
 class NET4CXX_COMMON_API Resolver: public std::enable_shared_from_this<Resolver> {
 public:
     friend Reactor;
     friend class DelayedResolve;
-    using ResolverType = boost::asio::ip::tcp::resolver;
-    using ResolverIterator = ResolverType::iterator;
+    using AddressType = ResolverCache::AddressType;
+    using AddressList = ResolverCache::AddressList;
+    using ResolveCallback = ResolverCache::ResolveCallback;
 
     explicit Resolver(Reactor *reactor);
 
     Resolver(const Resolver&) = delete;
 
     Resolver& operator=(const Resolver&) = delete;
+
+    void resolveAddresses(const std::string &host, ResolveCallback callback);
+
+    void cancel() {
+        _cancelled = true;
+    }
+
+    bool cancelled() const {
+        return _cancelled;
+    }
 protected:
     template <typename CallbackT>
     void start(const std::string &host, CallbackT &&callback) {
-        ResolverType::query query(host, "");
-        _resolver.async_resolve(query, [callback = std::forward<CallbackT>(callback), resolver = shared_from_this()](
-                const boost::system::error_code &ec, ResolverIterator iterator) {
-            StringVector addresses;
+        resolveAddresses(host, [callback = std::forward<CallbackT>(callback)](const boost::system::error_code &ec,
+                                                                              const AddressList &addresses) {
+            StringVector results;
             if (ec) {
                 if (ec == boost::asio::error::operation_aborted) {
                     return;
                 }
                 NET4CXX_LOG_ERROR(gGenLog, "Resolve error %d: %s", ec.value(), ec.message().c_str());
             } else {
-                ResolverIterator end;
-                while (iterator != end) {
-                    addresses.push_back(iterator->endpoint().address().to_string());
-                    ++iterator;
+                for (auto &address: addresses) {
+                    results.push_back(address.to_string());
                 }
             }
-            callback(std::move(addresses));
+            callback(std::move(results));
         });
     }
 
-    void cancel() {
-        _resolver.cancel();
-    }
-
-    ResolverType _resolver;
+    Reactor *_reactor{nullptr};
+    bool _cancelled{false};
 };
 
 
@@ -66,7 +175,8 @@ public:
     }
 
     bool cancelled() const {
-        return _resolver.expired();
+        auto resolver = _resolver.lock();
+        return !resolver || resolver->cancelled();
     }
 
     void cancel();
@@ -76,4 +186,6 @@ protected:
 
 NS_END
 
+#define NET4CXX_ResolverCache   net4cxx::ResolverCache::instance()
+
 #endif //NET4CXX_CORE_NETWORK_RESOLVER_H
@@ -11,10 +11,84 @@
 NS_BEGIN
 
 
+HandshakePool::HandshakePool(size_t threadCount, size_t maxPending)
+        : _work(new WorkType(_ioService))
+        , _maxPending(maxPending) {
+    if (!threadCount) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (size_t i = 0; i != threadCount; ++i) {
+        _threads.emplace_back([this]() {
+            _ioService.run();
+        });
+    }
+}
+
+HandshakePool::~HandshakePool() {
+    stop();
+}
+
+bool HandshakePool::tryEnqueue(const std::shared_ptr<SSLConnection> &connection) {
+    std::lock_guard<std::mutex> lock(_lock);
+    if (_stopped || _queued.load() + _active.load() >= _maxPending) {
+        ++_rejected;
+        return false;
+    }
+    _pending[connection.get()] = connection;
+    ++_queued;
+    return true;
+}
+
+void HandshakePool::handshakeFinished(SSLConnection *connection) {
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _pending.erase(connection);
+    }
+    --_active;
+    ++_completed;
+}
+
+void HandshakePool::stop() {
+    std::vector<std::shared_ptr<SSLConnection>> pending;
+    {
+        std::lock_guard<std::mutex> lock(_lock);
+        _stopped = true;
+        for (auto &entry: _pending) {
+            auto connection = entry.second.lock();
+            if (connection) {
+                pending.emplace_back(std::move(connection));
+            }
+        }
+    }
+    for (auto &connection: pending) {
+        Reactor *reactor = connection->reactor();
+        reactor->addCallback([connection = std::move(connection)]() {
+            connection->cancelHandshake();
+        });
+    }
+    // Without work the threads return once every queued and running handshake has completed
+    _work.reset();
+    for (auto &thread: _threads) {
+        if (thread.get_id() == std::this_thread::get_id()) {
+            thread.detach();
+        } else if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    _threads.clear();
+}
+
+
+const size_t SSLConnection::smallRecordSize = 1369;
+const size_t SSLConnection::maxRecordSize = SSL3_RT_MAX_PLAIN_LENGTH;
+const size_t SSLConnection::recordRampBytes = 128 * 1024;
+const Duration SSLConnection::recordIdleReset = std::chrono::seconds(1);
+
 SSLConnection::SSLConnection(const ProtocolPtr &protocol, SSLOptionPtr sslOption, Reactor *reactor)
         : Connection(protocol, reactor)
         , _sslOption(std::move(sslOption))
-        , _socket(reactor->getService(), _sslOption->context()) {
+        , _socket(reactor->getService(), _sslOption->context())
+        , _directIO(_sslOption->isKernelTLS()) {
 
 }
 
@@ -24,7 +98,16 @@ void SSLConnection::write(const Byte *data, size_t length) {
     }
     MessageBuffer packet(length);
     packet.write(data, length);
-    _writeQueue.emplace_back(std::move(packet));
+    write(std::move(packet));
+}
+
+void SSLConnection::write(MessageBuffer &&data) {
+    if (_disconnecting || _disconnected || !_connected) {
+        return;
+    }
+    size_t length = data.getActiveSize();
+    _writeQueue.emplace_back(std::move(data));
+    writeQueued(length);
     startWriting();
 }
 
@@ -49,14 +132,16 @@ void SSLConnection::abortConnection() {
 
 void SSLConnection::doClose() {
     if (_sslAccepted) {
-        if (!_writing) {
+        if (!_writing && !_writeScheduled) {
             startShutdown();
         }
+    } else if (_sslAccepting && _handshakeStrand) {
+        cancelHandshake();
     } else {
         if (_sslAccepting) {
             _socket.lowest_layer().cancel();
         }
-        _reactor->addCallback([this, self=shared_from_this()]() {
+        _reactor->addCallback([this, protocol = _protocol.lock(), self = shared_from_this()]() {
             if (!_disconnected) {
                 closeSocket();
             }
@@ -70,11 +155,13 @@ void SSLConnection::doAbort() {
             _socket.lowest_layer().cancel();
         }
         startShutdown();
+    } else if (_sslAccepting && _handshakeStrand) {
+        cancelHandshake();
     } else {
         if (_sslAccepting) {
             _socket.lowest_layer().cancel();
         }
-        _reactor->addCallback([this, self=shared_from_this()]() {
+        _reactor->addCallback([this, protocol = _protocol.lock(), self = shared_from_this()]() {
             if (!_disconnected) {
                 closeSocket();
             }
@@ -97,23 +184,112 @@ void SSLConnection::doHandshake() {
     auto protocol = _protocol.lock();
     NET4CXX_ASSERT(protocol);
     _sslAccepting = true;
-    if (_sslOption->isServerSide()) {
-        _socket.async_handshake(boost::asio::ssl::stream_base::server,
-                                [protocol, self = shared_from_this()](const boost::system::error_code &ec) {
-                                    self->cbHandshake(ec);
-                                });
+    auto type = _sslOption->isServerSide() ? boost::asio::ssl::stream_base::server :
+                boost::asio::ssl::stream_base::client;
+    if (!_sslOption->isServerSide() && !_sessionKey.empty()) {
+        _sslOption->prepareSession(_socket.native_handle(), &_sessionKey);
+    }
+    if (_handshakePool) {
+        _directIO = false;
+        doOffloadHandshake(protocol, type);
+        return;
+    }
+    if (_directIO) {
+        // OpenSSL does its own socket I/O so that it can hand the record layer to the kernel
+        _socket.next_layer().non_blocking(true);
+        SSL_set_fd(_socket.native_handle(), (int)_socket.next_layer().native_handle());
+        if (_sslOption->isServerSide()) {
+            SSL_set_accept_state(_socket.native_handle());
+        } else {
+            SSL_set_connect_state(_socket.native_handle());
+        }
+        doDirectHandshake();
+        return;
+    }
+    _socket.async_handshake(type, [protocol, self = shared_from_this()](const boost::system::error_code &ec) {
+        self->cbHandshake(ec);
+    });
+}
+
+void SSLConnection::doOffloadHandshake(const ProtocolPtr &protocol,
+                                       boost::asio::ssl::stream_base::handshake_type type) {
+    if (!_handshakePool->tryEnqueue(shared_from_this())) {
+        _reactor->addCallback([protocol, self = shared_from_this()]() {
+            self->cbHandshake(boost::asio::error::no_buffer_space);
+        });
+        return;
+    }
+    // The handshake and its I/O continuations run on the pool, completion is handed back to the reactor
+    _handshakeStrand.reset(new HandshakePool::StrandType(_handshakePool->makeStrand()));
+    boost::asio::post(*_handshakeStrand, [this, protocol, self = shared_from_this(), type]() mutable {
+        _handshakePool->handshakeStarted();
+        auto handler = [protocol = std::move(protocol), self = std::move(self)](
+                boost::system::error_code ec) mutable {
+            self->_handshakePool->handshakeFinished(self.get());
+            if (self->_handshakeCancelled) {
+                ec = boost::asio::error::operation_aborted;
+            }
+            // Both references travel back so the connection is never released on a pool thread
+            Reactor *reactor = self->_reactor;
+            reactor->addCallback([protocol = std::move(protocol), self = std::move(self), ec]() {
+                self->cbHandshake(ec);
+            });
+        };
+        if (_handshakeCancelled) {
+            handler(boost::asio::error::operation_aborted);
+        } else {
+            _socket.async_handshake(type, boost::asio::bind_executor(*_handshakeStrand, std::move(handler)));
+        }
+    });
+}
+
+void SSLConnection::cancelHandshake() {
+    // A queued handshake sees the flag before it starts. The shutdown fails the reads and writes of one already
+    // running, it goes through the handshake strand because the pool is using the socket meanwhile
+    if (!_sslAccepting || _handshakeCancelled || !_handshakeStrand) {
+        return;
+    }
+    _handshakeCancelled = true;
+    boost::asio::post(*_handshakeStrand, [self = shared_from_this()]() mutable {
+        boost::system::error_code ec;
+        self->_socket.lowest_layer().cancel(ec);
+        self->_socket.lowest_layer().shutdown(boost::asio::socket_base::shutdown_both, ec);
+        Reactor *reactor = self->_reactor;
+        reactor->addCallback([self = std::move(self)]() {
+
+        });
+    });
+}
+
+void SSLConnection::doDirectHandshake() {
+    auto protocol = _protocol.lock();
+    NET4CXX_ASSERT(protocol);
+    auto ssl = _socket.native_handle();
+    ERR_clear_error();
+    int result = SSL_do_handshake(ssl);
+    int error = result == 1 ? SSL_ERROR_NONE : SSL_get_error(ssl, result);
+    if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE) {
+        waitDirect(error, [protocol, self = shared_from_this()](const boost::system::error_code &ec) {
+            if (ec) {
+                self->cbHandshake(ec);
+            } else {
+                self->doDirectHandshake();
+            }
+        });
     } else {
-        _socket.async_handshake(boost::asio::ssl::stream_base::client,
-                                [protocol, self = shared_from_this()](const boost::system::error_code &ec) {
-                                    self->cbHandshake(ec);
-                                });
+        _reactor->addCallback([protocol, self = shared_from_this(), ec = getDirectError(error)]() {
+            self->cbHandshake(ec);
+        });
     }
 }
 
 void SSLConnection::handleHandshake(const boost::system::error_code &ec) {
     if (ec) {
         if (ec != boost::asio::error::operation_aborted) {
-            NET4CXX_LOG_ERROR(gGenLog, "Handshake error %d :%s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Handshake error %d :%s", ec.value(), ec.message().c_str());
+        }
+        if (!_sessionKey.empty()) {
+            _sslOption->removeSession(_sessionKey);
         }
         if (!_disconnected) {
             if (ec != boost::asio::error::operation_aborted) {
@@ -123,12 +299,21 @@ void SSLConnection::handleHandshake(const boost::system::error_code &ec) {
         }
     } else {
         _sslAccepted = true;
+        _sslOption->handshakeCompleted(_socket.native_handle());
+        if (_directIO) {
+            NET4CXX_LOG_DEBUG(gGenLog, "Kernel TLS send=%s recv=%s", isKernelTLSSend() ? "on" : "off",
+                              isKernelTLSRecv() ? "on" : "off");
+        }
     }
 }
 
 void SSLConnection::doRead() {
     auto protocol = _protocol.lock();
     NET4CXX_ASSERT(protocol);
+    if (_directIO) {
+        doDirectRead();
+        return;
+    }
     _readBuffer.normalize();
     _readBuffer.ensureFreeSpace();
     _reading = true;
@@ -139,12 +324,44 @@ void SSLConnection::doRead() {
                             });
 }
 
+void SSLConnection::doDirectRead() {
+    auto protocol = _protocol.lock();
+    NET4CXX_ASSERT(protocol);
+    _readBuffer.normalize();
+    _readBuffer.ensureFreeSpace();
+    _reading = true;
+    auto ssl = _socket.native_handle();
+    ERR_clear_error();
+    int result = SSL_read(ssl, _readBuffer.getWritePointer(),
+                          (int)std::min(_readBuffer.getRemainingSpace(), (size_t)INT_MAX));
+    if (result > 0) {
+        _reactor->addCallback([protocol, self = shared_from_this(), result]() {
+            self->cbRead({}, (size_t)result);
+        });
+        return;
+    }
+    int error = SSL_get_error(ssl, result);
+    if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE) {
+        waitDirect(error, [protocol, self = shared_from_this()](const boost::system::error_code &ec) {
+            if (ec) {
+                self->cbRead(ec, 0);
+            } else {
+                self->doDirectRead();
+            }
+        });
+    } else {
+        _reactor->addCallback([protocol, self = shared_from_this(), ec = getDirectError(error)]() {
+            self->cbRead(ec, 0);
+        });
+    }
+}
+
 void SSLConnection::handleRead(const boost::system::error_code &ec, size_t transferredBytes) {
     if (ec) {
         if (ec != boost::asio::error::operation_aborted && ec != boost::asio::error::eof &&
             (ec.category() != boost::asio::error::get_ssl_category() ||
              ERR_GET_REASON(ec.value()) != SSL_R_SHORT_READ)) {
-            NET4CXX_LOG_ERROR(gGenLog, "Read error %d :%s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Read error %d :%s", ec.value(), ec.message().c_str());
         }
         if (!_disconnected) {
             if (ec == boost::asio::error::operation_aborted) {
@@ -170,37 +387,119 @@ void SSLConnection::handleRead(const boost::system::error_code &ec, size_t trans
     }
 }
 
+void SSLConnection::scheduleWrite() {
+    // Writes issued within the same callback are coalesced into one buffer before encryption
+    _writeScheduled = true;
+    _reactor->addCallback([protocol = _protocol.lock(), self = shared_from_this()]() {
+        self->_writeScheduled = false;
+        if (!self->_writing && !self->_aborting && !self->_disconnected && !self->_sslShutting &&
+            !self->_writeQueue.empty()) {
+            self->doWrite();
+        } else if (self->_disconnecting && !self->_writing && !self->_disconnected) {
+            self->startShutdown();
+        }
+    });
+}
+
 void SSLConnection::doWrite() {
+    adjustRecordSize();
+    coalesceWrites();
     MessageBuffer &buffer = _writeQueue.front();
-    if (_writeQueue.size() > 1) {
-        size_t space = 0;
-        for (auto iter = std::next(_writeQueue.begin()); iter != _writeQueue.end(); ++iter) {
-            space += iter->getActiveSize();
-        }
-        buffer.ensureFreeSpace(space);
-        for (auto iter = std::next(_writeQueue.begin()); iter != _writeQueue.end(); ++iter) {
-            buffer.write(iter->getReadPointer(), iter->getActiveSize());
-        }
-        while (_writeQueue.size() > 1) {
-            _writeQueue.pop_back();
-        }
-    }
     auto protocol = _protocol.lock();
     NET4CXX_ASSERT(protocol);
     _writing = true;
-    _socket.async_write_some(boost::asio::buffer(buffer.getReadPointer(), buffer.getActiveSize()),
+    writeBlocked();
+    if (_directIO) {
+        doDirectWrite();
+        return;
+    }
+    _socket.async_write_some(boost::asio::buffer(buffer.getReadPointer(),
+                                                 std::min(buffer.getActiveSize(), _recordSize)),
                              [protocol, self = shared_from_this()](const boost::system::error_code &ec,
                                                                    size_t transferredBytes) {
                                  self->cbWrite(ec, transferredBytes);
                              });
 }
 
+void SSLConnection::coalesceWrites() {
+    // Top the front buffer up to one record from the buffers queued behind it, so it never grows past a record
+    MessageBuffer &buffer = _writeQueue.front();
+    if (_writeQueue.size() < 2 || buffer.getActiveSize() >= _recordSize) {
+        return;
+    }
+    buffer.normalize();
+    size_t space = _recordSize - buffer.getActiveSize();
+    buffer.ensureFreeSpace(space);
+    auto iter = std::next(_writeQueue.begin());
+    while (space && iter != _writeQueue.end()) {
+        size_t length = std::min(space, iter->getActiveSize());
+        buffer.write(iter->getReadPointer(), length);
+        iter->readCompleted(length);
+        space -= length;
+        if (iter->getActiveSize()) {
+            break;
+        }
+        iter = _writeQueue.erase(iter);
+    }
+}
+
+void SSLConnection::adjustRecordSize() {
+    if (!_sslOption->isDynamicRecordSize() || isKernelTLSSend()) {
+        _recordSize = maxRecordSize;
+        return;
+    }
+    // Start bursts with records that fit a single segment, grow them once the stream is sustained
+    if (TimestampClock::now() - _lastWrite > recordIdleReset) {
+        _burstBytes = 0;
+    }
+    _recordSize = _burstBytes < recordRampBytes ? smallRecordSize : maxRecordSize;
+}
+
+void SSLConnection::doDirectWrite() {
+    auto protocol = _protocol.lock();
+    NET4CXX_ASSERT(protocol);
+    MessageBuffer &buffer = _writeQueue.front();
+    auto ssl = _socket.native_handle();
+    if (BIO_get_ktls_send(SSL_get_wbio(ssl))) {
+        // The kernel frames the records, plaintext goes straight to the socket
+        _socket.next_layer().async_write_some(boost::asio::buffer(buffer.getReadPointer(), buffer.getActiveSize()),
+                                              [protocol, self = shared_from_this()](
+                                                      const boost::system::error_code &ec, size_t transferredBytes) {
+                                                  self->cbWrite(ec, transferredBytes);
+                                              });
+        return;
+    }
+    ERR_clear_error();
+    int result = SSL_write(ssl, buffer.getReadPointer(), (int)std::min(buffer.getActiveSize(), _recordSize));
+    if (result > 0) {
+        _reactor->addCallback([protocol, self = shared_from_this(), result]() {
+            self->cbWrite({}, (size_t)result);
+        });
+        return;
+    }
+    int error = SSL_get_error(ssl, result);
+    if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE) {
+        waitDirect(error, [protocol, self = shared_from_this()](const boost::system::error_code &ec) {
+            if (ec) {
+                self->cbWrite(ec, 0);
+            } else {
+                self->doDirectWrite();
+            }
+        });
+    } else {
+        _reactor->addCallback([protocol, self = shared_from_this(), ec = getDirectError(error)]() {
+            self->cbWrite(ec, 0);
+        });
+    }
+}
+
 void SSLConnection::handleWrite(const boost::system::error_code &ec, size_t transferredBytes) {
+    writeUnblocked();
     if (ec) {
         if (ec != boost::asio::error::operation_aborted && ec != boost::asio::error::eof &&
             (ec.category() != boost::asio::error::get_ssl_category() ||
              ERR_GET_REASON(ec.value()) != SSL_R_SHORT_READ)) {
-            NET4CXX_LOG_ERROR(gGenLog, "Write error %d :%s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Write error %d :%s", ec.value(), ec.message().c_str());
         }
         if (!_disconnected) {
             if (ec == boost::asio::error::operation_aborted) {
@@ -216,11 +515,22 @@ void SSLConnection::handleWrite(const boost::system::error_code &ec, size_t tran
             _disconnecting = true;
             startShutdown();
         }
+        finishFlush();
     } else {
         if (transferredBytes > 0) {
+            // Each SSL_write of at most _recordSize bytes is one record, the kernel splits kTLS writes at the maximum
+            _flushRecords += isKernelTLSSend() ? (transferredBytes + maxRecordSize - 1) / maxRecordSize : 1;
+            _flushBytes += transferredBytes;
+            _burstBytes += transferredBytes;
+            _lastWrite = TimestampClock::now();
+            writeCompleted(transferredBytes);
             _writeQueue.front().readCompleted(transferredBytes);
             if (!_writeQueue.front().getActiveSize()) {
                 _writeQueue.pop_front();
+                if (_writeQueue.empty()) {
+                    finishFlush();
+                    writeDrained();
+                }
             }
         }
         if ((_disconnecting && _writeQueue.empty()) || _aborting) {
@@ -229,21 +539,66 @@ void SSLConnection::handleWrite(const boost::system::error_code &ec, size_t tran
     }
 }
 
+void SSLConnection::finishFlush() {
+    // A flush runs from the first doWrite on a non-empty queue until the queue drains or the write fails
+    if (!_flushRecords) {
+        return;
+    }
+    ++_flushCount;
+    _recordCount += _flushRecords;
+    _recordBytes += _flushBytes;
+    _sslOption->recordsFlushed(_flushRecords, _flushBytes);
+    _flushRecords = 0;
+    _flushBytes = 0;
+}
+
 void SSLConnection::doShutdown() {
     auto protocol = _protocol.lock();
     NET4CXX_ASSERT(protocol);
     _sslShutting = true;
+    if (_directIO) {
+        doDirectShutdown();
+        return;
+    }
     _socket.async_shutdown([protocol, self = shared_from_this()](const boost::system::error_code &ec) {
         self->cbShutdown(ec);
     });
 }
 
+void SSLConnection::doDirectShutdown() {
+    auto protocol = _protocol.lock();
+    NET4CXX_ASSERT(protocol);
+    auto ssl = _socket.native_handle();
+    ERR_clear_error();
+    int result = SSL_shutdown(ssl);
+    if (result >= 0) {
+        _reactor->addCallback([protocol, self = shared_from_this()]() {
+            self->cbShutdown({});
+        });
+        return;
+    }
+    int error = SSL_get_error(ssl, result);
+    if (error == SSL_ERROR_WANT_READ || error == SSL_ERROR_WANT_WRITE) {
+        waitDirect(error, [protocol, self = shared_from_this()](const boost::system::error_code &ec) {
+            if (ec) {
+                self->cbShutdown(ec);
+            } else {
+                self->doDirectShutdown();
+            }
+        });
+    } else {
+        _reactor->addCallback([protocol, self = shared_from_this(), ec = getDirectError(error)]() {
+            self->cbShutdown(ec);
+        });
+    }
+}
+
 void SSLConnection::handleShutdown(const boost::system::error_code &ec) {
     if (ec) {
         if (ec != boost::asio::error::operation_aborted && ec != boost::asio::error::eof &&
             (ec.category() != boost::asio::error::get_ssl_category() ||
              ERR_GET_REASON(ec.value()) != SSL_R_SHORT_READ)) {
-            NET4CXX_LOG_ERROR(gGenLog, "Read error %d :%s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Read error %d :%s", ec.value(), ec.message().c_str());
             _error = std::make_exception_ptr(boost::system::system_error(ec));
         }
     }
@@ -251,6 +606,28 @@ void SSLConnection::handleShutdown(const boost::system::error_code &ec) {
     closeSocket();
 }
 
+boost::system::error_code SSLConnection::getDirectError(int error) {
+    if (error == SSL_ERROR_NONE) {
+        return {};
+    }
+    if (error == SSL_ERROR_ZERO_RETURN) {
+        return boost::asio::error::eof;
+    }
+    auto code = ERR_get_error();
+    if (code) {
+#ifdef SSL_R_UNEXPECTED_EOF_WHILE_READING
+        if (ERR_GET_REASON(code) == SSL_R_UNEXPECTED_EOF_WHILE_READING) {
+            return boost::asio::error::eof;
+        }
+#endif
+        return {(int)code, boost::asio::error::get_ssl_category()};
+    }
+    if (error == SSL_ERROR_SYSCALL && errno) {
+        return {errno, boost::system::system_category()};
+    }
+    return boost::asio::error::eof;
+}
+
 
 void SSLServerConnection::cbAccept(const ProtocolPtr &protocol) {
     _protocol = protocol;
@@ -279,16 +656,15 @@ void SSLClientConnection::closeSocket() {
 
 
 SSLListener::SSLListener(std::string port, std::shared_ptr<Factory> factory, SSLOptionPtr sslOption,
-                         std::string interface, Reactor *reactor)
+                         std::string interface, Reactor *reactor, HandshakePoolPtr handshakePool)
         : Listener(reactor)
         , _port(std::move(port))
         , _factory(std::move(factory))
         , _sslOption(std::move(sslOption))
         , _interface(std::move(interface))
+        , _handshakePool(std::move(handshakePool))
         , _acceptor(reactor->getService()) {
-#ifdef NET4CXX_DEBUG
-    NET4CXX_Watcher->inc(NET4CXX_SSLListener_COUNT);
-#endif
+    gSSLListenerCount->inc();
     if (_interface.empty()) {
 //        _interface = "::";
         _interface = "0.0.0.0";
@@ -334,7 +710,7 @@ void SSLListener::cbAccept(const boost::system::error_code &ec) {
 void SSLListener::handleAccept(const boost::system::error_code &ec) {
     if (ec) {
         if (ec != boost::asio::error::operation_aborted) {
-            NET4CXX_LOG_ERROR(gGenLog, "Accept error %d: %s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Accept error %d: %s", ec.value(), ec.message().c_str());
         }
     } else {
         Address address{_connection->getRemoteAddress(), _connection->getRemotePort()};
@@ -357,10 +733,8 @@ SSLConnector::SSLConnector(std::string host, std::string port, std::shared_ptr<C
         , _sslOption(std::move(sslOption))
         , _timeout(timeout)
         , _bindAddress(std::move(bindAddress))
-        , _resolver(reactor->getService()) {
-#ifdef NET4CXX_DEBUG
-    NET4CXX_Watcher->inc(NET4CXX_SSLConnector_COUNT);
-#endif
+        , _attempts(this, gSSLConnectTime) {
+    gSSLConnectorCount->inc();
 }
 
 void SSLConnector::startConnecting() {
@@ -390,11 +764,14 @@ void SSLConnector::stopConnecting() {
         NET4CXX_THROW_EXCEPTION(NotConnectingError, "We're not trying to connect");
     }
     _error = NET4CXX_EXCEPTION_PTR(UserAbort, "");
-    if (_connection) {
-        _connection->getSocket().lowest_layer().close();
-        _connection.reset();
-    } else {
-        _resolver.cancel();
+    if (!_attempts.empty()) {
+        _attempts.abort();
+    } else if (_resolver) {
+        _resolver->cancel();
+        _resolver.reset();
+        _reactor->addCallback([this, self=shared_from_this()]() {
+            connectionFailed();
+        });
     }
     _state = kDisconnected;
 }
@@ -404,6 +781,11 @@ void SSLConnector::connectionFailed(std::exception_ptr reason) {
         _error = std::move(reason);
     }
     cancelTimeout();
+    if (_resolver) {
+        _resolver->cancel();
+        _resolver.reset();
+    }
+    _attempts.clear();
     _connection.reset();
     _state = kDisconnected;
     _factory->clientConnectionFailed(shared_from_this(), _error);
@@ -432,46 +814,72 @@ ProtocolPtr SSLConnector::buildProtocol(const Address &address) {
 }
 
 void SSLConnector::doResolve() {
-    ResolverType::query query(_host, _port);
-    _resolver.async_resolve(query, [this, self=shared_from_this()](
-            const boost::system::error_code &ec, ResolverIterator iterator) {
-        cbResolve(ec, std::move(iterator));
+    _resolver = std::make_shared<Resolver>(_reactor);
+    _resolver->resolveAddresses(_host, [this, self=shared_from_this()](const boost::system::error_code &ec,
+                                                                       const Resolver::AddressList &addresses) {
+        cbResolve(ec, addresses);
     });
 }
 
-void SSLConnector::handleResolve(const boost::system::error_code &ec, ResolverIterator iterator) {
-    if (ec) {
+void SSLConnector::handleResolve(const boost::system::error_code &ec, const Resolver::AddressList &addresses) {
+    if (ec || addresses.empty()) {
         if (ec != boost::asio::error::operation_aborted) {
-            NET4CXX_LOG_ERROR(gGenLog, "Resolve error %d :%s", ec.value(), ec.message().c_str());
-            _error = std::make_exception_ptr(boost::system::system_error(ec));
+            boost::system::error_code error = ec ? ec : boost::asio::error::host_not_found;
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Resolve error %d :%s", error.value(), error.message().c_str());
+            _error = std::make_exception_ptr(boost::system::system_error(error));
         }
         connectionFailed();
+        return;
     }
+    if (_state != kConnecting) {
+        return;
+    }
+    boost::system::error_code error;
+    auto endpoints = makeEndpoints(addresses, error);
+    if (error) {
+        NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Unknown service %s: %s", _port.c_str(), error.message().c_str());
+        connectionFailed(std::make_exception_ptr(boost::system::system_error(error)));
+        return;
+    }
+    doConnect(std::move(endpoints));
+}
+
+SSLConnector::EndpointList SSLConnector::makeEndpoints(const Resolver::AddressList &addresses,
+                                                       boost::system::error_code &ec) const {
+    EndpointList endpoints;
+    unsigned short port = NetUtil::getServicePort(_port, ec);
+    if (ec) {
+        return endpoints;
+    }
+    for (auto &address: addresses) {
+        endpoints.emplace_back(address, port);
+    }
+    return endpoints;
 }
 
 void SSLConnector::doConnect() {
-    makeTransport();
     EndpointType endpoint{AddressType::from_string(_host), (unsigned short)std::stoul(_port)};
-    _connection->getSocket().lowest_layer().async_connect(
-            endpoint, [this, self = shared_from_this(), connection = _connection](
-                    const boost::system::error_code &ec) {
-                cbConnect(ec);
-            });
+    doConnect(EndpointList{endpoint});
 }
 
-void SSLConnector::doConnect(ResolverIterator iterator) {
-    makeTransport();
-    boost::asio::async_connect(_connection->getSocket().lowest_layer(), std::move(iterator),
-                               [this, self = shared_from_this(), connection = _connection](
-                                       const boost::system::error_code &ec, ResolverIterator iterator) {
-                                   cbConnect(ec);
-                               });
+void SSLConnector::doConnect(EndpointList endpoints) {
+    if (!_bindAddress.getAddress().empty()) {
+        bool v4 = AddressType::from_string(_bindAddress.getAddress()).is_v4();
+        endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(), [v4](const EndpointType &endpoint) {
+            return endpoint.address().is_v4() != v4;
+        }), endpoints.end());
+        if (endpoints.empty()) {
+            handleConnect(boost::asio::error::address_family_not_supported);
+            return;
+        }
+    }
+    _attempts.start(endpoints);
 }
 
 void SSLConnector::handleConnect(const boost::system::error_code &ec) {
     if (ec) {
         if (ec != boost::asio::error::operation_aborted) {
-            NET4CXX_LOG_ERROR(gGenLog, "Connect error %d :%s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Connect error %d :%s", ec.value(), ec.message().c_str());
             _error = std::make_exception_ptr(boost::system::system_error(ec));
         }
         connectionFailed();
@@ -490,18 +898,23 @@ void SSLConnector::handleConnect(const boost::system::error_code &ec) {
 }
 
 void SSLConnector::handleTimeout() {
-    NET4CXX_LOG_ERROR(gGenLog, "Connect error : Timeout");
+    NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Connect error : Timeout");
     _error = NET4CXX_EXCEPTION_PTR(TimeoutError, "");
     connectionFailed();
 }
 
-void SSLConnector::makeTransport() {
-    _connection = std::make_shared<SSLClientConnection>(_sslOption, _reactor);
+std::shared_ptr<SSLClientConnection> SSLConnector::makeTransport(bool exclusiveBind, boost::system::error_code &ec) {
+    auto connection = std::make_shared<SSLClientConnection>(_sslOption, _reactor);
+    connection->setSessionKey(_host + ":" + _port);
     if (!_bindAddress.getAddress().empty()) {
-        EndpointType endpoint{AddressType::from_string(_bindAddress.getAddress()), _bindAddress.getPort()};
-        _connection->getSocket().lowest_layer().open(endpoint.protocol());
-        _connection->getSocket().lowest_layer().bind(endpoint);
+        unsigned short port = exclusiveBind ? _bindAddress.getPort() : (unsigned short)0;
+        EndpointType endpoint{AddressType::from_string(_bindAddress.getAddress()), port};
+        connection->getSocket().lowest_layer().open(endpoint.protocol(), ec);
+        if (!ec) {
+            connection->getSocket().lowest_layer().bind(endpoint, ec);
+        }
     }
+    return connection;
 }
 
 NS_END
\ No newline at end of file
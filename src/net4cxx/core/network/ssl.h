@@ -6,11 +6,12 @@
 #define NET4CXX_CORE_NETWORK_SSL_H
 
 #include "net4cxx/common/common.h"
+#include <thread>
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
-#include "net4cxx/common/debugging/watcher.h"
 #include "net4cxx/common/global/loggers.h"
 #include "net4cxx/core/network/base.h"
+#include "net4cxx/core/network/resolver.h"
 
 
 NS_BEGIN
@@ -18,10 +19,83 @@ NS_BEGIN
 class Factory;
 class ClientFactory;
 class SSLConnector;
+class SSLConnection;
+
+
+class NET4CXX_COMMON_API HandshakePool: public boost::noncopyable {
+public:
+    using ServiceType = boost::asio::io_service;
+    using WorkType = ServiceType::work;
+    using StrandType = boost::asio::strand<ServiceType::executor_type>;
+
+    explicit HandshakePool(size_t threadCount=0, size_t maxPending=1024);
+
+    ~HandshakePool();
+
+    /// Fails every queued and running handshake with operation_aborted and waits for them to finish.
+    /// The cancellation runs on each connection's reactor, so don't call it from a reactor thread
+    /// that still has handshakes on this pool.
+    void stop();
+
+    StrandType makeStrand() {
+        return StrandType(_ioService.get_executor());
+    }
+
+    bool tryEnqueue(const std::shared_ptr<SSLConnection> &connection);
+
+    void handshakeStarted() {
+        --_queued;
+        ++_active;
+    }
+
+    void handshakeFinished(SSLConnection *connection);
+
+    size_t getThreadCount() const {
+        return _threads.size();
+    }
+
+    size_t getMaxPending() const {
+        return _maxPending;
+    }
+
+    size_t getQueuedHandshakes() const {
+        return _queued.load();
+    }
+
+    size_t getActiveHandshakes() const {
+        return _active.load();
+    }
+
+    size_t getCompletedHandshakes() const {
+        return _completed.load();
+    }
+
+    size_t getRejectedHandshakes() const {
+        return _rejected.load();
+    }
+
+    static HandshakePoolPtr create(size_t threadCount=0, size_t maxPending=1024) {
+        return std::make_shared<HandshakePool>(threadCount, maxPending);
+    }
+protected:
+    ServiceType _ioService;
+    std::unique_ptr<WorkType> _work;
+    std::vector<std::thread> _threads;
+    size_t _maxPending;
+    std::mutex _lock;
+    bool _stopped{false};
+    std::unordered_map<SSLConnection *, std::weak_ptr<SSLConnection>> _pending;
+    std::atomic<size_t> _queued{0};
+    std::atomic<size_t> _active{0};
+    std::atomic<size_t> _completed{0};
+    std::atomic<size_t> _rejected{0};
+};
 
 
 class NET4CXX_COMMON_API SSLConnection: public Connection, public std::enable_shared_from_this<SSLConnection> {
 public:
+    friend class HandshakePool;
+
     using SocketType = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
 
     SSLConnection(const ProtocolPtr &protocol, SSLOptionPtr sslOption, Reactor *reactor);
@@ -30,8 +104,54 @@ public:
         return _socket;
     }
 
+    void setSessionKey(std::string sessionKey) {
+        _sessionKey = std::move(sessionKey);
+    }
+
+    const std::string& getSessionKey() const {
+        return _sessionKey;
+    }
+
+    bool isSessionReused() {
+        return SSL_session_reused(_socket.native_handle()) != 0;
+    }
+
+    void setHandshakePool(HandshakePoolPtr handshakePool) {
+        _handshakePool = std::move(handshakePool);
+    }
+
+    const HandshakePoolPtr& getHandshakePool() const {
+        return _handshakePool;
+    }
+
+    size_t getFlushCount() const {
+        return _flushCount;
+    }
+
+    size_t getRecordCount() const {
+        return _recordCount;
+    }
+
+    double getRecordsPerFlush() const {
+        return _flushCount ? (double)_recordCount / _flushCount : 0.0;
+    }
+
+    double getBytesPerRecord() const {
+        return _recordCount ? (double)_recordBytes / _recordCount : 0.0;
+    }
+
+    bool isKernelTLSSend() {
+        return _directIO && BIO_get_ktls_send(SSL_get_wbio(_socket.native_handle()));
+    }
+
+    bool isKernelTLSRecv() {
+        return _directIO && BIO_get_ktls_recv(SSL_get_rbio(_socket.native_handle()));
+    }
+
     void write(const Byte *data, size_t length) override;
 
+    void write(MessageBuffer &&data) override;
+
     void loseConnection() override;
 
     void abortConnection() override;
@@ -92,6 +212,27 @@ protected:
 
     void doHandshake();
 
+    void doOffloadHandshake(const ProtocolPtr &protocol, boost::asio::ssl::stream_base::handshake_type type);
+
+    void cancelHandshake();
+
+    void doDirectHandshake();
+
+    void doDirectRead();
+
+    void doDirectWrite();
+
+    void doDirectShutdown();
+
+    template <typename CallbackT>
+    void waitDirect(int error, CallbackT &&callback) {
+        auto waitType = error == SSL_ERROR_WANT_WRITE ? boost::asio::socket_base::wait_write :
+                        boost::asio::socket_base::wait_read;
+        _socket.next_layer().async_wait(waitType, std::forward<CallbackT>(callback));
+    }
+
+    static boost::system::error_code getDirectError(int error);
+
     void cbHandshake(const boost::system::error_code &ec) {
         _sslAccepting = false;
         handleHandshake(ec);
@@ -124,13 +265,25 @@ protected:
     void handleRead(const boost::system::error_code &ec, size_t transferredBytes);
 
     void startWriting() {
-        if (!_writing && _sslAccepted) {
-            doWrite();
+        if (!_writing && !_writeScheduled && _sslAccepted) {
+            adjustRecordSize();
+            if (_stats.queuedBytes >= _recordSize) {
+                // A full record is already queued, nothing is gained by waiting for more
+                doWrite();
+            } else {
+                scheduleWrite();
+            }
         }
     }
 
+    void scheduleWrite();
+
     void doWrite();
 
+    void coalesceWrites();
+
+    void adjustRecordSize();
+
     void cbWrite(const boost::system::error_code &ec, size_t transferredBytes) {
         _writing = false;
         handleWrite(ec, transferredBytes);
@@ -141,6 +294,8 @@ protected:
 
     void handleWrite(const boost::system::error_code &ec, size_t transferredBytes);
 
+    void finishFlush();
+
     void startShutdown() {
         if (!_sslShutting) {
             doShutdown();
@@ -161,7 +316,26 @@ protected:
     bool _sslShutting{false};
     SSLOptionPtr _sslOption;
     SocketType _socket;
+    std::string _sessionKey;
+    HandshakePoolPtr _handshakePool;
+    std::unique_ptr<HandshakePool::StrandType> _handshakeStrand;
+    std::atomic<bool> _handshakeCancelled{false};
+    bool _directIO{false};
+    bool _writeScheduled{false};
+    size_t _recordSize{0};
+    size_t _burstBytes{0};
+    Timestamp _lastWrite;
+    size_t _flushCount{0};
+    size_t _recordCount{0};
+    size_t _recordBytes{0};
+    size_t _flushRecords{0};
+    size_t _flushBytes{0};
     std::exception_ptr _error;
+
+    static const size_t smallRecordSize;
+    static const size_t maxRecordSize;
+    static const size_t recordRampBytes;
+    static const Duration recordIdleReset;
 };
 
 
@@ -169,16 +343,12 @@ class NET4CXX_COMMON_API SSLServerConnection: public SSLConnection {
 public:
     explicit SSLServerConnection(SSLOptionPtr sslOption, Reactor *reactor)
             : SSLConnection({}, std::move(sslOption), reactor) {
-#ifdef NET4CXX_DEBUG
-        NET4CXX_Watcher->inc(NET4CXX_SSLServerConnection_COUNT);
-#endif
+        gSSLServerConnectionCount->inc();
     }
 
-#ifdef NET4CXX_DEBUG
     ~SSLServerConnection() override {
-        NET4CXX_Watcher->dec(NET4CXX_SSLServerConnection_COUNT);
+        gSSLServerConnectionCount->dec();
     }
-#endif
 
     void cbAccept(const ProtocolPtr &protocol);
 };
@@ -188,16 +358,12 @@ class NET4CXX_COMMON_API SSLClientConnection: public SSLConnection {
 public:
     explicit SSLClientConnection(SSLOptionPtr sslOption, Reactor *reactor)
             : SSLConnection({}, std::move(sslOption), reactor) {
-#ifdef NET4CXX_DEBUG
-        NET4CXX_Watcher->inc(NET4CXX_SSLClientConnection_COUNT);
-#endif
+        gSSLClientConnectionCount->inc();
     }
 
-#ifdef NET4CXX_DEBUG
     ~SSLClientConnection() override {
-        NET4CXX_Watcher->dec(NET4CXX_SSLClientConnection_COUNT);
+        gSSLClientConnectionCount->dec();
     }
-#endif
 
     void cbConnect(const ProtocolPtr &protocol, std::shared_ptr<SSLConnector> connector);
 protected:
@@ -217,13 +383,11 @@ public:
     using ResolverIterator = ResolverType::iterator;
 
     SSLListener(std::string port, std::shared_ptr<Factory> factory, SSLOptionPtr sslOption, std::string interface,
-                Reactor *reactor);
+                Reactor *reactor, HandshakePoolPtr handshakePool={});
 
-#ifdef NET4CXX_DEBUG
     ~SSLListener() override {
-        NET4CXX_Watcher->dec(NET4CXX_SSLListener_COUNT);
+        gSSLListenerCount->dec();
     }
-#endif
 
     void startListening() override;
 
@@ -245,6 +409,9 @@ protected:
 
     void doAccept() {
         _connection = std::make_shared<SSLServerConnection>(_sslOption, _reactor);
+        if (_handshakePool) {
+            _connection->setHandshakePool(_handshakePool);
+        }
         _acceptor.async_accept(_connection->getSocket().lowest_layer(),
                                std::bind(&SSLListener::cbAccept, shared_from_this(), std::placeholders::_1));
     }
@@ -253,6 +420,7 @@ protected:
     std::shared_ptr<Factory> _factory;
     SSLOptionPtr _sslOption;
     std::string _interface;
+    HandshakePoolPtr _handshakePool;
     AcceptorType _acceptor;
     bool _connected{false};
     std::shared_ptr<SSLServerConnection> _connection;
@@ -266,15 +434,14 @@ public:
     using ResolverType = boost::asio::ip::tcp::resolver;
     using ResolverIterator = ResolverType::iterator;
     using EndpointType = boost::asio::ip::tcp::endpoint;
+    using EndpointList = std::vector<EndpointType>;
 
     SSLConnector(std::string host, std::string port, std::shared_ptr<ClientFactory> factory, SSLOptionPtr sslOption,
                  double timeout, Address bindAddress, Reactor *reactor);
 
-#ifdef NET4CXX_DEBUG
     ~SSLConnector() override {
-        NET4CXX_Watcher->dec(NET4CXX_SSLConnector_COUNT);
+        gSSLConnectorCount->dec();
     }
-#endif
 
     void startConnecting() override;
 
@@ -283,7 +450,29 @@ public:
     void connectionFailed(std::exception_ptr reason={});
 
     void connectionLost(std::exception_ptr reason={});
+
+    void setAttemptDelay(double attemptDelay) {
+        _attempts.setAttemptDelay(attemptDelay);
+    }
+
+    double getAttemptDelay() const {
+        return _attempts.getAttemptDelay();
+    }
+
+    Duration getConnectDuration() const {
+        return _attempts.getConnectDuration();
+    }
+
+    size_t getConnectAttempts() const {
+        return _attempts.getConnectAttempts();
+    }
 protected:
+    friend class ConnectAttempts<SSLConnector, SSLClientConnection>;
+
+    bool isConnecting() const {
+        return _state == kConnecting;
+    }
+
     ProtocolPtr buildProtocol(const Address &address);
 
     void cancelTimeout() {
@@ -294,20 +483,21 @@ protected:
 
     void doResolve();
 
-    void cbResolve(const boost::system::error_code &ec, ResolverIterator iterator) {
-        handleResolve(ec, iterator);
-        if (_state == kConnecting) {
-            doConnect(std::move(iterator));
-        }
+    void cbResolve(const boost::system::error_code &ec, const Resolver::AddressList &addresses) {
+        _resolver.reset();
+        handleResolve(ec, addresses);
     }
 
-    void handleResolve(const boost::system::error_code &ec, ResolverIterator iterator);
+    void handleResolve(const boost::system::error_code &ec, const Resolver::AddressList &addresses);
+
+    EndpointList makeEndpoints(const Resolver::AddressList &addresses, boost::system::error_code &ec) const;
 
     void doConnect();
 
-    void doConnect(ResolverIterator iterator);
+    void doConnect(EndpointList endpoints);
 
-    void cbConnect(const boost::system::error_code &ec) {
+    void cbConnect(const boost::system::error_code &ec, std::shared_ptr<SSLClientConnection> connection) {
+        _connection = std::move(connection);
         handleConnect(ec);
     }
 
@@ -319,7 +509,7 @@ protected:
 
     void handleTimeout();
 
-    void makeTransport();
+    std::shared_ptr<SSLClientConnection> makeTransport(bool exclusiveBind, boost::system::error_code &ec);
 
     enum State {
         kDisconnected,
@@ -333,8 +523,9 @@ protected:
     SSLOptionPtr _sslOption;
     double _timeout{0.0};
     Address _bindAddress;
-    ResolverType _resolver;
+    std::shared_ptr<Resolver> _resolver;
     std::shared_ptr<SSLClientConnection> _connection;
+    ConnectAttempts<SSLConnector, SSLClientConnection> _attempts;
     State _state{kDisconnected};
     DelayedCall _timeoutId;
     bool _factoryStarted{false};
@@ -22,7 +22,16 @@ void TCPConnection::write(const Byte *data, size_t length) {
     }
     MessageBuffer packet(length);
     packet.write(data, length);
-    _writeQueue.emplace_back(std::move(packet));
+    write(std::move(packet));
+}
+
+void TCPConnection::write(MessageBuffer &&data) {
+    if (_disconnecting || _disconnected || !_connected) {
+        return;
+    }
+    size_t length = data.getActiveSize();
+    _writeQueue.emplace_back(std::move(data));
+    writeQueued(length);
     startWriting();
 }
 
@@ -47,7 +56,7 @@ void TCPConnection::abortConnection() {
 
 void TCPConnection::doClose() {
     if (!_writing && !_reading) {
-        _reactor->addCallback([this, self=shared_from_this()]() {
+        _reactor->addCallback([this, protocol = _protocol.lock(), self = shared_from_this()]() {
             if (!_disconnected) {
                 closeSocket();
             }
@@ -59,7 +68,7 @@ void TCPConnection::doClose() {
 
 void TCPConnection::doAbort() {
     if (!_writing && !_reading) {
-        _reactor->addCallback([this, self=shared_from_this()]() {
+        _reactor->addCallback([this, protocol = _protocol.lock(), self = shared_from_this()]() {
             if (!_disconnected) {
                 closeSocket();
             }
@@ -96,7 +105,7 @@ void TCPConnection::doRead() {
 void TCPConnection::handleRead(const boost::system::error_code &ec, size_t transferredBytes) {
     if (ec) {
         if (ec != boost::asio::error::operation_aborted && ec != boost::asio::error::eof) {
-            NET4CXX_LOG_ERROR(gGenLog, "Read error %d :%s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Read error %d :%s", ec.value(), ec.message().c_str());
         }
         if (!_disconnected) {
             if (ec == boost::asio::error::operation_aborted) {
@@ -130,7 +139,7 @@ void TCPConnection::doWrite() {
             if (ec == boost::asio::error::would_block || ec == boost::asio::error::try_again) {
                 break;
             } else {
-                NET4CXX_LOG_ERROR(gGenLog, "Write error %d :%s", ec.value(), ec.message().c_str());
+                NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Write error %d :%s", ec.value(), ec.message().c_str());
             }
             _error = std::make_exception_ptr(boost::system::system_error(ec));
             _disconnecting = true;
@@ -140,12 +149,15 @@ void TCPConnection::doWrite() {
             _disconnecting = true;
             doClose();
             return;
-        } else if (bytesSent < bytesToSend) {
+        }
+        writeCompleted(bytesSent);
+        if (bytesSent < bytesToSend) {
             buffer.readCompleted(bytesSent);
             break;
         }
         _writeQueue.pop_front();
         if (_writeQueue.empty()) {
+            writeDrained();
             return;
         }
     }
@@ -169,6 +181,7 @@ void TCPConnection::doWrite() {
     auto protocol = _protocol.lock();
     NET4CXX_ASSERT(protocol);
     _writing = true;
+    writeBlocked();
     _socket.async_write_some(boost::asio::buffer(buffer.getReadPointer(), buffer.getActiveSize()),
                              [protocol, self = shared_from_this()](const boost::system::error_code &ec,
                                                                    size_t transferredBytes) {
@@ -177,9 +190,10 @@ void TCPConnection::doWrite() {
 }
 
 void TCPConnection::handleWrite(const boost::system::error_code &ec, size_t transferredBytes) {
+    writeUnblocked();
     if (ec) {
         if (ec != boost::asio::error::operation_aborted) {
-            NET4CXX_LOG_ERROR(gGenLog, "Write error %d :%s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Write error %d :%s", ec.value(), ec.message().c_str());
         }
         if (!_disconnected) {
             if (ec == boost::asio::error::operation_aborted) {
@@ -191,9 +205,13 @@ void TCPConnection::handleWrite(const boost::system::error_code &ec, size_t tran
         }
     } else {
         if (transferredBytes > 0) {
+            writeCompleted(transferredBytes);
             _writeQueue.front().readCompleted(transferredBytes);
             if (!_writeQueue.front().getActiveSize()) {
                 _writeQueue.pop_front();
+                if (_writeQueue.empty()) {
+                    writeDrained();
+                }
             }
         }
         if ((_disconnecting && _writeQueue.empty()) || _aborting) {
@@ -232,15 +250,15 @@ void TCPClientConnection::closeSocket() {
 
 
 TCPListener::TCPListener(std::string port, std::shared_ptr<Factory> factory, std::string interface,
-                         Reactor *reactor)
+                         Reactor *reactor, ListenParams listenParams)
         : Listener(reactor)
         , _port(std::move(port))
         , _factory(std::move(factory))
         , _interface(std::move(interface))
-        , _acceptor(reactor->getService()) {
-#ifdef NET4CXX_DEBUG
-    NET4CXX_Watcher->inc(NET4CXX_TCPListener_COUNT);
-#endif
+        , _listenParams(std::move(listenParams))
+        , _acceptor(reactor->getService())
+        , _protocolType(boost::asio::ip::tcp::v4()) {
+    gTCPListenerCount->inc();
     if (_interface.empty()) {
 //        _interface = "::";
         _interface = "0.0.0.0";
@@ -256,14 +274,28 @@ void TCPListener::startListening() {
         ResolverType::query query(_interface, _port);
         endpoint = *resolver.resolve(query);
     }
-    _acceptor.open(endpoint.protocol());
+    _protocolType = endpoint.protocol();
+    _acceptor.open(_protocolType);
     _acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+#ifdef TCP_DEFER_ACCEPT
+    if (_listenParams.getDeferAccept() > 0) {
+        int deferAccept = _listenParams.getDeferAccept();
+        if (::setsockopt(_acceptor.native_handle(), IPPROTO_TCP, TCP_DEFER_ACCEPT, &deferAccept,
+                         sizeof(deferAccept)) != 0) {
+            boost::system::error_code ec(errno, boost::asio::error::get_system_category());
+            throw boost::system::system_error(ec, "setsockopt TCP_DEFER_ACCEPT");
+        }
+    }
+#endif
     _acceptor.bind(endpoint);
-    _acceptor.listen();
+    _acceptor.listen(_listenParams.getBacklog());
+    _acceptor.non_blocking(true);
     NET4CXX_LOG_INFO(gGenLog, "TCPListener starting on %s", _port.c_str());
     _factory->doStart();
     _connected = true;
-    doAccept();
+    for (size_t i = 0; i != _listenParams.getAcceptCount(); ++i) {
+        doAccept();
+    }
 }
 
 void TCPListener::stopListening() {
@@ -275,28 +307,68 @@ void TCPListener::stopListening() {
     }
 }
 
-void TCPListener::cbAccept(const boost::system::error_code &ec) {
-    handleAccept(ec);
+void TCPListener::cbAccept(const boost::system::error_code &ec, std::shared_ptr<TCPServerConnection> connection) {
+    handleAccept(ec, connection);
     if (!_connected) {
         return;
     }
+    if (!ec) {
+        drainAccept();
+        if (!_connected) {
+            return;
+        }
+    }
     doAccept();
 }
 
-void TCPListener::handleAccept(const boost::system::error_code &ec) {
+void TCPListener::handleAccept(const boost::system::error_code &ec,
+                               const std::shared_ptr<TCPServerConnection> &connection) {
     if (ec) {
         if (ec != boost::asio::error::operation_aborted) {
-            NET4CXX_LOG_ERROR(gGenLog, "Accept error %d: %s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Accept error %d: %s", ec.value(), ec.message().c_str());
         }
     } else {
-        Address address{_connection->getRemoteAddress(), _connection->getRemotePort()};
+        Address address{connection->getRemoteAddress(), connection->getRemotePort()};
         auto protocol = _factory->buildProtocol(address);
         if (protocol) {
             protocol->setFactory(_factory);
-            _connection->cbAccept(protocol);
+            connection->cbAccept(protocol);
         }
     }
-    _connection.reset();
+}
+
+void TCPListener::drainAccept() {
+    boost::system::error_code ec;
+    for (size_t i = 1; i < _listenParams.getMaxAcceptsPerCall() && _connected; ++i) {
+        auto connection = std::make_shared<TCPServerConnection>(_reactor);
+        acceptNonBlocking(connection->getSocket(), ec);
+        if (ec == boost::asio::error::would_block || ec == boost::asio::error::try_again) {
+            break;
+        }
+        handleAccept(ec, connection);
+        if (ec) {
+            break;
+        }
+    }
+}
+
+void TCPListener::acceptNonBlocking(SocketType &socket, boost::system::error_code &ec) {
+#if PLATFORM == PLATFORM_UNIX && defined(SOCK_NONBLOCK)
+    int fd;
+    do {
+        fd = ::accept4(_acceptor.native_handle(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    } while (fd < 0 && errno == EINTR);
+    if (fd < 0) {
+        ec.assign(errno, boost::asio::error::get_system_category());
+        return;
+    }
+    socket.assign(_protocolType, fd, ec);
+    if (ec) {
+        ::close(fd);
+    }
+#else
+    _acceptor.accept(socket, ec);
+#endif
 }
 
 
@@ -308,10 +380,8 @@ TCPConnector::TCPConnector(std::string host, std::string port, std::shared_ptr<C
         , _factory(std::move(factory))
         , _timeout(timeout)
         , _bindAddress(std::move(bindAddress))
-        , _resolver(reactor->getService()) {
-#ifdef NET4CXX_DEBUG
-    NET4CXX_Watcher->inc(NET4CXX_TCPConnector_COUNT);
-#endif
+        , _attempts(this, gTCPConnectTime) {
+    gTCPConnectorCount->inc();
 }
 
 void TCPConnector::startConnecting() {
@@ -341,11 +411,14 @@ void TCPConnector::stopConnecting() {
         NET4CXX_THROW_EXCEPTION(NotConnectingError, "We're not trying to connect");
     }
     _error = NET4CXX_EXCEPTION_PTR(UserAbort, "");
-    if (_connection) {
-        _connection->getSocket().close();
-        _connection.reset();
-    } else {
-        _resolver.cancel();
+    if (!_attempts.empty()) {
+        _attempts.abort();
+    } else if (_resolver) {
+        _resolver->cancel();
+        _resolver.reset();
+        _reactor->addCallback([this, self=shared_from_this()]() {
+            connectionFailed();
+        });
     }
     _state = kDisconnected;
 }
@@ -355,6 +428,11 @@ void TCPConnector::connectionFailed(std::exception_ptr reason) {
         _error = std::move(reason);
     }
     cancelTimeout();
+    if (_resolver) {
+        _resolver->cancel();
+        _resolver.reset();
+    }
+    _attempts.clear();
     _connection.reset();
     _state = kDisconnected;
     _factory->clientConnectionFailed(shared_from_this(), _error);
@@ -383,44 +461,72 @@ ProtocolPtr TCPConnector::buildProtocol(const Address &address) {
 }
 
 void TCPConnector::doResolve() {
-    ResolverType::query query(_host, _port);
-    _resolver.async_resolve(query, [this, self=shared_from_this()](
-            const boost::system::error_code &ec, ResolverIterator iterator) {
-        cbResolve(ec, std::move(iterator));
+    _resolver = std::make_shared<Resolver>(_reactor);
+    _resolver->resolveAddresses(_host, [this, self=shared_from_this()](const boost::system::error_code &ec,
+                                                                       const Resolver::AddressList &addresses) {
+        cbResolve(ec, addresses);
     });
 }
 
-void TCPConnector::handleResolve(const boost::system::error_code &ec, ResolverIterator iterator) {
-    if (ec) {
+void TCPConnector::handleResolve(const boost::system::error_code &ec, const Resolver::AddressList &addresses) {
+    if (ec || addresses.empty()) {
         if (ec != boost::asio::error::operation_aborted) {
-            NET4CXX_LOG_ERROR(gGenLog, "Resolve error %d :%s", ec.value(), ec.message().c_str());
-            _error = std::make_exception_ptr(boost::system::system_error(ec));
+            boost::system::error_code error = ec ? ec : boost::asio::error::host_not_found;
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Resolve error %d :%s", error.value(), error.message().c_str());
+            _error = std::make_exception_ptr(boost::system::system_error(error));
         }
         connectionFailed();
+        return;
+    }
+    if (_state != kConnecting) {
+        return;
+    }
+    boost::system::error_code error;
+    auto endpoints = makeEndpoints(addresses, error);
+    if (error) {
+        NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Unknown service %s: %s", _port.c_str(), error.message().c_str());
+        connectionFailed(std::make_exception_ptr(boost::system::system_error(error)));
+        return;
+    }
+    doConnect(std::move(endpoints));
+}
+
+TCPConnector::EndpointList TCPConnector::makeEndpoints(const Resolver::AddressList &addresses,
+                                                       boost::system::error_code &ec) const {
+    EndpointList endpoints;
+    unsigned short port = NetUtil::getServicePort(_port, ec);
+    if (ec) {
+        return endpoints;
+    }
+    for (auto &address: addresses) {
+        endpoints.emplace_back(address, port);
     }
+    return endpoints;
 }
 
 void TCPConnector::doConnect() {
-    makeTransport();
     EndpointType endpoint{AddressType::from_string(_host), (unsigned short)std::stoul(_port)};
-    _connection->getSocket().async_connect(endpoint, [this, self=shared_from_this(), connection=_connection](
-            const boost::system::error_code &ec) {
-        cbConnect(ec);
-    });
+    doConnect(EndpointList{endpoint});
 }
 
-void TCPConnector::doConnect(ResolverIterator iterator) {
-    makeTransport();
-    boost::asio::async_connect(_connection->getSocket(), std::move(iterator), [this, self=shared_from_this(),
-            connection=_connection](const boost::system::error_code &ec, ResolverIterator iterator) {
-        cbConnect(ec);
-    });
+void TCPConnector::doConnect(EndpointList endpoints) {
+    if (!_bindAddress.getAddress().empty()) {
+        bool v4 = AddressType::from_string(_bindAddress.getAddress()).is_v4();
+        endpoints.erase(std::remove_if(endpoints.begin(), endpoints.end(), [v4](const EndpointType &endpoint) {
+            return endpoint.address().is_v4() != v4;
+        }), endpoints.end());
+        if (endpoints.empty()) {
+            handleConnect(boost::asio::error::address_family_not_supported);
+            return;
+        }
+    }
+    _attempts.start(endpoints);
 }
 
 void TCPConnector::handleConnect(const boost::system::error_code &ec) {
     if (ec) {
         if (ec != boost::asio::error::operation_aborted) {
-            NET4CXX_LOG_ERROR(gGenLog, "Connect error %d :%s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Connect error %d :%s", ec.value(), ec.message().c_str());
             _error = std::make_exception_ptr(boost::system::system_error(ec));
         }
         connectionFailed();
@@ -439,18 +545,22 @@ void TCPConnector::handleConnect(const boost::system::error_code &ec) {
 }
 
 void TCPConnector::handleTimeout() {
-    NET4CXX_LOG_ERROR(gGenLog, "Connect error : Timeout");
+    NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Connect error : Timeout");
     _error = NET4CXX_EXCEPTION_PTR(TimeoutError, "");
     connectionFailed();
 }
 
-void TCPConnector::makeTransport() {
-    _connection = std::make_shared<TCPClientConnection>(_reactor);
+std::shared_ptr<TCPClientConnection> TCPConnector::makeTransport(bool exclusiveBind, boost::system::error_code &ec) {
+    auto connection = std::make_shared<TCPClientConnection>(_reactor);
     if (!_bindAddress.getAddress().empty()) {
-        EndpointType endpoint{AddressType::from_string(_bindAddress.getAddress()), _bindAddress.getPort()};
-        _connection->getSocket().open(endpoint.protocol());
-        _connection->getSocket().bind(endpoint);
+        unsigned short port = exclusiveBind ? _bindAddress.getPort() : (unsigned short)0;
+        EndpointType endpoint{AddressType::from_string(_bindAddress.getAddress()), port};
+        connection->getSocket().open(endpoint.protocol(), ec);
+        if (!ec) {
+            connection->getSocket().bind(endpoint, ec);
+        }
     }
+    return connection;
 }
 
 NS_END
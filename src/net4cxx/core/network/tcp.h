@@ -7,9 +7,9 @@
 
 #include "net4cxx/common/common.h"
 #include <boost/asio.hpp>
-#include "net4cxx/common/debugging/watcher.h"
 #include "net4cxx/common/global/loggers.h"
 #include "net4cxx/core/network/base.h"
+#include "net4cxx/core/network/resolver.h"
 
 NS_BEGIN
 
@@ -29,6 +29,8 @@ public:
 
     void write(const Byte *data, size_t length) override;
 
+    void write(MessageBuffer &&data) override;
+
     void loseConnection() override;
 
     void abortConnection() override;
@@ -126,16 +128,12 @@ class NET4CXX_COMMON_API TCPServerConnection: public TCPConnection {
 public:
     explicit TCPServerConnection(Reactor *reactor)
             : TCPConnection({}, reactor) {
-#ifdef NET4CXX_DEBUG
-        NET4CXX_Watcher->inc(NET4CXX_TCPServerConnection_COUNT);
-#endif
+        gTCPServerConnectionCount->inc();
     }
 
-#ifdef NET4CXX_DEBUG
     ~TCPServerConnection() override {
-        NET4CXX_Watcher->dec(NET4CXX_TCPServerConnection_COUNT);
+        gTCPServerConnectionCount->dec();
     }
-#endif
 
     void cbAccept(const ProtocolPtr &protocol);
 };
@@ -145,16 +143,12 @@ class NET4CXX_COMMON_API TCPClientConnection: public TCPConnection {
 public:
     explicit TCPClientConnection(Reactor *reactor)
             : TCPConnection({}, reactor) {
-#ifdef NET4CXX_DEBUG
-        NET4CXX_Watcher->inc(NET4CXX_TCPClientConnection_COUNT);
-#endif
+        gTCPClientConnectionCount->inc();
     }
 
-#ifdef NET4CXX_DEBUG
     ~TCPClientConnection() override {
-        NET4CXX_Watcher->dec(NET4CXX_TCPClientConnection_COUNT);
+        gTCPClientConnectionCount->dec();
     }
-#endif
 
     void cbConnect(const ProtocolPtr &protocol, std::shared_ptr<TCPConnector> connector);
 protected:
@@ -173,13 +167,12 @@ public:
     using EndpointType = boost::asio::ip::tcp::endpoint;
     using ResolverIterator = ResolverType::iterator;
 
-    TCPListener(std::string port, std::shared_ptr<Factory> factory, std::string interface, Reactor *reactor);
+    TCPListener(std::string port, std::shared_ptr<Factory> factory, std::string interface, Reactor *reactor,
+                ListenParams listenParams={});
 
-#ifdef NET4CXX_DEBUG
     ~TCPListener() override {
-        NET4CXX_Watcher->dec(NET4CXX_TCPListener_COUNT);
+        gTCPListenerCount->dec();
     }
-#endif
 
     void startListening() override;
 
@@ -195,22 +188,30 @@ public:
         return endpoint.port();
     }
 protected:
-    void cbAccept(const boost::system::error_code &ec);
+    void cbAccept(const boost::system::error_code &ec, std::shared_ptr<TCPServerConnection> connection);
 
-    void handleAccept(const boost::system::error_code &ec);
+    void handleAccept(const boost::system::error_code &ec, const std::shared_ptr<TCPServerConnection> &connection);
 
     void doAccept() {
-        _connection = std::make_shared<TCPServerConnection>(_reactor);
-        _acceptor.async_accept(_connection->getSocket(), std::bind(&TCPListener::cbAccept, shared_from_this(),
-                                                                   std::placeholders::_1));
+        auto connection = std::make_shared<TCPServerConnection>(_reactor);
+        auto &socket = connection->getSocket();
+        _acceptor.async_accept(socket, [self = shared_from_this(), connection = std::move(connection)](
+                const boost::system::error_code &ec) mutable {
+            self->cbAccept(ec, std::move(connection));
+        });
     }
 
+    void drainAccept();
+
+    void acceptNonBlocking(SocketType &socket, boost::system::error_code &ec);
+
     std::string _port;
     std::shared_ptr<Factory> _factory;
     std::string _interface;
+    ListenParams _listenParams;
     AcceptorType _acceptor;
+    EndpointType::protocol_type _protocolType;
     bool _connected{false};
-    std::shared_ptr<TCPServerConnection> _connection;
 };
 
 
@@ -221,15 +222,14 @@ public:
     using ResolverType = boost::asio::ip::tcp::resolver;
     using ResolverIterator = ResolverType::iterator;
     using EndpointType = boost::asio::ip::tcp::endpoint;
+    using EndpointList = std::vector<EndpointType>;
 
     TCPConnector(std::string host, std::string port, std::shared_ptr<ClientFactory> factory, double timeout,
                  Address bindAddress, Reactor *reactor);
 
-#ifdef NET4CXX_DEBUG
     ~TCPConnector() override {
-        NET4CXX_Watcher->dec(NET4CXX_TCPConnector_COUNT);
+        gTCPConnectorCount->dec();
     }
-#endif
 
     void startConnecting() override;
 
@@ -238,7 +238,29 @@ public:
     void connectionFailed(std::exception_ptr reason={});
 
     void connectionLost(std::exception_ptr reason={});
+
+    void setAttemptDelay(double attemptDelay) {
+        _attempts.setAttemptDelay(attemptDelay);
+    }
+
+    double getAttemptDelay() const {
+        return _attempts.getAttemptDelay();
+    }
+
+    Duration getConnectDuration() const {
+        return _attempts.getConnectDuration();
+    }
+
+    size_t getConnectAttempts() const {
+        return _attempts.getConnectAttempts();
+    }
 protected:
+    friend class ConnectAttempts<TCPConnector, TCPClientConnection>;
+
+    bool isConnecting() const {
+        return _state == kConnecting;
+    }
+
     ProtocolPtr buildProtocol(const Address &address);
 
     void cancelTimeout() {
@@ -249,20 +271,21 @@ protected:
 
     void doResolve();
 
-    void cbResolve(const boost::system::error_code &ec, ResolverIterator iterator) {
-        handleResolve(ec, iterator);
-        if (_state == kConnecting) {
-            doConnect(std::move(iterator));
-        }
+    void cbResolve(const boost::system::error_code &ec, const Resolver::AddressList &addresses) {
+        _resolver.reset();
+        handleResolve(ec, addresses);
     }
 
-    void handleResolve(const boost::system::error_code &ec, ResolverIterator iterator);
+    void handleResolve(const boost::system::error_code &ec, const Resolver::AddressList &addresses);
+
+    EndpointList makeEndpoints(const Resolver::AddressList &addresses, boost::system::error_code &ec) const;
 
     void doConnect();
 
-    void doConnect(ResolverIterator iterator);
+    void doConnect(EndpointList endpoints);
 
-    void cbConnect(const boost::system::error_code &ec) {
+    void cbConnect(const boost::system::error_code &ec, std::shared_ptr<TCPClientConnection> connection) {
+        _connection = std::move(connection);
         handleConnect(ec);
     }
 
@@ -274,7 +297,7 @@ protected:
 
     void handleTimeout();
 
-    void makeTransport();
+    std::shared_ptr<TCPClientConnection> makeTransport(bool exclusiveBind, boost::system::error_code &ec);
 
     enum State {
         kDisconnected,
@@ -287,8 +310,9 @@ protected:
     std::shared_ptr<ClientFactory> _factory;
     double _timeout{0.0};
     Address _bindAddress;
-    ResolverType _resolver;
+    std::shared_ptr<Resolver> _resolver;
     std::shared_ptr<TCPClientConnection> _connection;
+    ConnectAttempts<TCPConnector, TCPClientConnection> _attempts;
     State _state{kDisconnected};
     DelayedCall _timeoutId;
     bool _factoryStarted{false};
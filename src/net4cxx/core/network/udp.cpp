@@ -17,9 +17,7 @@ UDPConnection::UDPConnection(unsigned short port, const DatagramProtocolPtr &pro
                              reactor)
         , _socket(reactor->getService())
         , _listenMultiple(listenMultiple) {
-#ifdef NET4CXX_DEBUG
-    NET4CXX_Watcher->inc(NET4CXX_UDPConnection_COUNT);
-#endif
+    gUDPConnectionCount->inc();
 }
 
 UDPConnection::UDPConnection(std::string address, unsigned short port, const DatagramProtocolPtr &protocol,
@@ -27,9 +25,7 @@ UDPConnection::UDPConnection(std::string address, unsigned short port, const Dat
         : DatagramConnection({std::move(address), port}, protocol, maxPacketSize, std::move(bindAddress), reactor)
         , _socket(reactor->getService())
         , _listenMultiple(listenMultiple) {
-#ifdef NET4CXX_DEBUG
-    NET4CXX_Watcher->inc(NET4CXX_UDPConnection_COUNT);
-#endif
+    gUDPConnectionCount->inc();
 }
 
 void UDPConnection::write(const Byte *datagram, size_t length, const Address &address) {
@@ -132,7 +128,7 @@ void UDPConnection::doRead() {
 void UDPConnection::handleRead(const boost::system::error_code &ec, size_t transferredBytes) {
     if (ec) {
         if (ec != boost::asio::error::operation_aborted) {
-            NET4CXX_LOG_ERROR(gGenLog, "Read error %d :%s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Read error %d :%s", ec.value(), ec.message().c_str());
             if (_connectedAddress) {
                 connectionRefused();
             }
@@ -167,7 +163,7 @@ void UDPConnection::connectSocket() {
         EndpointType endpoint{AddressType::from_string(_connectedAddress.getAddress()), _connectedAddress.getPort()};
         _socket.connect(endpoint);
     } catch (boost::system::system_error &e) {
-        NET4CXX_LOG_ERROR(gGenLog, "Connect error %d: %s", e.code().value(), e.code().message().c_str());
+        NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Connect error %d: %s", e.code().value(), e.code().message().c_str());
         throw;
     }
 }
@@ -7,7 +7,6 @@
 
 #include "net4cxx/common/common.h"
 #include <boost/asio.hpp>
-#include "net4cxx/common/debugging/watcher.h"
 #include "net4cxx/common/global/loggers.h"
 #include "net4cxx/core/network/base.h"
 
@@ -26,11 +25,9 @@ public:
     UDPConnection(std::string address, unsigned short port, const DatagramProtocolPtr &protocol, size_t maxPacketSize,
                   Address bindAddress, bool listenMultiple, Reactor *reactor);
 
-#ifdef NET4CXX_DEBUG
     ~UDPConnection() override {
-        NET4CXX_Watcher->dec(NET4CXX_UDPConnection_COUNT);
+        gUDPConnectionCount->dec();
     }
-#endif
 
     void write(const Byte *datagram, size_t length, const Address &address) override;
 
@@ -23,7 +23,16 @@ void UNIXConnection::write(const Byte *data, size_t length) {
     }
     MessageBuffer packet(length);
     packet.write(data, length);
-    _writeQueue.emplace_back(std::move(packet));
+    write(std::move(packet));
+}
+
+void UNIXConnection::write(MessageBuffer &&data) {
+    if (_disconnecting || _disconnected || !_connected) {
+        return;
+    }
+    size_t length = data.getActiveSize();
+    _writeQueue.emplace_back(std::move(data));
+    writeQueued(length);
     startWriting();
 }
 
@@ -48,7 +57,7 @@ void UNIXConnection::abortConnection() {
 
 void UNIXConnection::doClose() {
     if (!_writing && !_reading) {
-        _reactor->addCallback([this, self=shared_from_this()]() {
+        _reactor->addCallback([this, protocol = _protocol.lock(), self = shared_from_this()]() {
             if (!_disconnected) {
                 closeSocket();
             }
@@ -60,7 +69,7 @@ void UNIXConnection::doClose() {
 
 void UNIXConnection::doAbort() {
     if (!_writing && !_reading) {
-        _reactor->addCallback([this, self=shared_from_this()]() {
+        _reactor->addCallback([this, protocol = _protocol.lock(), self = shared_from_this()]() {
             if (!_disconnected) {
                 closeSocket();
             }
@@ -97,7 +106,7 @@ void UNIXConnection::doRead() {
 void UNIXConnection::handleRead(const boost::system::error_code &ec, size_t transferredBytes) {
     if (ec) {
         if (ec != boost::asio::error::operation_aborted && ec != boost::asio::error::eof) {
-            NET4CXX_LOG_ERROR(gGenLog, "Read error %d :%s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Read error %d :%s", ec.value(), ec.message().c_str());
         }
         if (!_disconnected) {
             if (ec == boost::asio::error::operation_aborted) {
@@ -130,7 +139,7 @@ void UNIXConnection::doWrite() {
             if (ec == boost::asio::error::would_block || ec == boost::asio::error::try_again) {
                 break;
             } else {
-                NET4CXX_LOG_ERROR(gGenLog, "Write error %d :%s", ec.value(), ec.message().c_str());
+                NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Write error %d :%s", ec.value(), ec.message().c_str());
             }
             _error = std::make_exception_ptr(boost::system::system_error(ec));
             _disconnecting = true;
@@ -140,12 +149,15 @@ void UNIXConnection::doWrite() {
             _disconnecting = true;
             doClose();
             return;
-        } else if (bytesSent < bytesToSend) {
+        }
+        writeCompleted(bytesSent);
+        if (bytesSent < bytesToSend) {
             buffer.readCompleted(bytesSent);
             break;
         }
         _writeQueue.pop_front();
         if (_writeQueue.empty()) {
+            writeDrained();
             return;
         }
     }
@@ -153,6 +165,7 @@ void UNIXConnection::doWrite() {
     auto protocol = _protocol.lock();
     NET4CXX_ASSERT(protocol);
     _writing = true;
+    writeBlocked();
     _socket.async_write_some(boost::asio::buffer(buffer.getReadPointer(), buffer.getActiveSize()),
                              [protocol, self = shared_from_this()](const boost::system::error_code &ec,
                                                                    size_t transferredBytes) {
@@ -161,9 +174,10 @@ void UNIXConnection::doWrite() {
 }
 
 void UNIXConnection::handleWrite(const boost::system::error_code &ec, size_t transferredBytes) {
+    writeUnblocked();
     if (ec) {
         if (ec != boost::asio::error::operation_aborted) {
-            NET4CXX_LOG_ERROR(gGenLog, "Write error %d :%s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Write error %d :%s", ec.value(), ec.message().c_str());
         }
         if (!_disconnected) {
             if (ec == boost::asio::error::operation_aborted) {
@@ -175,9 +189,13 @@ void UNIXConnection::handleWrite(const boost::system::error_code &ec, size_t tra
         }
     } else {
         if (transferredBytes > 0) {
+            writeCompleted(transferredBytes);
             _writeQueue.front().readCompleted(transferredBytes);
             if (!_writeQueue.front().getActiveSize()) {
                 _writeQueue.pop_front();
+                if (_writeQueue.empty()) {
+                    writeDrained();
+                }
             }
         }
         if ((_disconnecting && _writeQueue.empty()) || _aborting) {
@@ -220,9 +238,7 @@ UNIXListener::UNIXListener(std::string path, std::shared_ptr<Factory> factory, R
         , _path(std::move(path))
         , _factory(std::move(factory))
         , _acceptor(reactor->getService()) {
-#ifdef NET4CXX_DEBUG
-    NET4CXX_Watcher->inc(NET4CXX_UNIXListener_COUNT);
-#endif
+    gUNIXListenerCount->inc();
 }
 
 void UNIXListener::startListening() {
@@ -258,7 +274,7 @@ void UNIXListener::cbAccept(const boost::system::error_code &ec) {
 void UNIXListener::handleAccept(const boost::system::error_code &ec) {
     if (ec) {
         if (ec != boost::asio::error::operation_aborted) {
-            NET4CXX_LOG_ERROR(gGenLog, "Accept error %d: %s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Accept error %d: %s", ec.value(), ec.message().c_str());
         }
     } else {
         Address address{_connection->getRemoteAddress(), _connection->getRemotePort()};
@@ -278,9 +294,7 @@ UNIXConnector::UNIXConnector(std::string path, std::shared_ptr<ClientFactory> fa
         , _path(std::move(path))
         , _factory(std::move(factory))
         , _timeout(timeout) {
-#ifdef NET4CXX_DEBUG
-    NET4CXX_Watcher->inc(NET4CXX_UNIXConnector_COUNT);
-#endif
+    gUNIXConnectorCount->inc();
 }
 
 void UNIXConnector::startConnecting() {
@@ -356,7 +370,7 @@ void UNIXConnector::doConnect() {
 void UNIXConnector::handleConnect(const boost::system::error_code &ec) {
     if (ec) {
         if (ec != boost::asio::error::operation_aborted) {
-            NET4CXX_LOG_ERROR(gGenLog, "Connect error %d :%s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Connect error %d :%s", ec.value(), ec.message().c_str());
             _error = std::make_exception_ptr(boost::system::system_error(ec));
         }
         connectionFailed();
@@ -375,7 +389,7 @@ void UNIXConnector::handleConnect(const boost::system::error_code &ec) {
 }
 
 void UNIXConnector::handleTimeout() {
-    NET4CXX_LOG_ERROR(gGenLog, "Connect error : Timeout");
+    NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Connect error : Timeout");
     _error = NET4CXX_EXCEPTION_PTR(TimeoutError, "");
     connectionFailed();
 }
@@ -389,18 +403,14 @@ UNIXDatagramConnection::UNIXDatagramConnection(std::string path, const DatagramP
                                                size_t maxPacketSize, Reactor *reactor)
         : DatagramConnection({std::move(path)}, protocol, maxPacketSize, reactor)
         , _socket(reactor->getService(), SocketType::protocol_type()) {
-#ifdef NET4CXX_DEBUG
-    NET4CXX_Watcher->inc(NET4CXX_UNIXDatagramConnection_COUNT);
-#endif
+    gUNIXDatagramConnectionCount->inc();
 }
 
 UNIXDatagramConnection::UNIXDatagramConnection(std::string path, const DatagramProtocolPtr &protocol,
                                                size_t maxPacketSize, std::string bindPath, Reactor *reactor)
         : DatagramConnection({std::move(path)}, protocol, maxPacketSize, {std::move(bindPath)}, reactor)
         , _socket(reactor->getService(), SocketType::protocol_type()) {
-#ifdef NET4CXX_DEBUG
-    NET4CXX_Watcher->inc(NET4CXX_UNIXDatagramConnection_COUNT);
-#endif
+    gUNIXDatagramConnectionCount->inc();
 }
 
 void UNIXDatagramConnection::write(const Byte *datagram, size_t length, const Address &address) {
@@ -499,7 +509,7 @@ void UNIXDatagramConnection::doRead() {
 void UNIXDatagramConnection::handleRead(const boost::system::error_code &ec, size_t transferredBytes) {
     if (ec) {
         if (ec != boost::asio::error::operation_aborted) {
-            NET4CXX_LOG_ERROR(gGenLog, "Read error %d :%s", ec.value(), ec.message().c_str());
+            NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Read error %d :%s", ec.value(), ec.message().c_str());
             if (_connectedAddress) {
                 connectionRefused();
             }
@@ -531,7 +541,7 @@ void UNIXDatagramConnection::connectSocket() {
         EndpointType endpoint{_connectedAddress.getAddress()};
         _socket.connect(endpoint);
     } catch (boost::system::system_error &e) {
-        NET4CXX_LOG_ERROR(gGenLog, "Connect error %d: %s", e.code().value(), e.code().message().c_str());
+        NET4CXX_LOG_ERROR_LIMITED(gGenLog, "Connect error %d: %s", e.code().value(), e.code().message().c_str());
         throw;
     }
 }
@@ -7,7 +7,6 @@
 
 #include "net4cxx/common/common.h"
 #include <boost/asio.hpp>
-#include "net4cxx/common/debugging/watcher.h"
 #include "net4cxx/common/global/loggers.h"
 #include "net4cxx/core/network/base.h"
 
@@ -32,6 +31,8 @@ public:
 
     void write(const Byte *data, size_t length) override;
 
+    void write(MessageBuffer &&data) override;
+
     void loseConnection() override;
 
     void abortConnection() override;
@@ -124,16 +125,12 @@ class NET4CXX_COMMON_API UNIXServerConnection: public UNIXConnection {
 public:
     explicit UNIXServerConnection(Reactor *reactor)
             : UNIXConnection({}, reactor) {
-#ifdef NET4CXX_DEBUG
-        NET4CXX_Watcher->inc(NET4CXX_UNIXServerConnection_COUNT);
-#endif
+        gUNIXServerConnectionCount->inc();
     }
 
-#ifdef NET4CXX_DEBUG
     ~UNIXServerConnection() override {
-        NET4CXX_Watcher->dec(NET4CXX_UNIXServerConnection_COUNT);
+        gUNIXServerConnectionCount->dec();
     }
-#endif
 
     void cbAccept(const ProtocolPtr &protocol);
 };
@@ -143,16 +140,12 @@ class NET4CXX_COMMON_API UNIXClientConnection: public UNIXConnection {
 public:
     explicit UNIXClientConnection(Reactor *reactor)
             : UNIXConnection({}, reactor) {
-#ifdef NET4CXX_DEBUG
-        NET4CXX_Watcher->inc(NET4CXX_UNIXClientConnection_COUNT);
-#endif
+        gUNIXClientConnectionCount->inc();
     }
 
-#ifdef NET4CXX_DEBUG
     ~UNIXClientConnection() override {
-        NET4CXX_Watcher->dec(NET4CXX_UNIXClientConnection_COUNT);
+        gUNIXClientConnectionCount->dec();
     }
-#endif
 
     void cbConnect(const ProtocolPtr &protocol, std::shared_ptr<UNIXConnector> connector);
 protected:
@@ -170,11 +163,9 @@ public:
 
     UNIXListener(std::string path, std::shared_ptr<Factory> factory, Reactor *reactor);
 
-#ifdef NET4CXX_DEBUG
     ~UNIXListener() override {
-        NET4CXX_Watcher->dec(NET4CXX_UNIXListener_COUNT);
+        gUNIXListenerCount->dec();
     }
-#endif
 
     void startListening() override;
 
@@ -214,11 +205,9 @@ public:
 
     UNIXConnector(std::string path, std::shared_ptr<ClientFactory> factory, double timeout, Reactor *reactor);
 
-#ifdef NET4CXX_DEBUG
     ~UNIXConnector() override {
-        NET4CXX_Watcher->dec(NET4CXX_UNIXConnector_COUNT);
+        gUNIXConnectorCount->dec();
     }
-#endif
 
     void startConnecting() override;
 
@@ -281,11 +270,9 @@ public:
     UNIXDatagramConnection(std::string path, const DatagramProtocolPtr &protocol, size_t maxPacketSize,
                            std::string bindPath, Reactor *reactor);
 
-#ifdef NET4CXX_DEBUG
     ~UNIXDatagramConnection() override {
-        NET4CXX_Watcher->dec(NET4CXX_UNIXDatagramConnection_COUNT);
+        gUNIXDatagramConnectionCount->dec();
     }
-#endif
 
     void write(const Byte *datagram, size_t length, const Address &address) override;
 
@@ -14,6 +14,7 @@
 #include "net4cxx/common/crypto/hashlib.h"
 #include "net4cxx/common/debugging/assert.h"
 #include "net4cxx/common/debugging/crashreport.h"
+#include "net4cxx/common/debugging/metrics.h"
 #include "net4cxx/common/debugging/watcher.h"
 #include "net4cxx/common/global/initialize.h"
 #include "net4cxx/common/global/loggers.h"
@@ -27,7 +28,9 @@
 #include "net4cxx/common/utilities/random.h"
 #include "net4cxx/common/utilities/util.h"
 
+#include "net4cxx/core/network/basic.h"
 #include "net4cxx/core/network/endpoints.h"
+#include "net4cxx/core/network/metricsserver.h"
 #include "net4cxx/core/network/unix.h"
 #include "net4cxx/core/network/protocol.h"
 #include "net4cxx/core/network/reactor.h"
@@ -35,6 +38,7 @@
 #include "net4cxx/core/network/tcp.h"
 #include "net4cxx/core/network/udp.h"
 
+#include "net4cxx/plugins/rpc/rpc.h"
 #include "net4cxx/plugins/websocket/websocket.h"
 
 #endif //NET4CXX_NET4CXX_H
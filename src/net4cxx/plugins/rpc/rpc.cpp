@@ -0,0 +1,225 @@
+//
+// Created by agent on 26-10-19.
+//
+
+#include "net4cxx/plugins/rpc/rpc.h"
+#include <boost/endian/conversion.hpp>
+#include "net4cxx/common/global/loggers.h"
+
+
+NS_BEGIN
+
+const size_t RPCFrame::lengthSize;
+
+const size_t RPCFrame::headerSize;
+
+
+const size_t RPCProtocol::maxFrameSize;
+
+void RPCProtocol::dataReceived(Byte *data, size_t length) {
+    try {
+        if (_buffer.getActiveSize() == 0) {
+            // Common case: parse straight from the read buffer and only keep a trailing partial frame
+            size_t consumed = processFrames(data, length);
+            if (consumed != length) {
+                _buffer.reset();
+                _buffer.ensureFreeSpace(length - consumed);
+                _buffer.write(data + consumed, length - consumed);
+            }
+        } else {
+            _buffer.normalize();
+            _buffer.ensureFreeSpace(length);
+            _buffer.write(data, length);
+            _buffer.readCompleted(processFrames(_buffer.getReadPointer(), _buffer.getActiveSize()));
+            if (_buffer.getActiveSize() == 0) {
+                _buffer.reset();
+            }
+        }
+    } catch (ArchiveError &e) {
+        auto message = boost::get_error_info<errinfo_message>(e);
+        NET4CXX_LOG_ERROR(gGenLog, "Malformed RPC frame: %s", message ? message->c_str() : e.getTypeName());
+        _responses.clear();
+        _buffer.reset();
+        abortConnection();
+        return;
+    }
+    if (!_responses.empty()) {
+        write(std::move(_responses));
+        _responses.clear();
+    }
+}
+
+void RPCProtocol::connectionLost(std::exception_ptr reason) {
+    _connected = false;
+    auto pending = std::move(_pending);
+    _pending.clear();
+    for (auto &call: pending) {
+        if (!call.second.deadline.cancelled()) {
+            call.second.deadline.cancel();
+        }
+    }
+    for (auto &call: pending) {
+        call.second.callback(nullptr, reason);
+    }
+}
+
+uint32_t RPCProtocol::beginCall(OArchive &archive, const std::string &method, Callback &&callback, double timeout) {
+    if (!_connected) {
+        callback(nullptr, NET4CXX_EXCEPTION_PTR(ConnectionDone, "RPC connection is not established"));
+        return 0;
+    }
+    uint32_t requestId;
+    do {
+        requestId = ++_nextRequestId;
+    } while (requestId == 0 || _pending.find(requestId) != _pending.end());
+    auto &call = _pending[requestId];
+    call.callback = std::move(callback);
+    if (timeout > 0.0) {
+        std::weak_ptr<RPCProtocol> self = shared_from_this();
+        call.deadline = reactor()->callLater(timeout, [self, requestId]() {
+            auto protocol = self.lock();
+            if (protocol) {
+                protocol->handleTimeout(requestId);
+            }
+        });
+    }
+    beginFrame(archive, RPCFrame::REQUEST, requestId);
+    archive << boost::string_ref(method);
+    return requestId;
+}
+
+void RPCProtocol::beginFrame(OArchive &archive, RPCFrame::Kind kind, uint32_t requestId) {
+    // Fixed width whatever the archive format, the length is patched in by endFrame
+    std::array<Byte, RPCFrame::headerSize> header{};
+    header[RPCFrame::lengthSize] = kind;
+    requestId = boost::endian::native_to_little(requestId);
+    memcpy(header.data() + RPCFrame::lengthSize + 1, &requestId, sizeof(requestId));
+    archive << header;
+}
+
+void RPCProtocol::endFrame(OArchive &archive, size_t start) {
+    auto length = boost::endian::native_to_little((uint32_t)(archive.size() - start - RPCFrame::lengthSize));
+    memcpy(archive.contents() + start, &length, sizeof(length));
+}
+
+size_t RPCProtocol::processFrames(const Byte *data, size_t length) {
+    size_t offset = 0;
+    while (length - offset >= RPCFrame::lengthSize) {
+        uint32_t frameSize;
+        memcpy(&frameSize, data + offset, sizeof(frameSize));
+        boost::endian::little_to_native_inplace(frameSize);
+        if (frameSize > maxFrameSize) {
+            NET4CXX_THROW_EXCEPTION(ArchiveError, "RPC frame too large: " + std::to_string(frameSize));
+        }
+        if (length - offset - RPCFrame::lengthSize < frameSize) {
+            break;
+        }
+        handleFrame(data + offset + RPCFrame::lengthSize, frameSize);
+        offset += RPCFrame::lengthSize + frameSize;
+    }
+    return offset;
+}
+
+void RPCProtocol::handleFrame(const Byte *data, size_t length) {
+    if (length < RPCFrame::headerSize - RPCFrame::lengthSize) {
+        NET4CXX_THROW_EXCEPTION(ArchiveError, "Truncated RPC frame header");
+    }
+    auto kind = (RPCFrame::Kind)data[0];
+    uint32_t requestId;
+    memcpy(&requestId, data + 1, sizeof(requestId));
+    boost::endian::little_to_native_inplace(requestId);
+    IArchive archive(data + 1 + sizeof(requestId), length - 1 - sizeof(requestId), _format);
+    switch (kind) {
+        case RPCFrame::REQUEST: {
+            handleRequest(requestId, archive);
+            break;
+        }
+        case RPCFrame::RESPONSE:
+        case RPCFrame::FAILURE: {
+            handleResponse(kind, requestId, archive);
+            break;
+        }
+        default: {
+            NET4CXX_THROW_EXCEPTION(ArchiveError, "Unknown RPC frame kind: " + std::to_string((int)kind));
+        }
+    }
+}
+
+void RPCProtocol::handleRequest(uint32_t requestId, IArchive &request) {
+    std::string method;
+    request >> method;
+    size_t start = _responses.size();
+    OArchive response(std::move(_responses), _format);
+    beginFrame(response, RPCFrame::RESPONSE, requestId);
+    std::string error;
+    auto handler = _methods ? _methods->find(method) : nullptr;
+    if (!handler) {
+        error = "Unknown method: " + method;
+    } else {
+        try {
+            (*handler)(request, response);
+        } catch (Exception &e) {
+            auto message = boost::get_error_info<errinfo_message>(e);
+            error = message ? *message : e.getTypeName();
+        } catch (std::exception &e) {
+            error = e.what();
+        }
+    }
+    if (error.empty()) {
+        endFrame(response, start);
+        _responses = response.move();
+        return;
+    }
+    _responses = response.move();
+    _responses.resize(start);
+    OArchive failure(std::move(_responses), _format);
+    beginFrame(failure, RPCFrame::FAILURE, requestId);
+    failure << error;
+    endFrame(failure, start);
+    _responses = failure.move();
+}
+
+void RPCProtocol::handleResponse(RPCFrame::Kind kind, uint32_t requestId, IArchive &response) {
+    auto iter = _pending.find(requestId);
+    if (iter == _pending.end()) {
+        // Already timed out
+        return;
+    }
+    std::string message;
+    if (kind == RPCFrame::FAILURE) {
+        // Decoded while the call is still pending, so a malformed body fails it through connectionLost
+        response >> message;
+    }
+    auto call = std::move(iter->second);
+    _pending.erase(iter);
+    if (!call.deadline.cancelled()) {
+        call.deadline.cancel();
+    }
+    if (kind == RPCFrame::RESPONSE) {
+        call.callback(&response, nullptr);
+    } else {
+        call.callback(nullptr, NET4CXX_EXCEPTION_PTR(RPCError, message));
+    }
+}
+
+void RPCProtocol::handleTimeout(uint32_t requestId) {
+    auto iter = _pending.find(requestId);
+    if (iter == _pending.end()) {
+        return;
+    }
+    auto callback = std::move(iter->second.callback);
+    _pending.erase(iter);
+    callback(nullptr, NET4CXX_EXCEPTION_PTR(TimeoutError, "RPC call timed out"));
+}
+
+
+ProtocolPtr RPCFactory::buildProtocol(const Address &address) {
+    return std::make_shared<RPCProtocol>(_methods, _format);
+}
+
+
+ProtocolPtr RPCClientFactory::buildProtocol(const Address &address) {
+    return std::make_shared<RPCProtocol>(_methods, _format);
+}
+
+NS_END
@@ -0,0 +1,170 @@
+//
+// Created by agent on 26-10-19.
+//
+
+#ifndef NET4CXX_PLUGINS_RPC_RPC_H
+#define NET4CXX_PLUGINS_RPC_RPC_H
+
+#include "net4cxx/common/common.h"
+#include "net4cxx/common/serialization/iarchive.h"
+#include "net4cxx/common/serialization/oarchive.h"
+#include "net4cxx/common/utilities/messagebuffer.h"
+#include "net4cxx/core/network/protocol.h"
+#include "net4cxx/core/network/reactor.h"
+
+
+NS_BEGIN
+
+NET4CXX_DECLARE_EXCEPTION(RPCError, Exception);
+
+
+/// Frame layout: [u32 little-endian length of the rest][u8 kind][u32 request id][body].
+/// A request body is the method name followed by the arguments, a failure body is the error message.
+class NET4CXX_COMMON_API RPCFrame {
+public:
+    static const size_t lengthSize = 4;
+    static const size_t headerSize = 9;
+
+    enum Kind: uint8_t {
+        REQUEST = 0,
+        RESPONSE = 1,
+        FAILURE = 2,
+    };
+};
+
+
+class NET4CXX_COMMON_API RPCMethods {
+public:
+    /// Reads the arguments from request and writes the result to response, throw to reply with an error
+    using Handler = std::function<void (IArchive &request, OArchive &response)>;
+
+    void add(const std::string &name, Handler handler) {
+        _handlers[name] = std::move(handler);
+    }
+
+    const Handler* find(const std::string &name) const {
+        auto iter = _handlers.find(name);
+        return iter != _handlers.end() ? &iter->second : nullptr;
+    }
+protected:
+    std::unordered_map<std::string, Handler> _handlers;
+};
+
+using RPCMethodsPtr = std::shared_ptr<const RPCMethods>;
+
+
+/// Both ends may call and serve. Calls are pipelined and answered in any order, responses to all requests
+/// found in one read are flushed with a single write. Handlers run synchronously, and any exception they throw,
+/// an ArchiveError from parsing their arguments included, is answered with an RPCError. An ArchiveError while
+/// reading a frame header, a method name or a failure message, or escaping a response callback, is treated as a
+/// malformed frame and aborts the connection; pending calls then fail through connectionLost.
+class NET4CXX_COMMON_API RPCProtocol: public Protocol, public std::enable_shared_from_this<RPCProtocol> {
+public:
+    /// Exactly one of response and error is set
+    using Callback = std::function<void (IArchive *response, std::exception_ptr error)>;
+
+    static const size_t maxFrameSize = 16 * 1024 * 1024;
+
+    explicit RPCProtocol(RPCMethodsPtr methods=nullptr, ArchiveFormat format=ArchiveFormat::Fixed)
+            : _methods(std::move(methods))
+            , _format(format) {
+
+    }
+
+    void dataReceived(Byte *data, size_t length) override;
+
+    void connectionLost(std::exception_ptr reason) override;
+
+    /// Returns the request id, or 0 when not connected, in which case callback has already failed with
+    /// ConnectionDone. A timeout of 0 waits until the response arrives or the connection is lost.
+    template <typename RequestT>
+    uint32_t call(const std::string &method, RequestT &&request, Callback callback, double timeout=0.0) {
+        OArchive archive(_format);
+        uint32_t requestId = beginCall(archive, method, std::move(callback), timeout);
+        if (requestId) {
+            archive << request;
+            endFrame(archive, 0);
+            write(std::move(archive));
+        }
+        return requestId;
+    }
+
+    size_t getPendingCount() const {
+        return _pending.size();
+    }
+
+    RPCMethodsPtr getMethods() const {
+        return _methods;
+    }
+
+    ArchiveFormat getFormat() const {
+        return _format;
+    }
+
+    template <typename SelfT>
+    std::shared_ptr<SelfT> getSelf() {
+        return std::static_pointer_cast<SelfT>(shared_from_this());
+    }
+protected:
+    struct PendingCall {
+        Callback callback;
+        DelayedCall deadline;
+    };
+
+    uint32_t beginCall(OArchive &archive, const std::string &method, Callback &&callback, double timeout);
+
+    static void beginFrame(OArchive &archive, RPCFrame::Kind kind, uint32_t requestId);
+
+    static void endFrame(OArchive &archive, size_t start);
+
+    size_t processFrames(const Byte *data, size_t length);
+
+    void handleFrame(const Byte *data, size_t length);
+
+    void handleRequest(uint32_t requestId, IArchive &request);
+
+    void handleResponse(RPCFrame::Kind kind, uint32_t requestId, IArchive &response);
+
+    void handleTimeout(uint32_t requestId);
+
+    RPCMethodsPtr _methods;
+    ArchiveFormat _format;
+    uint32_t _nextRequestId{0};
+    std::unordered_map<uint32_t, PendingCall> _pending;
+    MessageBuffer _buffer{0};
+    ByteArray _responses;
+};
+
+
+class NET4CXX_COMMON_API RPCFactory: public Factory {
+public:
+    explicit RPCFactory(RPCMethodsPtr methods=nullptr, ArchiveFormat format=ArchiveFormat::Fixed)
+            : _methods(std::move(methods))
+            , _format(format) {
+
+    }
+
+    ProtocolPtr buildProtocol(const Address &address) override;
+protected:
+    RPCMethodsPtr _methods;
+    ArchiveFormat _format;
+};
+
+
+class NET4CXX_COMMON_API RPCClientFactory: public ClientFactory {
+public:
+    explicit RPCClientFactory(RPCMethodsPtr methods=nullptr, ArchiveFormat format=ArchiveFormat::Fixed)
+            : _methods(std::move(methods))
+            , _format(format) {
+
+    }
+
+    ProtocolPtr buildProtocol(const Address &address) override;
+protected:
+    RPCMethodsPtr _methods;
+    ArchiveFormat _format;
+};
+
+NS_END
+
+#endif //NET4CXX_PLUGINS_RPC_RPC_H
@@ -12,6 +12,24 @@
 
 NS_BEGIN
 
+static Histogram *gWebSocketHandshakeTime = NET4CXX_MetricsRegistry->registerHistogram(
+        "net4cxx.WebSocket.handshakeTime", "Microseconds from connection made until the opening handshake completes");
+static Histogram *gWebSocketAutoPingRoundTrip = NET4CXX_MetricsRegistry->registerHistogram(
+        "net4cxx.WebSocket.autoPingRoundTrip", "Microseconds from sending an auto-ping until its pong arrives");
+static Counter *gWebSocketIncomingOctets = NET4CXX_MetricsRegistry->registerCounter(
+        "net4cxx.WebSocket.incomingOctetsWireLevel", "Octets received on open websocket connections");
+static Counter *gWebSocketOutgoingOctets = NET4CXX_MetricsRegistry->registerCounter(
+        "net4cxx.WebSocket.outgoingOctetsWireLevel", "Octets sent on open websocket connections");
+static Counter *gWebSocketIncomingFrames = NET4CXX_MetricsRegistry->registerCounter(
+        "net4cxx.WebSocket.incomingFrames", "Data frames received on open websocket connections");
+static Counter *gWebSocketOutgoingFrames = NET4CXX_MetricsRegistry->registerCounter(
+        "net4cxx.WebSocket.outgoingFrames", "Data frames sent by websocket connections");
+static Counter *gWebSocketIncomingMessages = NET4CXX_MetricsRegistry->registerCounter(
+        "net4cxx.WebSocket.incomingMessages", "Messages received on open websocket connections");
+static Counter *gWebSocketOutgoingMessages = NET4CXX_MetricsRegistry->registerCounter(
+        "net4cxx.WebSocket.outgoingMessages", "Messages sent by websocket connections");
+
+
 const std::vector<int> WebSocketProtocol::SUPPORTED_SPEC_VERSIONS = {10, 11, 12, 13, 14, 15, 16, 17, 18};
 
 const std::vector<int> WebSocketProtocol::SUPPORTED_PROTOCOL_VERSIONS = {8, 13};
@@ -93,6 +111,7 @@ void WebSocketProtocol::sendMessage(const Byte *payload, size_t length, bool isB
      ByteArray payload1;
 
     _trafficStats._outgoingWebSocketMessages += 1;
+    gWebSocketOutgoingMessages->inc();
 
     if (_perMessageCompress && !doNotCompress) {
         sendCompressed = true;
@@ -194,6 +213,7 @@ void WebSocketProtocol::sendClose(boost::optional<unsigned short> code, boost::o
 }
 
 void WebSocketProtocol::connectionMade() {
+    _connectionMadeTime = TimestampClock::now();
     _peer = makePeerName();
 
     setTrackTimings(_trackTimings);
@@ -212,6 +232,7 @@ void WebSocketProtocol::connectionMade() {
 void WebSocketProtocol::dataReceived(Byte *data, size_t length) {
     if (_state == State::OPEN) {
         _trafficStats._incomingOctetsWireLevel += length;
+        gWebSocketIncomingOctets->inc((int64_t)length);
     } else if (_state == State::CONNECTING || _state == State::PROXY_CONNECTING) {
         _trafficStats._preopenIncomingOctetsWireLevel += length;
     }
@@ -673,6 +694,7 @@ void WebSocketProtocol::sendFrame(Byte opcode, const Byte *payload, size_t lengt
 
     if (opcode == 0u || opcode == 1u || opcode == 2u) {
         _trafficStats._outgoingWebSocketFrames += 1;
+        gWebSocketOutgoingFrames->inc();
     }
 
     if (_logFrames) {
@@ -705,6 +727,7 @@ void WebSocketProtocol::sendData(const Byte *data, size_t length, bool sync, siz
             write(data, length);
             if (_state == State::OPEN) {
                 _trafficStats._outgoingOctetsWireLevel += length;
+                gWebSocketOutgoingOctets->inc((int64_t)length);
             } else if (_state == State::CONNECTING || _state == State::PROXY_CONNECTING) {
                 _trafficStats._preopenOutgoingOctetsWireLevel += length;
             }
@@ -726,6 +749,7 @@ void WebSocketProtocol::send() {
 
             if (_state == State::OPEN) {
                 _trafficStats._outgoingOctetsWireLevel += e.first.size();
+                gWebSocketOutgoingOctets->inc((int64_t)e.first.size());
             } else if (_state == State::CONNECTING || _state == State::PROXY_CONNECTING) {
                 _trafficStats._preopenOutgoingOctetsWireLevel += e.first.size();
             }
@@ -853,6 +877,7 @@ bool WebSocketProtocol::onFrameEnd() {
     } else {
         if (_state == State::OPEN) {
             _trafficStats._incomingWebSocketFrames += 1;
+            gWebSocketIncomingFrames->inc();
         }
         if (_logFrames) {
             logRxFrame(*_currentFrame, _frameData.data(), _frameData.size());
@@ -874,6 +899,7 @@ bool WebSocketProtocol::onFrameEnd() {
 
             if (_state == State::OPEN) {
                 _trafficStats._incomingWebSocketMessages += 1;
+                gWebSocketIncomingMessages->inc();
             }
 
             onMessageEnd();
@@ -917,6 +943,7 @@ bool WebSocketProtocol::processControlFrame() {
             try {
                 if (payload == _autoPingPending) {
                     NET4CXX_LOG_DEBUG(gGenLog, "Auto ping/pong: received pending pong for auto-ping/pong");
+                    gWebSocketAutoPingRoundTrip->recordDuration(TimestampClock::now() - _autoPingSentTime);
 
                     if (!_autoPingTimeoutCall.cancelled()) {
                         _autoPingTimeoutCall.cancel();
@@ -1025,6 +1052,7 @@ void WebSocketProtocol::sendAutoPing() {
     _autoPingPendingCall.reset();
     _autoPingPending = WebSocketUtil::newid(_autoPingSize);
 
+    _autoPingSentTime = TimestampClock::now();
     sendPing(_autoPingPending);
 
     if (_autoPingTimeout != 0.0) {
@@ -1625,6 +1653,7 @@ void WebSocketServerProtocol::succeedHandshake(std::pair<std::string, WebSocketH
         });
     }
 
+    gWebSocketHandshakeTime->recordDuration(TimestampClock::now() - _connectionMadeTime);
     if (_trackedTimings) {
         _trackedTimings->track("onOpen");
     }
@@ -2077,6 +2106,7 @@ void WebSocketClientProtocol::processHandshake() {
             failConnection(1000, e.what());
         }
         if (onConnectSuccess) {
+            gWebSocketHandshakeTime->recordDuration(TimestampClock::now() - _connectionMadeTime);
             if (_trackedTimings) {
                 _trackedTimings->track("onOpen");
             }
@@ -350,6 +350,8 @@ protected:
     DelayedCall _autoPingTimeoutCall;
     ByteArray _autoPingPending;
     DelayedCall _autoPingPendingCall;
+    Timestamp _connectionMadeTime;
+    Timestamp _autoPingSentTime;
     // runtime
     bool _insideMessage{false};
     bool _isMessageCompressed{false};
@@ -0,0 +1,29 @@
+//
+// Created by agent on 26-10-18.
+//
+
+#include "net4cxx/common/logging/binarylog.h"
+#include <iostream>
+
+using namespace net4cxx;
+
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <segment>..." << std::endl;
+        return 1;
+    }
+    for (int i = 1; i < argc; ++i) {
+        try {
+            BinaryLogReader reader(argv[i]);
+            BinaryLogReader::Record record;
+            while (reader.next(record)) {
+                std::cout << BinaryLogReader::render(record) << '\n';
+            }
+        } catch (std::exception &e) {
+            std::cerr << argv[i] << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}